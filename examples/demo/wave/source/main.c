@@ -17,22 +17,22 @@ u16 mapa[32][24];   // Holds the map
 s16 bgx[192];       // Horizontal scroll of each line
 s8 i[192];          // Scroll speed of each line
 
-// Function that runs after a scanline is drawn. By modifying the values of the
-// scroll registers it's possible to add a wave effect.
-void hblank_handler(void)
+// Calculates the horizontal scroll of each line of the next frame. The raster
+// system copies them to the scroll registers during each horizontal blanking
+// period, so it's possible to add a wave effect without using the CPU.
+void update_wave(void)
 {
-    u32 vline = REG_VCOUNT; // Get the current line
-
-    if (vline < 192)
+    for (int line = 0; line < 192; line++)
     {
-        // If this is a line inside the screen, handle the effect
-        bgx[vline] += i[vline];
+        bgx[line] += i[line];
 
-        if ((bgx[vline] < 1) || (bgx[vline] > 63))
-            i[vline] *= -1;
+        if ((bgx[line] < 1) || (bgx[line] > 63))
+            i[line] *= -1;
 
-        NF_ScrollBg(1, 3, ((bgx[vline] >> 3) - 4), 0);
+        NF_RasterSetScroll(line, ((bgx[line] >> 3) - 4), 0);
     }
+
+    NF_RasterSwap();
 }
 
 int main(int argc, char **argv)
@@ -105,13 +105,16 @@ int main(int argc, char **argv)
         i[y] = inc;
     }
 
-    // Register a function to be called after a screen line has been drawn (when
-    // the horizontal blanking period starts)
-    irqSet(IRQ_HBLANK, hblank_handler);
-    irqEnable(IRQ_HBLANK);
+    // Start a raster effect on the scroll of layer 3 of the bottom screen. The
+    // table of values is applied at the start of every frame.
+    irqSet(IRQ_VBLANK, NF_RasterVBlank);
+    NF_RasterStart(1, NF_RASTER_SCROLL, 3);
 
     while (1)
     {
+        // Prepare the values of the next frame
+        update_wave();
+
         // Wait for the screen refresh
         swiWaitForVBlank();
     }
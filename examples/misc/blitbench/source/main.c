@@ -0,0 +1,121 @@
+// SPDX-License-Identifier: CC0-1.0
+//
+// SPDX-FileContributor: NightFox & Co., 2009-2011
+//
+// Example that compares the per-pixel and span-based 16-bit image blitters
+// http://www.nightfoxandco.com
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <nds.h>
+
+#include <nf_lib.h>
+
+// Number of draws of each test
+#define DRAWS 64
+
+// Size of the test image
+#define IMG_WIDTH 128
+#define IMG_HEIGHT 128
+
+// Per-pixel blitter used by NF_Draw16bitsImage() in previous versions
+static void DrawPerPixel(u8 screen, u8 slot, s16 x, s16 y, bool alpha)
+{
+    for (int img_y = 0; img_y < NF_BG16B[slot].height; img_y++)
+    {
+        for (int img_x = 0; img_x < NF_BG16B[slot].width; img_x++)
+        {
+            int buff_x = img_x + x;
+            int buff_y = img_y + y;
+
+            if ((buff_x >= 0) && (buff_x <= 255) && (buff_y >= 0) && (buff_y <= 255))
+            {
+                u32 buff_idx = (buff_y << 8) + buff_x;
+                u32 data = NF_BG16B[slot].buffer[(img_y * NF_BG16B[slot].width) + img_x];
+
+                if ((data != 0xFC1F) || (!alpha))
+                    *(NF_16BITS_BACKBUFFER[screen] + buff_idx) = data;
+            }
+        }
+    }
+}
+
+// Draws the image DRAWS times at different positions, some of them clipped,
+// and returns the elapsed timer ticks
+static u32 Bench(bool span, bool alpha)
+{
+    cpuStartTiming(0);
+    for (int n = 0; n < DRAWS; n++)
+    {
+        s16 x = ((n * 37) & 255) - 64;
+        s16 y = ((n * 23) & 255) - 64;
+        if (span)
+            NF_Draw16bitsImage(0, 0, x, y, alpha);
+        else
+            DrawPerPixel(0, 0, x, y, alpha);
+    }
+    return cpuEndTiming();
+}
+
+int main(int argc, char **argv)
+{
+    // Initialize 2D hardware and default console
+    NF_Set2D(0, 0);
+    NF_Set2D(1, 0);
+    consoleDemoInit();
+
+    // Initialize 16-bit bitmap buffers and the backbuffer of the top screen
+    NF_Init16bitsBgBuffers();
+    NF_Init16bitsBackBuffer(0);
+    NF_Enable16bitsBackBuffer(0);
+
+    // Create a test image in slot 0: a gradient with a transparent circle
+    u32 size = IMG_WIDTH * IMG_HEIGHT * sizeof(u16);
+    u16 *buffer = malloc(size);
+    if (buffer == NULL)
+        NF_Error(102, NULL, size);
+
+    for (int y = 0; y < IMG_HEIGHT; y++)
+    {
+        for (int x = 0; x < IMG_WIDTH; x++)
+        {
+            int dx = x - (IMG_WIDTH / 2);
+            int dy = y - (IMG_HEIGHT / 2);
+            if (((dx * dx) + (dy * dy)) > ((IMG_WIDTH / 2) * (IMG_WIDTH / 2)))
+                buffer[(y * IMG_WIDTH) + x] = 0xFC1F;
+            else
+                buffer[(y * IMG_WIDTH) + x] = RGB15(x >> 2, y >> 2, 16) | BIT(15);
+        }
+    }
+
+    NF_BG16B[0].buffer = buffer;
+    NF_BG16B[0].size = size;
+    NF_BG16B[0].width = IMG_WIDTH;
+    NF_BG16B[0].height = IMG_HEIGHT;
+    NF_BG16B[0].inuse = true;
+    NF_Update16bitsImageSpans(0);
+
+    printf("16-bit image blitter benchmark\n");
+    printf("%d draws of %dx%d pixels\n\n", DRAWS, IMG_WIDTH, IMG_HEIGHT);
+
+    u32 pixel_opaque = Bench(false, false);
+    u32 span_opaque = Bench(true, false);
+    u32 pixel_alpha = Bench(false, true);
+    u32 span_alpha = Bench(true, true);
+
+    // The timer runs at BUS_CLOCK (33.513982 MHz). The CPU runs at twice that
+    // frequency, so each tick is 2 CPU cycles.
+    printf("Timer ticks per draw:\n\n");
+    printf("Opaque, per pixel: %lu\n", pixel_opaque / DRAWS);
+    printf("Opaque, spans:     %lu\n", span_opaque / DRAWS);
+    printf("Alpha, per pixel:  %lu\n", pixel_alpha / DRAWS);
+    printf("Alpha, spans:      %lu\n", span_alpha / DRAWS);
+
+    while (1)
+    {
+        swiWaitForVBlank();
+    }
+
+    return 0;
+}
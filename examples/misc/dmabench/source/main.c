@@ -0,0 +1,93 @@
+// SPDX-License-Identifier: CC0-1.0
+//
+// SPDX-FileContributor: NightFox & Co., 2009-2011
+//
+// Example that compares blocking and asynchronous DMA copies to VRAM
+// http://www.nightfoxandco.com
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <nds.h>
+
+#include <nf_lib.h>
+
+// Number of copies of each test
+#define COPIES 64
+
+// Size of each copy (the size of a 16-bit backbuffer)
+#define COPY_SIZE 131072
+
+// Some work for the CPU that doesn't access main RAM
+static u32 Work(void)
+{
+    u32 value = 1;
+    for (int n = 0; n < 20000; n++)
+        value = (value * 1664525) + 1013904223;
+    return value;
+}
+
+int main(int argc, char **argv)
+{
+    // Initialize 2D hardware and default console
+    NF_Set2D(0, 0);
+    NF_Set2D(1, 0);
+    consoleDemoInit();
+
+    // Map VRAM_A as LCD to use it as destination of the copies
+    vramSetBankA(VRAM_A_LCD);
+
+    // Source buffer
+    u16 *buffer = malloc(COPY_SIZE);
+    if (buffer == NULL)
+        NF_Error(102, NULL, COPY_SIZE);
+    for (int n = 0; n < (COPY_SIZE / 2); n++)
+        buffer[n] = n;
+
+    printf("DMA copy benchmark\n");
+    printf("%d copies of %d bytes\n\n", COPIES, COPY_SIZE);
+
+    u32 result = 0;
+
+    // Blocking copies followed by CPU work
+    cpuStartTiming(0);
+    for (int n = 0; n < COPIES; n++)
+    {
+        NF_DmaMemCopy((void *)0x06800000, buffer, COPY_SIZE);
+        result += Work();
+    }
+    u32 blocking = cpuEndTiming();
+
+    // Asynchronous copies that overlap the CPU work
+    cpuStartTiming(0);
+    for (int n = 0; n < COPIES; n++)
+    {
+        u32 fence = NF_DmaMemCopyAsync((void *)0x06800000, buffer, COPY_SIZE);
+        result += Work();
+        NF_DmaWait(fence);
+    }
+    u32 async = cpuEndTiming();
+
+    // Only asynchronous copies, to measure the raw throughput
+    cpuStartTiming(0);
+    for (int n = 0; n < COPIES; n++)
+        NF_DmaMemCopyAsync((void *)0x06800000, buffer, COPY_SIZE);
+    NF_DmaWaitAll();
+    u32 raw = cpuEndTiming();
+
+    // The timer runs at BUS_CLOCK (33.513982 MHz)
+    printf("Blocking + work: %lu us\n", timerTicks2usec(blocking));
+    printf("Async + work:    %lu us\n", timerTicks2usec(async));
+    printf("Async only:      %lu us\n", timerTicks2usec(raw));
+    printf("Throughput:      %lu KB/s\n\n",
+           (u32)(((u64)COPIES * (COPY_SIZE / 1024) * 1000000) / timerTicks2usec(raw)));
+    // Print the result so that the compiler doesn't remove the work
+    printf("(%lu)\n", result & 0xF);
+
+    while (1)
+    {
+        swiWaitForVBlank();
+    }
+
+    return 0;
+}
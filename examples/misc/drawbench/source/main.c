@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: CC0-1.0
+//
+// SPDX-FileContributor: NightFox & Co., 2009-2011
+//
+// Example that measures the speed of the bitmap drawing primitives
+// http://www.nightfoxandco.com
+
+#include <stdio.h>
+
+#include <nds.h>
+
+#include <nf_lib.h>
+
+// Number of calls of each test
+#define CALLS 256
+
+// Paletted test image
+#define SPR_SIZE 32
+static u8 sprite[SPR_SIZE * SPR_SIZE];
+static u16 palette[256];
+
+// Prints the pixels per second drawn by a test
+static void Report(const char *name, u32 ticks, u32 pixels)
+{
+    u32 usec = timerTicks2usec(ticks);
+    if (usec == 0)
+        usec = 1;
+
+    printf("%-12s %8lu Kpx/s\n", name, (u32)(((u64)pixels * 1000) / usec));
+}
+
+int main(int argc, char **argv)
+{
+    // Initialize 2D hardware and default console
+    NF_Set2D(0, 5);
+    NF_Set2D(1, 0);
+    consoleDemoInit();
+
+    // Initialize a 16-bit bitmap with a backbuffer on the top screen
+    NF_InitBitmapBgSys(0, 1);
+    NF_Init16bitsBackBuffer(0);
+    NF_Enable16bitsBackBuffer(0);
+
+    for (int n = 0; n < 256; n++)
+        palette[n] = RGB15(n >> 3, 31 - (n >> 3), 16);
+    for (int n = 0; n < (SPR_SIZE * SPR_SIZE); n++)
+        sprite[n] = ((n & 7) == 0) ? 0 : n;
+
+    printf("Bitmap primitives benchmark\n");
+    printf("%d calls per test\n\n", CALLS);
+
+    u32 ticks;
+
+    // Horizontal spans of 200 pixels
+    cpuStartTiming(0);
+    for (int n = 0; n < CALLS; n++)
+        NF_Draw16bitsHLine(0, n & 31, n & 255, 200, n | BIT(15));
+    ticks = cpuEndTiming();
+    Report("HLine", ticks, CALLS * 200);
+
+    // Vertical spans of 150 pixels
+    cpuStartTiming(0);
+    for (int n = 0; n < CALLS; n++)
+        NF_Draw16bitsVLine(0, n & 255, n & 31, 150, n | BIT(15));
+    ticks = cpuEndTiming();
+    Report("VLine", ticks, CALLS * 150);
+
+    // Rectangles of 64x64 pixels
+    cpuStartTiming(0);
+    for (int n = 0; n < CALLS; n++)
+        NF_Fill16bitsRect(0, n & 127, n & 127, 64, 64, n | BIT(15));
+    ticks = cpuEndTiming();
+    Report("Rect 64x64", ticks, CALLS * 64 * 64);
+
+    // Full screen clears, filled with DMA
+    cpuStartTiming(0);
+    for (int n = 0; n < (CALLS / 16); n++)
+        NF_Fill16bitsRect(0, 0, 0, 256, 256, n | BIT(15));
+    ticks = cpuEndTiming();
+    Report("Clear", ticks, (CALLS / 16) * 65536);
+
+    // Diagonal lines of 192 pixels
+    cpuStartTiming(0);
+    for (int n = 0; n < CALLS; n++)
+        NF_Draw16bitsLine(0, n & 63, 0, (n & 63) + 191, 191, n | BIT(15));
+    ticks = cpuEndTiming();
+    Report("Line", ticks, CALLS * 192);
+
+    // Filled circles with a radius of 32 pixels (about 3217 pixels)
+    cpuStartTiming(0);
+    for (int n = 0; n < CALLS; n++)
+        NF_Draw16bitsCircle(0, 64 + (n & 127), 96, 32, n | BIT(15), true);
+    ticks = cpuEndTiming();
+    Report("Circle", ticks, CALLS * 3217);
+
+    // Paletted sprites of 32x32 pixels
+    cpuStartTiming(0);
+    for (int n = 0; n < CALLS; n++)
+        NF_Draw16bitsSprite(0, sprite, palette, n & 127, (n * 3) & 127, SPR_SIZE, SPR_SIZE);
+    ticks = cpuEndTiming();
+    Report("Sprite 32", ticks, CALLS * SPR_SIZE * SPR_SIZE);
+
+    // Show the result of the last tests
+    NF_Flip16bitsBackBufferDirty(0);
+
+    while (1)
+    {
+        swiWaitForVBlank();
+    }
+
+    return 0;
+}
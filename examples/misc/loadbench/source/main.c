@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: CC0-1.0
+//
+// SPDX-FileContributor: NightFox & Co., 2009-2011
+//
+// Example that compares the load time of uncompressed and compressed files
+// http://www.nightfoxandco.com
+
+#include <stdio.h>
+
+#include <nds.h>
+#include <filesystem.h>
+
+#include <nf_lib.h>
+
+// Number of loads of each test
+#define LOADS 8
+
+// Folders with the same background stored with each format. The compressed
+// files have been created with tests/compress/compress_test.
+static const char *formats[] = { "raw", "lz77", "lz11", "rle", "huff4", "huff8" };
+
+// Returns the size of a file in the root folder
+static u32 FileSize(const char *file)
+{
+    char path[256];
+    snprintf(path, sizeof(path), "%s/%s", NF_ROOTFOLDER, file);
+
+    NF_TYPE_FILE file_id;
+    if (!NF_FileOpen(&file_id, path))
+        NF_Error(101, path, 0);
+
+    u32 size = file_id.size;
+    NF_FileClose(&file_id);
+
+    return size;
+}
+
+int main(int argc, char **argv)
+{
+    // Initialize 2D hardware and default console
+    NF_Set2D(0, 0);
+    NF_Set2D(1, 0);
+    consoleDemoInit();
+    printf("\n NitroFS init. Please wait.\n\n");
+    swiWaitForVBlank();
+
+    // Initialize NitroFS and set it as the root folder of the filesystem
+    nitroFSInit(NULL);
+    NF_SetRootFolder("NITROFS");
+
+    // Initialize tiled backgrounds system
+    NF_InitTiledBgBuffers();
+    NF_InitTiledBgSys(0);
+
+    // Map VRAM_A as LCD to use it as destination of NF_LoadFileToVram()
+    vramSetBankA(VRAM_A_LCD);
+
+    consoleClear();
+    printf("Load time benchmark\n");
+    printf("2048x256 tiled background\n");
+    printf("Average of %d loads (us)\n\n", LOADS);
+    printf("Format  Bytes  LoadBg  ToVram\n");
+
+    for (u32 n = 0; n < (sizeof(formats) / sizeof(formats[0])); n++)
+    {
+        char file[64];
+
+        // Size of the tiles and map in the filesystem
+        snprintf(file, sizeof(file), "%s/bg0.img", formats[n]);
+        u32 bytes = FileSize(file);
+        snprintf(file, sizeof(file), "%s/bg0.map", formats[n]);
+        bytes += FileSize(file);
+
+        // Load the whole background to RAM
+        snprintf(file, sizeof(file), "%s/bg0", formats[n]);
+        u32 ticks_bg = 0;
+        for (int i = 0; i < LOADS; i++)
+        {
+            cpuStartTiming(0);
+            NF_LoadTiledBg(file, "bench", 2048, 256);
+            ticks_bg += cpuEndTiming();
+            NF_UnloadTiledBg("bench");
+        }
+
+        // Load the tiles directly to VRAM
+        snprintf(file, sizeof(file), "%s/bg0.img", formats[n]);
+        u32 ticks_vram = 0;
+        for (int i = 0; i < LOADS; i++)
+        {
+            cpuStartTiming(0);
+            NF_LoadFileToVram(file, VRAM_A);
+            ticks_vram += cpuEndTiming();
+        }
+
+        printf("%-6s %6lu %7lu %7lu\n", formats[n], bytes,
+               timerTicks2usec(ticks_bg) / LOADS,
+               timerTicks2usec(ticks_vram) / LOADS);
+    }
+
+    while (1)
+    {
+        swiWaitForVBlank();
+    }
+
+    return 0;
+}
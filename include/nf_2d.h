@@ -72,6 +72,8 @@ void NF_HideBg(u8 screen, u8 layer);
 /// Moves the BG of the selected layer and screen to the specified coordinates.
 ///
 /// If the map is taller or wider than 512, it must be kept in RAM all the time.
+/// Use NF_EnableTiledBgStreaming() to copy only the newly visible rows and
+/// columns of tiles of those maps instead of whole blocks of 256 pixels.
 ///
 /// Example:
 /// ```
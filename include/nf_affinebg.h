@@ -37,8 +37,17 @@ typedef struct {
     s32 x_tilt;     ///< X shear (PB)
     s32 y_tilt;     ///< Y shear (PC)
     s32 angle;      ///< Rotation angle
+    s32 pos_x;      ///< Reference point X set by NF_AffineBgMove() (BGxX, 20.8)
+    s32 pos_y;      ///< Reference point Y set by NF_AffineBgMove() (BGxY, 20.8)
+    bool streaming; ///< True if the map is bigger than the map in VRAM
+    bool wrap;      ///< True if a streamed map wraps around at its edges
+    s32 stream_x;   ///< First tile column of the streamed window
+    s32 stream_y;   ///< First tile row of the streamed window
 } NF_TYPE_AFFINE_BG;
 
+/// Size in tiles of the map in VRAM of streamed affine backgrounds (512x512).
+#define NF_AFFINE_STREAM_WINDOW 64
+
 /// Information of all affine backgrounds.
 extern NF_TYPE_AFFINE_BG NF_AFFINE_BG[2][4];
 
@@ -69,6 +78,12 @@ void NF_InitAffineBgSys(u8 screen);
 /// the palette. Use the script "Convert_Affine.bat" in the GRIT folder to
 /// convert your backgrounds.
 ///
+/// Backgrounds of any other size multiple of 256 pixels (like 2048x2048) are
+/// streamed. Only a 512x512 window of the map is kept in VRAM, as a wrapping
+/// map, and NF_AffineBgMove() copies the rows and columns of the map that
+/// become visible when the background moves or rotates. The visible area must
+/// fit in the window, so they can't be zoomed out more than 1.5 times.
+///
 /// Example:
 /// ```
 /// // Load the "waves512" background from the backgrounds folder, name it
@@ -99,6 +114,7 @@ static inline void NF_UnloadAffineBg(const char *name)
 /// Create an affine background in a layer using graphics preloaded in RAM.
 ///
 /// Specify if you want the background infinite (wrap = 1) or not (wrap = 0).
+/// If a streamed background doesn't wrap, tile 0 is shown outside of the map.
 ///
 /// Example:
 /// ```
@@ -127,7 +143,9 @@ void NF_DeleteAffineBg(u8 screen, u8 layer);
 
 /// Modify the transformation matrix of the specified background.
 ///
-/// You can change the scale of the X and Y axes, as well as their shear.
+/// You can change the scale of the X and Y axes, as well as their shear. The
+/// matrix is stored in NF_AFFINE_BG. If the background is streamed, the window
+/// of the map in VRAM is updated to cover the area seen with the new matrix.
 ///
 /// Example:
 /// ```
@@ -162,6 +180,37 @@ void NF_AffineBgTransform(u8 screen, u8 layer, s32 x_scale, s32 y_scale, s32 x_t
 /// @param angle Rotation angle (-2048 to 2048).
 void NF_AffineBgMove(u8 screen, u8 layer, s32 x, s32 y, s32 angle);
 
+/// Draws the affine background as a perspective floor (mode 7).
+///
+/// The background is seen as a ground plane by a camera placed over it. The
+/// values of the affine registers of each line below the horizon are
+/// calculated from the camera with a table of reciprocals, and they are copied
+/// to the registers on each HBlank by the raster system (a NF_RASTER_AFFINE
+/// effect is started if needed). Call it every frame that the camera moves,
+/// and call NF_RasterStop() to go back to the regular mode.
+///
+/// Lines above the horizon show the pixel at (0, 0) of the background, so it
+/// should be transparent to let the layers behind it show the sky.
+///
+/// Example:
+/// ```
+/// // Camera at (512, 700) of the map of layer 2 of the top screen, 32 pixels
+/// // over the ground, looking at angle 0 with the horizon at line 64 and a
+/// // field of view of 90 degrees.
+/// NF_AffineBgPerspective(0, 2, 512, 700, 32, 0, 64, 512);
+/// ```
+///
+/// @param screen Screen (0 - 1).
+/// @param layer Layer (2 - 3).
+/// @param x X coordinate of the camera over the background.
+/// @param y Y coordinate of the camera over the background.
+/// @param height Height of the camera over the background (1 - 32767).
+/// @param angle Direction of the camera (-2048 to 2048, like NF_AffineBgMove()).
+/// @param horizon Line of the horizon (0 - 191).
+/// @param fov Horizontal field of view (1 to 1023, 2048 is a full turn).
+void NF_AffineBgPerspective(u8 screen, u8 layer, s32 x, s32 y, s32 height,
+                            s32 angle, u8 horizon, s32 fov);
+
 /// Define the rotation center of the specified affine background.
 ///
 /// Example:
@@ -21,6 +21,8 @@ extern "C" {
 ///
 /// @{
 
+#include <stdio.h>
+
 #include <nds.h>
 
 /// Root folder used by NFLib
@@ -49,6 +51,9 @@ extern char NF_ROOTFOLDER[64];
 /// 116: File too big.
 /// 117: Affine background dimensions are invalid.
 /// 118: Affine creation layer is invalid.
+/// 119: Texture dimensions are invalid.
+/// 120: Sprite dimensions are invalid.
+/// 121: Tiled background is deduplicated and has animated tiles.
 ///
 /// @param code Error code.
 /// @param text Description.
@@ -75,6 +80,155 @@ __attribute__((noreturn)) void NF_Error(u16 code, const char *text, unsigned int
 /// @param folder
 void NF_SetRootFolder(const char *folder);
 
+/// Magic string at the start of NFLib asset packs.
+#define NF_ASSETPACK_MAGIC "NFPK"
+
+/// Version of the asset pack format.
+#define NF_ASSETPACK_VERSION 1
+
+/// Maximum length of the names of files inside an asset pack.
+#define NF_ASSETPACK_NAME_LENGTH 52
+
+/// Flag of an asset pack entry that is compressed (see nf_compress.h).
+#define NF_ASSETPACK_COMPRESSED BIT(0)
+
+/// Entry of the index of an asset pack.
+///
+/// The index is stored after a 16-byte header ("NFPK", version, number of
+/// entries and a reserved word). It's sorted by name so that files can be found
+/// with a binary search. Names are relative to the root folder.
+typedef struct {
+    char name[NF_ASSETPACK_NAME_LENGTH]; ///< File path relative to the root folder
+    u32 offset;                         ///< Offset of the data from the start of the pack
+    u32 size;                           ///< Size of the data
+    u32 flags;                          ///< Flags (NF_ASSETPACK_COMPRESSED)
+} NF_TYPE_ASSETPACK_ENTRY;
+
+/// File opened with NF_FileOpen().
+///
+/// It can be a regular file or a file inside the asset pack.
+typedef struct {
+    FILE *file;     ///< File handle (the asset pack for files inside it)
+    u32 start;      ///< Offset of the data in the file handle
+    u32 size;       ///< Size of the data
+    u32 pos;        ///< Current read position
+    u32 flags;      ///< Flags of the asset pack entry (0 for regular files)
+    bool packed;    ///< True if the file is inside the asset pack
+} NF_TYPE_FILE;
+
+/// Opens an asset pack and uses it to load files.
+///
+/// The index of the pack is loaded to RAM and the pack is kept open. From then
+/// on, all NF_Load* functions look for their files in the pack first, so they
+/// don't need to open each file. Files that aren't in the pack are loaded from
+/// the filesystem as usual.
+///
+/// Packs can be created with tools/nfpack.py from the folder that is used as
+/// root folder by NFLib.
+///
+/// Example:
+/// ```
+/// // Load all files from "assets.nfp" in the root folder
+/// NF_OpenAssetPack("assets.nfp");
+/// ```
+///
+/// @param file File path, relative to the root folder.
+void NF_OpenAssetPack(const char *file);
+
+/// Closes the asset pack opened with NF_OpenAssetPack().
+///
+/// Example:
+/// ```
+/// NF_CloseAssetPack();
+/// ```
+void NF_CloseAssetPack(void);
+
+/// Opens a file for reading, from the asset pack or from the filesystem.
+///
+/// Example:
+/// ```
+/// NF_TYPE_FILE file;
+/// if (NF_FileOpen(&file, "nitro:/bg/title.img"))
+/// {
+///     NF_FileRead(&file, buffer, file.size);
+///     NF_FileClose(&file);
+/// }
+/// ```
+///
+/// @param file Pointer to the file struct to fill.
+/// @param path Full path of the file.
+/// @return True on success, false if the file doesn't exist.
+bool NF_FileOpen(NF_TYPE_FILE *file, const char *path);
+
+/// Reads data from a file opened with NF_FileOpen().
+///
+/// @param file Pointer to the file.
+/// @param buffer Destination buffer.
+/// @param size Number of bytes to read.
+/// @return Number of bytes read.
+u32 NF_FileRead(NF_TYPE_FILE *file, void *buffer, u32 size);
+
+/// Sets the read position of a file opened with NF_FileOpen().
+///
+/// @param file Pointer to the file.
+/// @param pos New position from the start of the file.
+void NF_FileSeek(NF_TYPE_FILE *file, u32 pos);
+
+/// Closes a file opened with NF_FileOpen().
+///
+/// @param file Pointer to the file.
+void NF_FileClose(NF_TYPE_FILE *file);
+
+/// Loads a whole file to a new buffer in RAM, decompressing it if required.
+///
+/// Files compressed with any of the formats supported by nf_compress.h are
+/// detected by their header and decompressed. If the file doesn't exist it
+/// fails with error 101, and if there isn't enough RAM with error 102.
+///
+/// The buffer is allocated with calloc() and it must be freed with free().
+///
+/// Example:
+/// ```
+/// // Load "nitro:/bg/title.map" with a minimum buffer size of 2 KB
+/// char *buffer;
+/// u32 size;
+/// NF_FileLoad("nitro:/bg/title.map", &buffer, &size, 2048);
+/// ```
+///
+/// @param path Full path of the file.
+/// @param buffer Returns the new buffer.
+/// @param size Returns the size of the data (after decompressing it).
+/// @param min_size Minimum size of the buffer. The rest is set to zero.
+void NF_FileLoad(const char *path, char **buffer, u32 *size, u32 min_size);
+
+/// Prepares the contents of a file that has been loaded to RAM.
+///
+/// It decompresses the data if required and makes sure that the buffer has the
+/// minimum size, like NF_FileLoad() does. The buffer may be replaced by a new
+/// one. This is useful for files read in several steps with NF_FileRead().
+///
+/// Example:
+/// ```
+/// // Decompress the data read from "file" if it's compressed
+/// bool check = !file.packed || (file.flags & NF_ASSETPACK_COMPRESSED);
+/// NF_FileUnpack(&buffer, &size, 0, check);
+/// ```
+///
+/// @param buffer Buffer with the data. Returns the new buffer.
+/// @param size Size of the data. Returns the new size.
+/// @param min_size Minimum size of the buffer. The rest is set to zero.
+/// @param check False if the data is known to be uncompressed.
+void NF_FileUnpack(char **buffer, u32 *size, u32 min_size, bool check);
+
+/// Loads a whole file to a new buffer in RAM without decompressing it.
+///
+/// It works like NF_FileLoad(), but the data is loaded as it is.
+///
+/// @param path Full path of the file.
+/// @param buffer Returns the new buffer.
+/// @param size Returns the size of the file.
+void NF_FileLoadRaw(const char *path, char **buffer, u32 *size);
+
 /// Function copy blocks of memory from RAM to VRAM fast.
 ///
 /// DMA copies from RAM to VRAM are the most efficient. The function checks if
@@ -91,6 +245,182 @@ void NF_SetRootFolder(const char *folder);
 /// @param size Number of bytes to copy.
 void NF_DmaMemCopy(void *destination, const void *source, u32 size);
 
+/// First DMA channel used by NF_DmaMemCopyAsync().
+///
+/// Channel 0 is left free for HBlank effects.
+#define NF_DMA_ASYNC_FIRST_CHANNEL 1
+
+/// Last DMA channel used by NF_DmaMemCopyAsync().
+#define NF_DMA_ASYNC_LAST_CHANNEL 3
+
+/// Fence returned by NF_DmaMemCopyAsync() that is always complete.
+#define NF_DMA_FENCE_DONE 0
+
+/// Starts a copy using DMA and returns without waiting for it to finish.
+///
+/// It uses the first free channel between NF_DMA_ASYNC_FIRST_CHANNEL and
+/// NF_DMA_ASYNC_LAST_CHANNEL, in round-robin order. If all of them are busy, it
+/// waits for the oldest one to finish.
+///
+/// The source must not be modified, and the destination must not be read or
+/// written, until the copy has finished. Use NF_DmaIsDone() or NF_DmaWait() with
+/// the returned fence to check it.
+///
+/// If the addresses aren't aligned to 16 bits, memcpy() is used and the fence
+/// returned is NF_DMA_FENCE_DONE.
+///
+/// Example:
+/// ```
+/// // Copy 128 KB from "buffer" to VRAM_A while the CPU does other things
+/// u32 fence = NF_DmaMemCopyAsync((void*)0x06000000, buffer, 131072);
+/// UpdateGameLogic();
+/// NF_DmaWait(fence);
+/// ```
+///
+/// @param destination Destination pointer.
+/// @param source Source pointer.
+/// @param size Number of bytes to copy.
+/// @return Fence that identifies the copy.
+u32 NF_DmaMemCopyAsync(void *destination, const void *source, u32 size);
+
+/// Checks if a copy started with NF_DmaMemCopyAsync() has finished.
+///
+/// Example:
+/// ```
+/// // Do other work while the copy isn't finished
+/// while (!NF_DmaIsDone(fence))
+///     DoSomethingElse();
+/// ```
+///
+/// @param fence Fence returned by NF_DmaMemCopyAsync().
+/// @return True if the copy has finished.
+bool NF_DmaIsDone(u32 fence);
+
+/// Waits until a copy started with NF_DmaMemCopyAsync() has finished.
+///
+/// Example:
+/// ```
+/// NF_DmaWait(fence);
+/// ```
+///
+/// @param fence Fence returned by NF_DmaMemCopyAsync().
+void NF_DmaWait(u32 fence);
+
+/// Waits until all copies started with NF_DmaMemCopyAsync() have finished.
+///
+/// Example:
+/// ```
+/// NF_DmaWaitAll();
+/// ```
+void NF_DmaWaitAll(void);
+
+/// Maximum number of pending transfers in the VRAM upload queue.
+#define NF_VRAM_QUEUE_SIZE 128
+
+/// Struct that holds one pending transfer of the VRAM upload queue.
+typedef struct {
+    void *destination;  ///< Destination address
+    const void *source; ///< Source address (NULL for 16-bit register writes)
+    u32 size;           ///< Size in bytes (0 if the transfer has been dropped)
+    vu8 *bank;          ///< VRAM bank to map as LCD during the copy (or NULL)
+    u16 value;          ///< Value to write if this is a register write
+} NF_TYPE_VRAMQUEUE_INFO;
+
+/// Pending transfers of the VRAM upload queue.
+extern NF_TYPE_VRAMQUEUE_INFO NF_VRAMQUEUE[NF_VRAM_QUEUE_SIZE];
+
+/// Number of pending transfers in the VRAM upload queue.
+extern u32 NF_VRAMQUEUE_COUNT;
+
+/// True if the VRAM upload queue is enabled.
+extern bool NF_VRAMQUEUE_ENABLED;
+
+/// Enables the VRAM upload queue.
+///
+/// While it is enabled, NF_SpriteFrame(), NF_UpdateVramMap(), NF_ScrollBg(),
+/// NF_BgUpdatePalette(), NF_SpriteUpdatePalette() and NF_Update3dSpritesGfx()
+/// don't copy data to VRAM. Instead, they add the transfers to a queue that is
+/// copied in one pass by NF_FlushVramQueue(), which should be called from the
+/// VBlank interrupt handler. Consecutive transfers are merged, and transfers
+/// to a destination that is overwritten later in the same frame are dropped.
+///
+/// The source buffers are read when the queue is flushed, so they must not be
+/// freed before that. If the queue is full, transfers are done immediately.
+///
+/// Example:
+/// ```
+/// // Copy all VRAM data during the VBlank period
+/// irqSet(IRQ_VBLANK, NF_FlushVramQueue);
+/// NF_EnableVramQueue();
+/// ```
+void NF_EnableVramQueue(void);
+
+/// Disables the VRAM upload queue.
+///
+/// All pending transfers are done before disabling it.
+///
+/// Example:
+/// ```
+/// // Copy data to VRAM immediately again
+/// NF_DisableVramQueue();
+/// ```
+void NF_DisableVramQueue(void);
+
+/// Adds a copy to VRAM to the upload queue.
+///
+/// If the queue is disabled it works like NF_DmaMemCopy().
+///
+/// Example:
+/// ```
+/// // Copy 2 KB from "buffer" to VRAM_A during the next VBlank
+/// NF_QueueVramCopy((void*)0x06000000, buffer, 2048);
+/// ```
+///
+/// @param destination Destination pointer.
+/// @param source Source pointer.
+/// @param size Number of bytes to copy.
+void NF_QueueVramCopy(void *destination, const void *source, u32 size);
+
+/// Adds a copy to a VRAM bank that must be mapped as LCD to the upload queue.
+///
+/// The bank is mapped as LCD during the copy, and its previous mapping is
+/// restored afterwards. This is needed to write extended palettes, for
+/// example. If the queue is disabled the copy is done immediately.
+///
+/// Example:
+/// ```
+/// // Copy a palette to the extended palettes of VRAM_E
+/// NF_QueueVramBankCopy(&VRAM_E_CR, (void*)0x06880000, palette, 512);
+/// ```
+///
+/// @param bank Control register of the VRAM bank (VRAM_A_CR to VRAM_I_CR).
+/// @param destination Destination pointer.
+/// @param source Source pointer.
+/// @param size Number of bytes to copy.
+void NF_QueueVramBankCopy(vu8 *bank, void *destination, const void *source,
+                          u32 size);
+
+/// Adds a write to a 16-bit video register to the upload queue.
+///
+/// This is used to apply scroll values at the same time as the maps they
+/// need. If the queue is disabled the value is written immediately.
+///
+/// @param reg Pointer to the register.
+/// @param value Value to write.
+void NF_QueueRegWrite16(vu16 *reg, u16 value);
+
+/// Does all pending transfers of the VRAM upload queue.
+///
+/// Call it from the VBlank interrupt handler, or right after
+/// swiWaitForVBlank().
+///
+/// Example:
+/// ```
+/// swiWaitForVBlank();
+/// NF_FlushVramQueue();
+/// ```
+void NF_FlushVramQueue(void);
+
 /// Returns the language ID set by the user in the firmware.
 ///
 /// 0 : Japanese
@@ -29,12 +29,40 @@ extern "C" {
 /// Maximum number of slots of 8-bit bitmap backgrounds
 #define NF_SLOTS_BG8B 16
 
+/// Maximum number of dirty rectangles of each backbuffer.
+///
+/// If more areas are marked as dirty, they are merged with the rectangle that
+/// grows the least.
+#define NF_BACKBUFFER_DIRTY_RECTS 16
+
+/// Dirty area (in pixels) from which the whole backbuffer is copied.
+///
+/// Copying many small rectangles has an overhead per row, so after this limit
+/// it's faster to copy the full backbuffer.
+#define NF_BACKBUFFER_DIRTY_AREA 32768
+
+/// Blend mode: the image is mixed with the backbuffer using a constant alpha.
+#define NF_BLEND_ALPHA 0
+
+/// Blend mode: like NF_BLEND_ALPHA, but the alpha of each pixel is also
+/// multiplied by the value of the mask loaded with NF_Load16bitsImageMask().
+#define NF_BLEND_MASK 1
+
+/// Blend mode: the image is added to the backbuffer, saturating each component.
+#define NF_BLEND_ADD 2
+
+/// Blend mode: the backbuffer is multiplied by the image.
+#define NF_BLEND_MULTIPLY 3
+
 /// Struct that holds information about 16-bit bitmap backgrounds.
 typedef struct {
     u16 *buffer;    ///< Data buffer
     u32 size;       ///< Size of the buffer
     u16 width;      ///< Width of the image (max 256 pixels)
     u16 height;     ///< Height of the image (max 256 pixels)
+    u32 *spanrows;  ///< Offset in "spans" of the runs of each row
+    u16 *spans;     ///< Runs of opaque pixels (NULL if there are no magenta pixels)
+    u8 *mask;       ///< Opacity of each pixel (0 - 255), optional
     bool inuse;     ///< True if the slot is in use
 } NF_TYPE_BG16B_INFO;
 
@@ -50,6 +78,8 @@ typedef struct {
     u32 data_size;      ///< Data buffer size
     u16 *pal;           ///< Palette buffer
     u32 pal_size;       ///< Palette buffer size
+    u32 *spanrows;      ///< Offset in "spans" of the runs of each row
+    u16 *spans;         ///< Runs of opaque pixels (NULL if there is no color 0)
     bool inuse;         ///< True if the slot is in use
 } NF_TYPE_BG8B_INFO;
 
@@ -105,6 +135,128 @@ void NF_Disble16bitsBackBuffer(u8 screen);
 /// @param screen Screen (0 - 1).
 void NF_Flip16bitsBackBuffer(u8 screen);
 
+/// Starts sending the 16-bit backbuffer to the VRAM of the selected screen.
+///
+/// It works like NF_Flip16bitsBackBuffer(), but it returns as soon as the copy
+/// has started. The backbuffer must not be modified until the copy has
+/// finished.
+///
+/// Example:
+/// ```
+/// u32 fence = NF_Flip16bitsBackBufferAsync(0);
+/// UpdateGameLogic();
+/// NF_DmaWait(fence);
+/// ```
+///
+/// @param screen Screen (0 - 1).
+/// @return Fence to use with NF_DmaIsDone() or NF_DmaWait().
+u32 NF_Flip16bitsBackBufferAsync(u8 screen);
+
+/// Marks an area of the 16-bit backbuffer as modified.
+///
+/// NF_Draw16bitsImage() and NF_Copy16bitsBuffer() mark the areas they draw.
+/// Call this function if you write to NF_16BITS_BACKBUFFER directly and you
+/// use NF_Flip16bitsBackBufferDirty(). The area is clipped to the backbuffer.
+///
+/// Example:
+/// ```
+/// // Draw a pixel and mark it as modified
+/// NF_16BITS_BACKBUFFER[0][(y << 8) + x] = RGB15(31, 31, 31) | BIT(15);
+/// NF_Mark16bitsBackBufferDirty(0, x, y, 1, 1);
+/// ```
+///
+/// @param screen Screen (0 - 1).
+/// @param x X coordinate.
+/// @param y Y coordinate.
+/// @param w Width.
+/// @param h Height.
+void NF_Mark16bitsBackBufferDirty(u8 screen, s16 x, s16 y, u16 w, u16 h);
+
+/// Sends the modified areas of the 16-bit backbuffer to VRAM.
+///
+/// It only copies the rows of the rectangles marked as dirty since the last
+/// flip. If the dirty area is bigger than NF_BACKBUFFER_DIRTY_AREA the whole
+/// backbuffer is copied, like with NF_Flip16bitsBackBuffer().
+///
+/// Example:
+/// ```
+/// NF_Draw16bitsImage(0, 1, 100, 50, true);
+/// NF_Flip16bitsBackBufferDirty(0);
+/// ```
+///
+/// @param screen Screen (0 - 1).
+void NF_Flip16bitsBackBufferDirty(u8 screen);
+
+/// Uses page flipping instead of a backbuffer in RAM for the top screen.
+///
+/// VRAM_B is mapped after VRAM_A as a second 16-bit bitmap page. One page is
+/// displayed while the other one is drawn, and NF_Flip16bitsPage() swaps them
+/// by changing the bitmap base of layer 3, so nothing is copied. The RAM
+/// backbuffer is freed, and NF_16BITS_BACKBUFFER[0] points to the page that
+/// isn't displayed, so all functions that draw to the backbuffer draw to it.
+/// NF_Flip16bitsBackBuffer() and its variants swap the pages too.
+///
+/// The screen must be set up with NF_InitBitmapBgSys(0, 1). VRAM_B can't be
+/// used for sprites or textures while this mode is active. It's only available
+/// for the main engine, as the sub engine only has 128 KB of VRAM for
+/// backgrounds.
+///
+/// The page that becomes the backbuffer after a flip contains the frame drawn
+/// two flips before, so redraw everything that changes every frame.
+///
+/// Example:
+/// ```
+/// NF_InitBitmapBgSys(0, 1);
+/// NF_Enable16bitsPageFlip(0);
+/// ```
+///
+/// @param screen Screen (only 0 is supported).
+void NF_Enable16bitsPageFlip(u8 screen);
+
+/// Stops using page flipping on the top screen.
+///
+/// The displayed page is moved to VRAM_A if needed and VRAM_B is released.
+/// Call NF_Enable16bitsBackBuffer() to use a backbuffer in RAM again.
+///
+/// Example:
+/// ```
+/// NF_Disable16bitsPageFlip(0);
+/// ```
+///
+/// @param screen Screen (only 0 is supported).
+void NF_Disable16bitsPageFlip(u8 screen);
+
+/// Displays the page that has been drawn and starts drawing into the other one.
+///
+/// Call it during the VBlank period (for example, right after
+/// swiWaitForVBlank()) to avoid tearing.
+///
+/// Example:
+/// ```
+/// NF_Draw16bitsImage(0, 1, x, y, true);
+/// swiWaitForVBlank();
+/// NF_Flip16bitsPage(0);
+/// ```
+///
+/// @param screen Screen (only 0 is supported).
+void NF_Flip16bitsPage(u8 screen);
+
+/// Returns the address of the 16-bit bitmap displayed on a screen.
+///
+/// It's the start of VRAM_A or VRAM_C, unless page flipping is used in the top
+/// screen and the second page (VRAM_B) is being displayed.
+///
+/// Example:
+/// ```
+/// // Draw a red pixel at (10, 20) directly on the screen
+/// u16 *vram = NF_Get16bitsDisplayedPage(0);
+/// vram[(20 << 8) + 10] = RGB15(31, 0, 0) | BIT(15);
+/// ```
+///
+/// @param screen Screen (0 - 1).
+/// @return Address of the bitmap.
+u16 *NF_Get16bitsDisplayedPage(u8 screen);
+
 /// Initializes the selected screen in "bitmap" mode.
 ///
 /// The color depth of the bitmap can be 8 or 16 bits.
@@ -201,6 +353,10 @@ void NF_Copy16bitsBuffer(u8 screen, u8 destination, u8 slot);
 ///
 /// If "alpha" is set to true, all magenta pixels (0xFF00FF) won't be drawn.
 ///
+/// The image is clipped against the backbuffer once, and each visible row is
+/// copied with memcpy(). Transparent images are drawn using the runs of opaque
+/// pixels found when the image was loaded, so magenta pixels are never read.
+///
 /// Example:
 /// ```
 /// // Draws the image from Slot 1 to the backbuffer of the bottom screen, at
@@ -215,6 +371,118 @@ void NF_Copy16bitsBuffer(u8 screen, u8 destination, u8 slot);
 /// @param alpha True to make magenta pixels transparent.
 void NF_Draw16bitsImage(u8 screen, u8 slot, s16 x, s16 y, bool alpha);
 
+/// Draws the image in a slot into the backbuffer blending it with its contents.
+///
+/// Magenta pixels are never drawn. The other ones are combined with the pixels
+/// of the backbuffer depending on the mode:
+///
+/// - NF_BLEND_ALPHA: The result is (image * alpha + backbuffer * (32 - alpha))
+///   / 32.
+/// - NF_BLEND_MASK: Like NF_BLEND_ALPHA, multiplying alpha by the value of the
+///   mask of each pixel. Pixels with a value of 0 in the mask aren't drawn.
+/// - NF_BLEND_ADD: The image, scaled by alpha / 32, is added to the backbuffer.
+///   Components that overflow are set to the maximum value.
+/// - NF_BLEND_MULTIPLY: The backbuffer is multiplied by the image, and the
+///   result is mixed with the backbuffer using alpha.
+///
+/// The three color components are blended at the same time using 32-bit
+/// arithmetic, except in multiply mode.
+///
+/// Example:
+/// ```
+/// // Draw the panel of slot 2 at 50% opacity at (16, 120)
+/// NF_Draw16bitsImageBlend(0, 2, 16, 120, NF_BLEND_ALPHA, 16);
+/// ```
+///
+/// @param screen Screen (0 - 1).
+/// @param slot Slot number (0 - 15).
+/// @param x X coordinate.
+/// @param y Y coordinate.
+/// @param mode Blend mode (NF_BLEND_ALPHA, NF_BLEND_MASK, NF_BLEND_ADD or
+///             NF_BLEND_MULTIPLY).
+/// @param alpha Opacity of the image (0 - 32, 32 is fully opaque).
+void NF_Draw16bitsImageBlend(u8 screen, u8 slot, s16 x, s16 y, u8 mode, u8 alpha);
+
+/// Draws the image in a slot into the backbuffer, rotated and scaled.
+///
+/// The image is rotated around its center, which is placed at (x, y). Pixels
+/// are sampled with nearest neighbour. Each row of the backbuffer is clipped
+/// once, so small rotated elements are cheap to draw.
+///
+/// Example:
+/// ```
+/// // Draw the image of slot 1 centered at (128, 96), rotated 45 degrees
+/// // clockwise and at twice its size
+/// NF_Draw16bitsImageRotScale(0, 1, 128, 96, 256, 512, 512, true);
+/// ```
+///
+/// @param screen Screen (0 - 1).
+/// @param slot Slot number (0 - 15).
+/// @param x X coordinate of the center.
+/// @param y Y coordinate of the center.
+/// @param angle Rotation angle (-2048 to 2048, like NF_AffineBgMove()).
+///              Positive angles rotate clockwise.
+/// @param x_scale Horizontal scale (256 is the original size, 512 is twice as
+///                big).
+/// @param y_scale Vertical scale (256 is the original size, 512 is twice as
+///                big).
+/// @param alpha True to make magenta pixels transparent.
+void NF_Draw16bitsImageRotScale(u8 screen, u8 slot, s16 x, s16 y, s32 angle,
+                                s32 x_scale, s32 y_scale, bool alpha);
+
+/// Draws the image in a slot into the backbuffer, stretched to a rectangle.
+///
+/// Pixels are sampled with nearest neighbour.
+///
+/// Example:
+/// ```
+/// // Draw the image of slot 1 stretched to 100x20 pixels at (10, 10)
+/// NF_Draw16bitsImageScaled(0, 1, 10, 10, 100, 20, true);
+/// ```
+///
+/// @param screen Screen (0 - 1).
+/// @param slot Slot number (0 - 15).
+/// @param x X coordinate.
+/// @param y Y coordinate.
+/// @param w Width of the rectangle.
+/// @param h Height of the rectangle.
+/// @param alpha True to make magenta pixels transparent.
+void NF_Draw16bitsImageScaled(u8 screen, u8 slot, s16 x, s16 y, u16 w, u16 h,
+                              bool alpha);
+
+/// Loads the opacity mask of a 16-bit image.
+///
+/// The file must be a ".msk" file with one byte per pixel of the image, with
+/// values from 0 (transparent) to 255 (opaque). The image must be loaded
+/// before its mask. The mask is freed when the image is unloaded.
+///
+/// Example:
+/// ```
+/// // Load "bmp/glow.img" and its mask "bmp/glow.msk" to slot 3
+/// NF_Load16bitsImage("bmp/glow", 3, 64, 64);
+/// NF_Load16bitsImageMask("bmp/glow", 3);
+/// ```
+///
+/// @param file File path without extension.
+/// @param slot Slot number (0 - 15).
+void NF_Load16bitsImageMask(const char *file, u8 slot);
+
+/// Updates the runs of opaque pixels of a 16-bit image.
+///
+/// They are created when the image is loaded. Call this function if you modify
+/// the buffer of the image, or NF_Draw16bitsImage() won't draw the transparent
+/// pixels correctly.
+///
+/// Example:
+/// ```
+/// // Clear the first pixel of the image in slot 2 and update it
+/// NF_BG16B[2].buffer[0] = 0xFC1F;
+/// NF_Update16bitsImageSpans(2);
+/// ```
+///
+/// @param slot Slot number (0 - 15).
+void NF_Update16bitsImageSpans(u8 slot);
+
 /// Initialize buffers to store 8-bit bitmap backgrounds.
 ///
 /// You must call this function once in you code before loading any 8-bit
@@ -285,6 +553,68 @@ void NF_Unload8bitsBg(u8 slot);
 /// @param slot Slot number (0 - 15).
 void NF_Copy8bitsBuffer(u8 screen, u8 destination, u8 slot);
 
+/// Draws the 8-bit bitmap in a slot into the backbuffer of the selected screen.
+///
+/// The bitmap is 256 pixels wide, and as tall as the loaded data. It uses the
+/// same clipped blitter as NF_Draw16bitsImage(). The palette isn't copied.
+///
+/// If "alpha" is set to true, pixels with color index 0 won't be drawn.
+///
+/// Example:
+/// ```
+/// // Draw the bitmap of slot 0 to the backbuffer of the top screen, 32 pixels
+/// // lower than its top
+/// NF_Draw8bitsImage(0, 0, 0, 32, true);
+/// ```
+///
+/// @param screen Screen (0 - 1).
+/// @param slot Slot number (0 - 15).
+/// @param x X coordinate.
+/// @param y Y coordinate.
+/// @param alpha True to make color 0 transparent.
+void NF_Draw8bitsImage(u8 screen, u8 slot, s16 x, s16 y, bool alpha);
+
+/// Draws the 8-bit bitmap in a slot into the backbuffer, rotated and scaled.
+///
+/// It works like NF_Draw16bitsImageRotScale(). The bitmap is 256 pixels wide,
+/// and as tall as the loaded data.
+///
+/// Example:
+/// ```
+/// NF_Draw8bitsImageRotScale(0, 0, 128, 96, -128, 128, 128, true);
+/// ```
+///
+/// @param screen Screen (0 - 1).
+/// @param slot Slot number (0 - 15).
+/// @param x X coordinate of the center.
+/// @param y Y coordinate of the center.
+/// @param angle Rotation angle (-2048 to 2048). Positive angles rotate
+///              clockwise.
+/// @param x_scale Horizontal scale (256 is the original size).
+/// @param y_scale Vertical scale (256 is the original size).
+/// @param alpha True to make color 0 transparent.
+void NF_Draw8bitsImageRotScale(u8 screen, u8 slot, s16 x, s16 y, s32 angle,
+                               s32 x_scale, s32 y_scale, bool alpha);
+
+/// Draws the 8-bit bitmap in a slot into the backbuffer, stretched to a
+/// rectangle.
+///
+/// Example:
+/// ```
+/// // Draw a thumbnail of the bitmap of slot 0
+/// NF_Draw8bitsImageScaled(0, 0, 8, 8, 64, 48, false);
+/// ```
+///
+/// @param screen Screen (0 - 1).
+/// @param slot Slot number (0 - 15).
+/// @param x X coordinate.
+/// @param y Y coordinate.
+/// @param w Width of the rectangle.
+/// @param h Height of the rectangle.
+/// @param alpha True to make color 0 transparent.
+void NF_Draw8bitsImageScaled(u8 screen, u8 slot, s16 x, s16 y, u16 w, u16 h,
+                             bool alpha);
+
 /// Initialize the 8 bit background backbuffer of the selected screen.
 ///
 /// Use this function once before using the backbuffer.
@@ -317,6 +647,61 @@ void NF_Disble8bitsBackBuffer(u8 screen);
 /// @param destination Destination layer (0: layer 2, 1: layer 3).
 void NF_Flip8bitsBackBuffer(u8 screen, u8 destination);
 
+/// Marks an area of the 8-bit backbuffer as modified.
+///
+/// NF_Draw8bitsImage() and NF_Copy8bitsBuffer() mark the areas they draw.
+/// Call this function if you write to NF_8BITS_BACKBUFFER directly and you
+/// use NF_Flip8bitsBackBufferDirty(). The area is clipped to the backbuffer.
+///
+/// Example:
+/// ```
+/// // Clear a 16x16 area and mark it as modified
+/// for (int row = 0; row < 16; row++)
+///     memset(NF_8BITS_BACKBUFFER[0].data + ((y + row) << 8) + x, 0, 16);
+/// NF_Mark8bitsBackBufferDirty(0, x, y, 16, 16);
+/// ```
+///
+/// @param screen Screen (0 - 1).
+/// @param x X coordinate.
+/// @param y Y coordinate.
+/// @param w Width.
+/// @param h Height.
+void NF_Mark8bitsBackBufferDirty(u8 screen, s16 x, s16 y, u16 w, u16 h);
+
+/// Marks the palette of the 8-bit backbuffer as modified.
+///
+/// NF_Copy8bitsBuffer() marks it when it copies a palette to the backbuffer.
+/// Call this function if you modify the palette directly.
+///
+/// Example:
+/// ```
+/// NF_8BITS_BACKBUFFER[0].pal[1] = RGB15(31, 0, 0);
+/// NF_Mark8bitsBackBufferPalDirty(0);
+/// ```
+///
+/// @param screen Screen (0 - 1).
+void NF_Mark8bitsBackBufferPalDirty(u8 screen);
+
+/// Sends the modified areas of the 8-bit backbuffer to VRAM.
+///
+/// It only copies the rows of the rectangles marked as dirty since the last
+/// flip, and the palette only if it has been modified. If the dirty area is
+/// bigger than NF_BACKBUFFER_DIRTY_AREA the whole backbuffer is copied, like
+/// with NF_Flip8bitsBackBuffer().
+///
+/// The dirty areas are cleared after each flip, so always send the backbuffer
+/// to the same layer if you use this function.
+///
+/// Example:
+/// ```
+/// NF_Draw8bitsImage(0, 1, 100, 50, true);
+/// NF_Flip8bitsBackBufferDirty(0, 0);
+/// ```
+///
+/// @param screen Screen (0 - 1).
+/// @param destination Destination layer (0: layer 2, 1: layer 3).
+void NF_Flip8bitsBackBufferDirty(u8 screen, u8 destination);
+
 /// @}
 
 #endif // NF_BITMAPBG_H__
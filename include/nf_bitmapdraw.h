@@ -0,0 +1,246 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright (c) 2009-2014 Cesar Rincon "NightFox"
+//
+// NightFox LIB - Include de funciones de dibujo en fondos Bitmap
+// http://www.nightfoxandco.com/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef NF_BITMAPDRAW_H__
+#define NF_BITMAPDRAW_H__
+
+#include <nds.h>
+
+/// @file   nf_bitmapdraw.h
+/// @brief  Drawing primitives for bitmap backbuffers.
+
+/// @defgroup nf_bitmapdraw Drawing primitives for bitmap backbuffers.
+///
+/// Functions to draw lines, rectangles, circles and small paletted images into
+/// the 16-bit and 8-bit backbuffers. All of them clip against the 256x256
+/// backbuffer and mark the area they draw as dirty, so they can be used with
+/// NF_Flip16bitsBackBufferDirty() and NF_Flip8bitsBackBufferDirty().
+///
+/// Colors of 16-bit primitives should have BIT(15) set to be visible. Colors of
+/// 8-bit primitives are palette indices.
+///
+/// Example:
+/// ```
+/// NF_Fill16bitsRect(0, 8, 8, 64, 16, RGB15(0, 0, 16) | BIT(15));
+/// NF_Draw16bitsLine(0, 8, 8, 71, 23, RGB15(31, 31, 31) | BIT(15));
+/// NF_Flip16bitsBackBufferDirty(0);
+/// ```
+///
+/// @{
+
+/// Minimum size in bytes of a block filled with DMA instead of the CPU.
+///
+/// Only blocks that are contiguous in the backbuffer are filled with DMA
+/// (spans and full width rectangles), as the cache of the destination needs to
+/// be maintained for each block.
+#define NF_BITMAPDRAW_DMA_MIN 1024
+
+/// Draws a horizontal line in the 16-bit backbuffer.
+///
+/// Example:
+/// ```
+/// // Draw a white line of 100 pixels at (10, 20)
+/// NF_Draw16bitsHLine(0, 10, 20, 100, RGB15(31, 31, 31) | BIT(15));
+/// ```
+///
+/// @param screen Screen (0 - 1).
+/// @param x X coordinate of the left end.
+/// @param y Y coordinate.
+/// @param w Length.
+/// @param color Color.
+void NF_Draw16bitsHLine(u8 screen, s16 x, s16 y, u16 w, u16 color);
+
+/// Draws a vertical line in the 16-bit backbuffer.
+///
+/// Example:
+/// ```
+/// // Draw a white line of 50 pixels at (10, 20)
+/// NF_Draw16bitsVLine(0, 10, 20, 50, RGB15(31, 31, 31) | BIT(15));
+/// ```
+///
+/// @param screen Screen (0 - 1).
+/// @param x X coordinate.
+/// @param y Y coordinate of the top end.
+/// @param h Length.
+/// @param color Color.
+void NF_Draw16bitsVLine(u8 screen, s16 x, s16 y, u16 h, u16 color);
+
+/// Fills a rectangle in the 16-bit backbuffer.
+///
+/// Example:
+/// ```
+/// // Clear the backbuffer to black
+/// NF_Fill16bitsRect(0, 0, 0, 256, 256, BIT(15));
+/// ```
+///
+/// @param screen Screen (0 - 1).
+/// @param x X coordinate.
+/// @param y Y coordinate.
+/// @param w Width.
+/// @param h Height.
+/// @param color Color.
+void NF_Fill16bitsRect(u8 screen, s16 x, s16 y, u16 w, u16 h, u16 color);
+
+/// Draws a line between two points in the 16-bit backbuffer.
+///
+/// Both points are drawn.
+///
+/// Example:
+/// ```
+/// NF_Draw16bitsLine(0, 0, 0, 255, 191, RGB15(31, 0, 0) | BIT(15));
+/// ```
+///
+/// @param screen Screen (0 - 1).
+/// @param x1 X coordinate of the first point.
+/// @param y1 Y coordinate of the first point.
+/// @param x2 X coordinate of the second point.
+/// @param y2 Y coordinate of the second point.
+/// @param color Color.
+void NF_Draw16bitsLine(u8 screen, s16 x1, s16 y1, s16 x2, s16 y2, u16 color);
+
+/// Draws a circle in the 16-bit backbuffer.
+///
+/// Example:
+/// ```
+/// // Draw a filled circle with a radius of 20 pixels at (128, 96)
+/// NF_Draw16bitsCircle(0, 128, 96, 20, RGB15(0, 31, 0) | BIT(15), true);
+/// ```
+///
+/// @param screen Screen (0 - 1).
+/// @param x X coordinate of the center.
+/// @param y Y coordinate of the center.
+/// @param radius Radius.
+/// @param color Color.
+/// @param fill True to fill the circle, false to draw the outline.
+void NF_Draw16bitsCircle(u8 screen, s16 x, s16 y, u16 radius, u16 color, bool fill);
+
+/// Draws an image of 8-bit palette indices in the 16-bit backbuffer.
+///
+/// Pixels with index 0 aren't drawn. The rest are converted to 16-bit colors
+/// using the palette.
+///
+/// Example:
+/// ```
+/// // Draw a 16x16 icon at (200, 8)
+/// NF_Draw16bitsSprite(0, icon_data, icon_pal, 200, 8, 16, 16);
+/// ```
+///
+/// @param screen Screen (0 - 1).
+/// @param data Palette indices of the image, one byte per pixel.
+/// @param pal Palette (256 colors).
+/// @param x X coordinate.
+/// @param y Y coordinate.
+/// @param w Width of the image.
+/// @param h Height of the image.
+void NF_Draw16bitsSprite(u8 screen, const u8 *data, const u16 *pal, s16 x, s16 y,
+                         u16 w, u16 h);
+
+/// Draws a horizontal line in the 8-bit backbuffer.
+///
+/// Example:
+/// ```
+/// NF_Draw8bitsHLine(0, 10, 20, 100, 1);
+/// ```
+///
+/// @param screen Screen (0 - 1).
+/// @param x X coordinate of the left end.
+/// @param y Y coordinate.
+/// @param w Length.
+/// @param color Palette index.
+void NF_Draw8bitsHLine(u8 screen, s16 x, s16 y, u16 w, u8 color);
+
+/// Draws a vertical line in the 8-bit backbuffer.
+///
+/// Example:
+/// ```
+/// NF_Draw8bitsVLine(0, 10, 20, 50, 1);
+/// ```
+///
+/// @param screen Screen (0 - 1).
+/// @param x X coordinate.
+/// @param y Y coordinate of the top end.
+/// @param h Length.
+/// @param color Palette index.
+void NF_Draw8bitsVLine(u8 screen, s16 x, s16 y, u16 h, u8 color);
+
+/// Fills a rectangle in the 8-bit backbuffer.
+///
+/// Example:
+/// ```
+/// // Clear the backbuffer with color 0
+/// NF_Fill8bitsRect(0, 0, 0, 256, 256, 0);
+/// ```
+///
+/// @param screen Screen (0 - 1).
+/// @param x X coordinate.
+/// @param y Y coordinate.
+/// @param w Width.
+/// @param h Height.
+/// @param color Palette index.
+void NF_Fill8bitsRect(u8 screen, s16 x, s16 y, u16 w, u16 h, u8 color);
+
+/// Draws a line between two points in the 8-bit backbuffer.
+///
+/// Both points are drawn.
+///
+/// Example:
+/// ```
+/// NF_Draw8bitsLine(0, 0, 0, 255, 191, 2);
+/// ```
+///
+/// @param screen Screen (0 - 1).
+/// @param x1 X coordinate of the first point.
+/// @param y1 Y coordinate of the first point.
+/// @param x2 X coordinate of the second point.
+/// @param y2 Y coordinate of the second point.
+/// @param color Palette index.
+void NF_Draw8bitsLine(u8 screen, s16 x1, s16 y1, s16 x2, s16 y2, u8 color);
+
+/// Draws a circle in the 8-bit backbuffer.
+///
+/// Example:
+/// ```
+/// NF_Draw8bitsCircle(0, 128, 96, 20, 3, false);
+/// ```
+///
+/// @param screen Screen (0 - 1).
+/// @param x X coordinate of the center.
+/// @param y Y coordinate of the center.
+/// @param radius Radius.
+/// @param color Palette index.
+/// @param fill True to fill the circle, false to draw the outline.
+void NF_Draw8bitsCircle(u8 screen, s16 x, s16 y, u16 radius, u8 color, bool fill);
+
+/// Draws an image of 8-bit palette indices in the 8-bit backbuffer.
+///
+/// Pixels with index 0 aren't drawn. The image uses the palette of the
+/// backbuffer.
+///
+/// Example:
+/// ```
+/// NF_Draw8bitsSprite(0, icon_data, 200, 8, 16, 16);
+/// ```
+///
+/// @param screen Screen (0 - 1).
+/// @param data Palette indices of the image, one byte per pixel.
+/// @param x X coordinate.
+/// @param y Y coordinate.
+/// @param w Width of the image.
+/// @param h Height of the image.
+void NF_Draw8bitsSprite(u8 screen, const u8 *data, s16 x, s16 y, u16 w, u16 h);
+
+/// @}
+
+#endif // NF_BITMAPDRAW_H__
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,148 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright (c) 2009-2014 Cesar Rincon "NightFox"
+//
+// NightFox LIB - Include de funciones de descompresion
+// http://www.nightfoxandco.com/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef NF_COMPRESS_H__
+#define NF_COMPRESS_H__
+
+#include <nds.h>
+
+/// @file   nf_compress.h
+/// @brief  Functions to decompress data in the formats of the DS BIOS.
+
+/// @defgroup nf_compress Functions to decompress data in the formats of the DS BIOS.
+///
+/// The supported formats are the ones that the BIOS of the GBA and DS can
+/// decompress: LZ77 (type 0x10 and the 0x11 variant used by DS games), RLE
+/// (0x30) and Huffman with 4 and 8 bit symbols (0x24 and 0x28). They can be
+/// generated by grit and by most DS compression tools.
+///
+/// All the loaders of NFLib detect compressed files by their header and
+/// decompress them automatically, so files can be compressed without changing
+/// the code that loads them. Data is only considered compressed if the size in
+/// the header is possible for the size of the data and if decompressing it
+/// uses all the data (up to 3 bytes of padding are allowed). Anything else is
+/// loaded as it is, so uncompressed files that start with a byte that matches
+/// a compression type still load correctly.
+///
+/// @{
+
+/// LZ77 compression type.
+#define NF_COMPRESS_LZ77 0x10
+
+/// LZ77 compression type with extended lengths (LZ11).
+#define NF_COMPRESS_LZ11 0x11
+
+/// Huffman compression type with 4-bit symbols.
+#define NF_COMPRESS_HUFF4 0x24
+
+/// Huffman compression type with 8-bit symbols.
+#define NF_COMPRESS_HUFF8 0x28
+
+/// RLE compression type.
+#define NF_COMPRESS_RLE 0x30
+
+/// Returns the size of the decompressed data if it has a valid header.
+///
+/// The header is only valid if the format can produce that size from the size
+/// of the data. This doesn't check the rest of the data, use
+/// NF_CheckCompressed() for that.
+///
+/// Example:
+/// ```
+/// // Check if the data in "buffer" is compressed
+/// if (NF_GetDecompressedSize(buffer, size) > 0)
+///     printf("Compressed\n");
+/// ```
+///
+/// @param source Pointer to the compressed data.
+/// @param size Size of the compressed data in bytes.
+/// @return Size of the decompressed data, or 0 if it isn't compressed.
+u32 NF_GetDecompressedSize(const void *source, u32 size);
+
+/// Decompresses data to RAM.
+///
+/// The destination must have space for the number of bytes returned by
+/// NF_GetDecompressedSize().
+///
+/// Example:
+/// ```
+/// // Decompress "data" into a new buffer
+/// u32 out_size = NF_GetDecompressedSize(data, size);
+/// void *out = malloc(out_size);
+/// NF_Decompress(data, size, out);
+/// ```
+///
+/// @param source Pointer to the compressed data.
+/// @param size Size of the compressed data in bytes.
+/// @param destination Destination buffer.
+/// @return True on success, false if the data isn't valid or if it doesn't use
+///         all the source data.
+bool NF_Decompress(const void *source, u32 size, void *destination);
+
+/// Checks if data is valid compressed data without decompressing it anywhere.
+///
+/// Example:
+/// ```
+/// // Check if "data" can be decompressed
+/// if (NF_CheckCompressed(data, size))
+///     printf("Compressed\n");
+/// ```
+///
+/// @param source Pointer to the compressed data.
+/// @param size Size of the compressed data in bytes.
+/// @return True if NF_Decompress() would succeed with this data.
+bool NF_CheckCompressed(const void *source, u32 size);
+
+/// Decompresses data directly to VRAM.
+///
+/// It works like NF_Decompress(), but it only writes to the destination in
+/// 16-bit units, so it can be used with VRAM. This avoids keeping a copy of
+/// the decompressed data in RAM. The destination must be aligned to 16 bits.
+///
+/// The data is checked with NF_CheckCompressed() before writing anything, so
+/// VRAM isn't modified if the data isn't valid.
+///
+/// Example:
+/// ```
+/// // Decompress "data" to the start of VRAM_A
+/// NF_DecompressToVram(data, size, (void *)0x06000000);
+/// ```
+///
+/// @param source Pointer to the compressed data.
+/// @param size Size of the compressed data in bytes.
+/// @param destination Destination in VRAM.
+/// @return True on success, false if the data isn't valid.
+bool NF_DecompressToVram(const void *source, u32 size, void *destination);
+
+/// Loads a file directly to VRAM, decompressing it if required.
+///
+/// This is useful for data that is only needed in VRAM, because it doesn't
+/// keep a copy of it in RAM. Only the compressed file is kept in RAM while it's
+/// being decompressed.
+///
+/// Example:
+/// ```
+/// // Load "bg/title.img" to the start of VRAM_A
+/// NF_LoadFileToVram("bg/title.img", (void *)0x06000000);
+/// ```
+///
+/// @param file File path, relative to the root folder.
+/// @param destination Destination in VRAM.
+/// @return Number of bytes written to VRAM.
+u32 NF_LoadFileToVram(const char *file, void *destination);
+
+/// @}
+
+#endif // NF_COMPRESS_H__
+
+#ifdef __cplusplus
+}
+#endif
@@ -17,9 +17,13 @@ extern "C" {
 #include <nf_affinebg.h>
 #include <nf_basic.h>
 #include <nf_bitmapbg.h>
+#include <nf_bitmapdraw.h>
 #include <nf_collision.h>
+#include <nf_compress.h>
+#include <nf_loader.h>
 #include <nf_media.h>
 #include <nf_mixedbg.h>
+#include <nf_raster.h>
 #include <nf_sound.h>
 #include <nf_sprite256.h>
 #include <nf_sprite3d.h>
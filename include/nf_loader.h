@@ -0,0 +1,162 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright (c) 2009-2014 Cesar Rincon "NightFox"
+//
+// NightFox LIB - Include de funciones de carga incremental
+// http://www.nightfoxandco.com/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef NF_LOADER_H__
+#define NF_LOADER_H__
+
+#include <nds.h>
+
+/// @file   nf_loader.h
+/// @brief  Incremental loader that spreads loads across several frames.
+
+/// @defgroup nf_loader Incremental loader that spreads loads across several frames.
+///
+/// Functions like NF_LoadTiledBg() read whole files before returning, which
+/// can freeze the game for several frames. The asynchronous versions of the
+/// loaders (NF_LoadTiledBgAsync(), NF_LoadSpriteGfxAsync() and
+/// NF_LoadRawSoundAsync()) reserve the slot and add a job to a queue instead.
+/// Jobs are processed in the order they were queued by NF_LoaderUpdate(),
+/// which reads files in small chunks until the time or size budget of the
+/// frame runs out.
+///
+/// While an asset is being loaded its slot has the "loading" field set to true.
+/// Functions that need the data of a slot that is still loading (like
+/// NF_CreateTiledBg() or NF_VramSpriteGfx()) finish all pending loads first.
+///
+/// @{
+
+/// Maximum number of pending load jobs.
+///
+/// If the queue is full when a new job is added, the oldest job is finished
+/// right away.
+#define NF_LOADER_JOBS 16
+
+/// Maximum number of files loaded by one job.
+#define NF_LOADER_MAX_FILES 3
+
+/// Size of the chunks read by NF_LoaderUpdate() between budget checks.
+#define NF_LOADER_CHUNK_SIZE 4096
+
+/// Hardware timer used by NF_LoaderUpdate() to measure its time budget.
+#define NF_LOADER_TIMER 3
+
+/// Value of a ticket that is always complete.
+#define NF_LOADER_TICKET_DONE 0
+
+/// Function called when all the files of a job have been loaded.
+///
+/// The buffers have been decompressed if required. The function takes
+/// ownership of them.
+///
+/// @param slot Slot passed to NF_LoaderQueue().
+/// @param buffers Buffers with the contents of the files.
+/// @param sizes Sizes of the buffers.
+typedef void (*NF_LoaderCallback)(u32 slot, char **buffers, u32 *sizes);
+
+/// Adds a load job to the queue.
+///
+/// This is used by the asynchronous loaders of NFLib. All files are loaded
+/// from "<root folder>/<file>.<extension>".
+///
+/// Example:
+/// ```
+/// // Load "bg/nfl.img" and "bg/nfl.pal", call Loaded(3, ...) when done
+/// static const char *const ext[] = { "img", "pal" };
+/// u32 ticket = NF_LoaderQueue("bg/nfl", ext, 2, Loaded, 3);
+/// ```
+///
+/// @param file File path without extension, relative to the root folder.
+/// @param extensions Extensions of the files to load.
+/// @param count Number of files (up to NF_LOADER_MAX_FILES).
+/// @param callback Function called when the files are loaded.
+/// @param slot Value passed to the callback.
+/// @return Ticket of the job.
+u32 NF_LoaderQueue(const char *file, const char *const *extensions, u32 count,
+                   NF_LoaderCallback callback, u32 slot);
+
+/// Loads queued files until the budget runs out.
+///
+/// Call this once per frame. At least one chunk is always read, so all jobs
+/// are eventually completed even with a very small budget. A budget of 0
+/// means that there is no limit of that kind. If both are 0, all pending jobs
+/// are completed.
+///
+/// Example:
+/// ```
+/// // Load up to 32 KB or 4 ms of data this frame
+/// NF_LoaderUpdate(32 * 1024, 4000);
+/// ```
+///
+/// @param max_bytes Maximum number of bytes to read.
+/// @param max_usec Maximum time to spend, in microseconds (up to 500 ms).
+/// @return Number of bytes read.
+u32 NF_LoaderUpdate(u32 max_bytes, u32 max_usec);
+
+/// Returns true if the job of a ticket has been completed.
+///
+/// Example:
+/// ```
+/// // Check if the background of the next room has been loaded
+/// if (NF_LoaderIsDone(ticket))
+///     NF_CreateTiledBg(0, 3, "room2");
+/// ```
+///
+/// @param ticket Ticket returned by an asynchronous loader.
+/// @return True if the job is complete.
+bool NF_LoaderIsDone(u32 ticket);
+
+/// Finishes all jobs up to the one of the specified ticket.
+///
+/// Example:
+/// ```
+/// // Make sure that the sound is loaded
+/// NF_LoaderWait(ticket);
+/// ```
+///
+/// @param ticket Ticket returned by an asynchronous loader.
+void NF_LoaderWait(u32 ticket);
+
+/// Finishes all pending jobs.
+///
+/// Example:
+/// ```
+/// // Finish all loads before changing the room
+/// NF_LoaderWaitAll();
+/// ```
+void NF_LoaderWaitAll(void);
+
+/// Returns the number of pending jobs.
+///
+/// Example:
+/// ```
+/// // Show a loading icon while there are pending jobs
+/// if (NF_LoaderPendingJobs() > 0)
+///     NF_ShowSprite(0, 10, true);
+/// ```
+///
+/// @return Number of pending jobs.
+u32 NF_LoaderPendingJobs(void);
+
+/// Cancels all pending jobs that use the specified callback.
+///
+/// The data loaded so far by the cancelled jobs is freed. This is used by the
+/// functions that reset the buffers of NFLib.
+///
+/// @param callback Callback of the jobs to cancel.
+void NF_LoaderCancel(NF_LoaderCallback callback);
+
+/// @}
+
+#endif // NF_LOADER_H__
+
+#ifdef __cplusplus
+}
+#endif
@@ -19,16 +19,21 @@ extern "C" {
 
 /// @defgroup nf_media Functions to load files of common media formats.
 ///
-/// This module contains a function to load BMP files.
+/// This module contains functions to load BMP files.
 ///
 /// @{
 
 /// Load a BMP image into a 16-bit background slot.
 ///
-/// It supports 8, 16 and 24 bits BMP images. To load and show the image, you
-/// must initialize 16 bits mode, the backbuffers and to call
+/// It supports 4, 8, 16, 24 and 32 bits BMP images, uncompressed or compressed
+/// with RLE4 and RLE8, stored bottom-up or top-down. 16 and 32 bits images may
+/// use color masks (BI_BITFIELDS), like RGB565 images. To load and show the
+/// image, you must initialize 16 bits mode, the backbuffers and to call
 /// NF_Draw16bitsImage() to send the image from the RAM slot to the backbuffer.
 ///
+/// The file is decoded row by row straight into the slot, so the only RAM used
+/// apart from the image itself is a buffer of one row.
+///
 /// All pixels drawn out of bounds are ignored.
 ///
 /// Example:
@@ -41,6 +46,28 @@ extern "C" {
 /// @param slot Slot number (0 - 15).
 void NF_LoadBMP(const char *file, u8 slot);
 
+/// Load a BMP image directly into the 16-bit bitmap background of a screen.
+///
+/// It supports the same formats as NF_LoadBMP(). The image is decoded row by
+/// row into VRAM without keeping a copy of it in RAM, so it's useful for
+/// images that are only shown once, like splash screens. 16 bits mode must be
+/// initialized. If page flipping is enabled, the image is loaded to the page
+/// being displayed.
+///
+/// All pixels drawn out of bounds are ignored.
+///
+/// Example:
+/// ```
+/// // Load "lostend.bmp" to the top screen, at (0, 0)
+/// NF_LoadBMPToVram("bmp/lostend", 0, 0, 0);
+/// ```
+///
+/// @param file File path.
+/// @param screen Screen (0 - 1).
+/// @param x X coordinate.
+/// @param y Y coordinate.
+void NF_LoadBMPToVram(const char *file, u8 screen, s16 x, s16 y);
+
 /// @}
 
 #endif // NF_MEDIA_H__
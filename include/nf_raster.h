@@ -0,0 +1,223 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright (c) 2009-2014 Cesar Rincon "NightFox"
+//
+// NightFox LIB - Include de funciones de efectos por linea
+// http://www.nightfoxandco.com/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef NF_RASTER_H__
+#define NF_RASTER_H__
+
+#include <nds.h>
+
+/// @file   nf_raster.h
+/// @brief  Per-scanline raster effects driven by HBlank DMA.
+
+/// @defgroup nf_raster Per-scanline raster effects driven by HBlank DMA.
+///
+/// Raster effects change the value of some video registers on every scanline:
+/// wave effects, parallax bands, perspective floors, gradients... Instead of
+/// using an HBlank interrupt handler, which interrupts the CPU 192 times per
+/// frame, this system keeps a table with the values of each line and lets a
+/// DMA channel copy them to the registers during each HBlank period.
+///
+/// The table is double buffered. Fill the values of the next frame with
+/// NF_RasterSetScroll(), NF_RasterSetAffine(), NF_RasterSetBlend() or
+/// NF_RasterGetLine(), call NF_RasterSwap() and the new table will be used from
+/// the next VBlank. NF_RasterVBlank() must be called from the VBlank interrupt
+/// handler.
+///
+/// Only one effect can be active at the same time, as it uses a single DMA
+/// channel (the rest are used by NF_DmaMemCopyAsync()).
+///
+/// Example:
+/// ```
+/// irqSet(IRQ_VBLANK, NF_RasterVBlank);
+/// NF_RasterStart(0, NF_RASTER_SCROLL, 3);
+///
+/// while (1)
+/// {
+///     for (int line = 0; line < 192; line++)
+///         NF_RasterSetScroll(line, sinLerp((line + frame) << 8) >> 9, 0);
+///     NF_RasterSwap();
+///     swiWaitForVBlank();
+/// }
+/// ```
+///
+/// @{
+
+/// DMA channel used to copy the values to the registers on each HBlank.
+#define NF_RASTER_DMA_CHANNEL 0
+
+/// Number of lines of the screen.
+#define NF_RASTER_LINES 192
+
+/// Maximum number of 16-bit registers written on each line.
+#define NF_RASTER_MAX_REGS 8
+
+/// Scroll of a regular tiled BG (BGxHOFS, BGxVOFS).
+///
+/// The values of each line are added to the scroll set by NF_ScrollBg().
+#define NF_RASTER_SCROLL 0
+
+/// Affine matrix and reference point of an affine BG (BGxPA to BGxPD, BGxX,
+/// BGxY).
+///
+/// The values of each line replace the ones set by NF_AffineBgMove(). All lines
+/// start with the values of the BG when the effect is started.
+#define NF_RASTER_AFFINE 1
+
+/// Color special effects (BLDCNT, BLDALPHA, BLDY).
+#define NF_RASTER_BLEND 2
+
+/// Starts a raster effect.
+///
+/// If another effect is active, it is stopped. All lines of both tables start
+/// with the current values of the registers (or 0 for scroll offsets).
+///
+/// Example:
+/// ```
+/// // Start a perspective effect on affine layer 2 of the top screen
+/// NF_RasterStart(0, NF_RASTER_AFFINE, 2);
+/// ```
+///
+/// @param screen Screen (0 - 1).
+/// @param type Effect type (NF_RASTER_SCROLL, NF_RASTER_AFFINE or
+///             NF_RASTER_BLEND).
+/// @param layer Layer (0 - 3 for scroll, 2 - 3 for affine, ignored for blend).
+void NF_RasterStart(u8 screen, u8 type, u8 layer);
+
+/// Stops the active raster effect.
+///
+/// The registers keep the values of the last line. Scroll effects restore the
+/// scroll set by NF_ScrollBg().
+///
+/// Example:
+/// ```
+/// NF_RasterStop();
+/// ```
+void NF_RasterStop(void);
+
+/// Returns true if the active raster effect is of the specified type and uses
+/// the specified screen and layer.
+///
+/// Example:
+/// ```
+/// if (!NF_RasterUses(0, NF_RASTER_AFFINE, 2))
+///     NF_RasterStart(0, NF_RASTER_AFFINE, 2);
+/// ```
+///
+/// @param screen Screen (0 - 1).
+/// @param type Effect type.
+/// @param layer Layer (0 - 3, ignored for blend).
+/// @return True if the effect is active.
+bool NF_RasterUses(u8 screen, u8 type, u8 layer);
+
+/// Sets the scroll of a regular tiled BG.
+///
+/// Internal use. NF_ScrollBg() calls it with the values for the scroll
+/// registers. If a NF_RASTER_SCROLL effect uses that layer the values are used
+/// as the base of the per-line offsets and it returns true, so the registers
+/// aren't written directly.
+///
+/// @param screen Screen (0 - 1).
+/// @param layer Layer (0 - 3).
+/// @param x Horizontal scroll.
+/// @param y Vertical scroll.
+/// @return True if the scroll registers are managed by the raster system.
+bool NF_RasterScrollBg(u8 screen, u8 layer, u16 x, u16 y);
+
+/// Returns the values of a line of the table that is being filled.
+///
+/// The line has as many 16-bit values as registers used by the effect type, in
+/// the order of the registers.
+///
+/// Example:
+/// ```
+/// // Disable the blending effect in line 100
+/// NF_RasterGetLine(100)[0] = 0;
+/// ```
+///
+/// @param line Line (0 - 191).
+/// @return Pointer to the values of the line.
+u16 *NF_RasterGetLine(u8 line);
+
+/// Sets the scroll offset of a line of a NF_RASTER_SCROLL effect.
+///
+/// Example:
+/// ```
+/// // Move line 40 eight pixels to the left
+/// NF_RasterSetScroll(40, 8, 0);
+/// ```
+///
+/// @param line Line (0 - 191).
+/// @param x Horizontal offset.
+/// @param y Vertical offset.
+void NF_RasterSetScroll(u8 line, s16 x, s16 y);
+
+/// Sets the affine values of a line of a NF_RASTER_AFFINE effect.
+///
+/// Example:
+/// ```
+/// // Scale line 120 by 0.5 horizontally
+/// NF_RasterSetAffine(120, 128, 0, 0, 256, x << 8, y << 8);
+/// ```
+///
+/// @param line Line (0 - 191).
+/// @param pa BGxPA (8.8 fixed point).
+/// @param pb BGxPB (8.8 fixed point).
+/// @param pc BGxPC (8.8 fixed point).
+/// @param pd BGxPD (8.8 fixed point).
+/// @param x BGxX (20.8 fixed point).
+/// @param y BGxY (20.8 fixed point).
+void NF_RasterSetAffine(u8 line, s16 pa, s16 pb, s16 pc, s16 pd, s32 x, s32 y);
+
+/// Sets the blending values of a line of a NF_RASTER_BLEND effect.
+///
+/// Example:
+/// ```
+/// // Fade line 10 to black by 8/16
+/// NF_RasterSetBlend(10, BLEND_FADE_BLACK | BLEND_SRC_BG3, 0, 8);
+/// ```
+///
+/// @param line Line (0 - 191).
+/// @param control Value of BLDCNT.
+/// @param alpha Value of BLDALPHA.
+/// @param brightness Value of BLDY.
+void NF_RasterSetBlend(u8 line, u16 control, u16 alpha, u16 brightness);
+
+/// Makes the table that is being filled visible from the next VBlank.
+///
+/// The values of the table are kept, so only the lines that change need to be
+/// set again. Don't modify the table between this call and the next VBlank.
+///
+/// Example:
+/// ```
+/// NF_RasterSwap();
+/// swiWaitForVBlank();
+/// ```
+void NF_RasterSwap(void);
+
+/// Restarts the HBlank DMA of the active raster effect.
+///
+/// Call it from the VBlank interrupt handler (or right after
+/// swiWaitForVBlank()). It writes the values of the first line to the
+/// registers and programs the DMA copy of the rest of lines.
+///
+/// Example:
+/// ```
+/// irqSet(IRQ_VBLANK, NF_RasterVBlank);
+/// ```
+void NF_RasterVBlank(void);
+
+/// @}
+
+#endif // NF_RASTER_H__
+
+#ifdef __cplusplus
+}
+#endif
@@ -35,6 +35,7 @@ typedef struct {
     u32 size;           ///< Size of the sound effect in bytes
     u16 freq;           ///< Frecuency of the sample
     u8 format;          ///< Format of the sample (0: 8 bits, 1: 16 bits, 2: ADPCM)
+    bool loading;       ///< True while NF_LoadRawSoundAsync() is loading it
 } NF_TYPE_RAWSOUND_INFO;
 
 /// Information of all sound effects.
@@ -69,6 +70,26 @@ void NF_ResetRawSoundBuffers(void);
 /// @param format Sample format (0 -> 8 bits, 1 -> 16 bits, 2 -> ADPCM).
 void NF_LoadRawSound(const char *file, u16 id,  u16 freq, u8 format);
 
+/// Load a RAW file from the filesystem to RAM across several frames.
+///
+/// It works like NF_LoadRawSound(), but the file is read by NF_LoaderUpdate()
+/// in small chunks. NF_TYPE_RAWSOUND_INFO.loading is true until it has been
+/// loaded. If the sound is played before it's loaded, all pending loads are
+/// finished first.
+///
+/// Example:
+/// ```
+/// // Start loading the music of the next room
+/// u32 ticket = NF_LoadRawSoundAsync("music2", 2, 22050, 0);
+/// ```
+///
+/// @param file File name without extension
+/// @param id Destination slot number (0 - 31)
+/// @param freq Frequency of the sample in Hz (11025, 22050, etc)
+/// @param format Sample format (0 -> 8 bits, 1 -> 16 bits, 2 -> ADPCM).
+/// @return Ticket to use with NF_LoaderIsDone() and NF_LoaderWait().
+u32 NF_LoadRawSoundAsync(const char *file, u16 id, u16 freq, u8 format);
+
 /// Deletes from RAM the sound file stored in the specified slot.
 ///
 /// @param id Slot number (0 - 31)
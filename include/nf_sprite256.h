@@ -41,6 +41,7 @@ typedef struct {
     u16 width;          ///< Width of graphics data
     u16 height;         ///< Height of graphics data
     bool available;     ///< True if this slot is free, false otherwise
+    bool loading;       ///< True while NF_LoadSpriteGfxAsync() is loading it
 } NF_TYPE_SPR256GFX_INFO;
 
 /// Information of all sprite graphics in RAM
@@ -197,6 +198,26 @@ void NF_InitSpriteSys(int screen, ...);
 /// @param height Height of the graphics object (in pixels).
 void NF_LoadSpriteGfx(const char *file, u16 id, u16 width, u16 height);
 
+/// Load sprite graphics from the filesystem to RAM across several frames.
+///
+/// It works like NF_LoadSpriteGfx(), but the file is read by NF_LoaderUpdate()
+/// in small chunks. NF_TYPE_SPR256GFX_INFO.loading is true until it has been
+/// loaded. If the graphics are copied to VRAM before they are loaded, all
+/// pending loads are finished first.
+///
+/// Example:
+/// ```
+/// // Start loading the graphics of the enemy of the next room
+/// u32 ticket = NF_LoadSpriteGfxAsync("stage3/enemy", 101, 32, 32);
+/// ```
+///
+/// @param file File name without extension.
+/// @param id Slot number (0 - 255).
+/// @param width Width of the graphics object (in pixels).
+/// @param height Height of the graphics object (in pixels).
+/// @return Ticket to use with NF_LoaderIsDone() and NF_LoaderWait().
+u32 NF_LoadSpriteGfxAsync(const char *file, u16 id, u16 width, u16 height);
+
 /// Delete from RAM the graphics of the selected slot and mark it as free.
 ///
 /// You can delete the graphics from RAM once the sprite is created if you
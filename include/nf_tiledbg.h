@@ -29,6 +29,12 @@ extern "C" {
 /// Maximum number of slots for extended palettes (max 16 per background)
 #define NF_SLOTS_EXBGPAL 128
 
+/// Maximum number of animated tile groups
+#define NF_SLOTS_TBGANIM 32
+
+/// Maximum number of frames of an animated tile group
+#define NF_TBGANIM_FRAMES 32
+
 /// Maxmimum number of VRAM blocks used for tilesets
 #define NF_MAX_BANKS_TILES 8
 
@@ -56,6 +62,15 @@ extern char *NF_BUFFER_BGMAP[NF_SLOTS_TBG];
 /// Buffers to hold background palettes.
 extern char *NF_BUFFER_BGPAL[NF_SLOTS_TBG];
 
+/// Buffers to hold the metatile dictionaries of metatile backgrounds.
+///
+/// Each metatile is a square of 2x2 or 4x4 map entries, stored row by row. The
+/// map buffer of those backgrounds holds one u16 metatile index per metatile.
+extern char *NF_BUFFER_BGMETA[NF_SLOTS_TBG];
+
+/// Number of times each metatile is used by the map of metatile backgrounds.
+extern u16 *NF_BUFFER_BGMETAREFS[NF_SLOTS_TBG];
+
 /// Struct that holds information about regular tiled backgrounds.
 typedef struct {
     char name[32];      ///< Background name
@@ -64,12 +79,32 @@ typedef struct {
     u32 palsize;        ///< Palette size
     u16 width;          ///< Background width
     u16 height;         ///< Background height
+    u32 namehash;       ///< Hash of the name, used by the name index
+    u8 hashnext;        ///< Next slot in the same index bucket (255 = none)
     bool available;     ///< If the background is available it is true.
+    bool loading;       ///< True while NF_LoadTiledBgAsync() is loading it
+    u8 bpp;             ///< Bits per pixel of the tiles (8: 256 colors, 4: 16 colors)
+    u8 metashift;       ///< Metatile side as a shift of tiles (0: no metatiles, 1: 16x16, 2: 32x32)
+    u32 metacount;      ///< Number of metatiles in the dictionary
+    bool deduped;       ///< True if NF_DedupTiledBg() has been used on it
 } NF_TYPE_TBG_INFO;
 
 /// Information of all tiled backgrounds.
 extern NF_TYPE_TBG_INFO NF_TILEDBG[NF_SLOTS_TBG];
 
+/// Number of buckets of the name index of tiled backgrounds (power of 2)
+#define NF_TILEDBG_HASH_BUCKETS 64
+
+/// Name index of tiled backgrounds.
+///
+/// Each bucket holds the first slot whose name hash falls in it (255 if
+/// empty). The rest of slots of the bucket are chained with
+/// NF_TYPE_TBG_INFO.hashnext.
+extern u8 NF_TILEDBG_HASHTABLE[NF_TILEDBG_HASH_BUCKETS];
+
+/// Bitmap of free tiled background slots (1 bit per slot, set if free).
+extern u32 NF_TILEDBG_FREESLOTS[(NF_SLOTS_TBG + 31) >> 5];
+
 /// Struct that holds information about extended palettes.
 typedef struct {
     char *buffer;   ///< Buffer that holds the palette
@@ -80,6 +115,22 @@ typedef struct {
 /// Information of all extended palettes.
 extern NF_TYPE_EXBGPAL_INFO NF_EXBGPAL[NF_SLOTS_EXBGPAL];
 
+/// Struct that holds information about a group of animated tiles.
+typedef struct {
+    u16 tile;       ///< First animated tile of the tileset
+    u16 count;      ///< Number of animated tiles
+    u16 source;     ///< First tile of the graphics of frame 0
+    u8 slot;        ///< Tiled BG slot that owns the tileset
+    u8 frames;      ///< Number of frames
+    u8 frame;       ///< Current frame
+    u8 timer;       ///< Frames left until the next animation frame
+    u8 delays[NF_TBGANIM_FRAMES]; ///< Duration of each frame (in frames)
+    bool inuse;     ///< True if the slot is in use.
+} NF_TYPE_TBGANIM_INFO;
+
+/// Information of all animated tile groups.
+extern NF_TYPE_TBGANIM_INFO NF_TBGANIM[NF_SLOTS_TBGANIM];
+
 /// Struct that holds information about backgrounds loaded to the screen.
 ///
 /// The hardware of the DS doesn't allow using maps bigger than 512x512 pixels.
@@ -105,12 +156,31 @@ typedef struct {
     u8 bgslot;          ///< Graphics buffer used (NF_BUFFER_BGMAP)
     u8 blockx;          ///< Map block (horizontal)
     u8 blocky;          ///< Map block (vertical)
+    u16 streamx;        ///< First tile column of the streamed window (0xFFFF = none)
+    u16 streamy;        ///< First tile row of the streamed window
+    bool streaming;     ///< True if the map is streamed by rows and columns
     bool created;       ///< True if the background has been created
+    u32 dirtyrows[4];   ///< Changed rows of each 32x32 block of the map in VRAM
+    u8 dirtyleft[4];    ///< First changed column of each block of the map in VRAM
+    u8 dirtyright[4];   ///< Last changed column of each block of the map in VRAM
+    u16 *staging;       ///< Expanded map blocks of metatile backgrounds
 } NF_TYPE_TBGLAYERS_INFO;
 
+/// Width in tiles of the window kept up to date when streaming a tiled BG.
+#define NF_STREAM_WINDOW_WIDTH 33
+
+/// Height in tiles of the window kept up to date when streaming a tiled BG.
+#define NF_STREAM_WINDOW_HEIGHT 25
+
 /// Information of all backgrounds loaded to the screen
 extern NF_TYPE_TBGLAYERS_INFO NF_TILEDBG_LAYERS[2][4]; //[screen][layer]
 
+/// Number of bytes of tiled BG maps copied to VRAM.
+///
+/// It is increased by NF_UpdateVramMap() and NF_ScrollBg(). Set it to 0 at the
+/// start of each frame to measure the map data uploaded per frame.
+extern u32 NF_TILEDBG_UPLOAD_BYTES;
+
 /// Array of free blocks used for tiles
 extern u8 NF_TILEBLOCKS[2][NF_MAX_BANKS_TILES];
 
@@ -196,6 +266,100 @@ void NF_InitTiledBgSys(u8 screen);
 /// @param height BG height.
 void NF_LoadTiledBg(const char *file, const char *name, u16 width, u16 height);
 
+/// Load all files needed to create a 16 color tiled BG from FAT to RAM.
+///
+/// It works like NF_LoadTiledBg(), but the tiles use 4 bits per pixel (32 bytes
+/// per tile), so they use half the RAM and VRAM of a 256 color BG. Convert the
+/// graphics with the "-gB4" option of grit.
+///
+/// 16 color BGs don't use extended palettes. The palette file (up to 16
+/// palettes of 16 colors) is copied to the standard BG palette of the screen,
+/// which is shared by all 16 color BGs of that screen. Each tile selects its
+/// palette with NF_SetTilePal().
+///
+/// Example:
+/// ```
+/// // Load to RAM files "hud.img", "hud.map" and "hud.pal" from the "ui"
+/// // subfolder as a 16 color BG called "hud", of 256 x 256 pixels.
+/// NF_LoadTiledBg4bpp("ui/hud", "hud", 256, 256);
+/// ```
+///
+/// @param file File path without extension.
+/// @param name Name used for the BG for other functions.
+/// @param width BG width.
+/// @param height BG height.
+void NF_LoadTiledBg4bpp(const char *file, const char *name, u16 width, u16 height);
+
+/// Load a tiled BG that uses a metatile map from FAT to RAM.
+///
+/// Instead of one map entry per 8x8 tile, the MAP file holds one u16 index per
+/// metatile of 16x16 or 32x32 pixels, row by row, and the MTL file holds the
+/// dictionary of metatiles: 4 or 16 map entries per metatile, row by row. Big
+/// maps built from repeated blocks use a fraction of the RAM of a regular map.
+///
+/// The map is expanded to regular map entries only when it is copied to VRAM,
+/// when the BG is created and while it is scrolled. NF_GetTileOfMap() and the
+/// rest of functions that edit tiles work with the expanded map. Editing a
+/// tile of a metatile that is used in other places of the map makes a copy of
+/// the metatile first, so only that position of the map changes.
+///
+/// IMG and PAL files are the same as in NF_LoadTiledBg(). Use "nfmeta.py" from
+/// the tools folder to convert the MAP file of grit to MAP and MTL files.
+///
+/// Example:
+/// ```
+/// // Load to RAM files "world.img", "world.map", "world.mtl" and "world.pal"
+/// // from the "maps" subfolder as a BG called "world", of 4096 x 4096 pixels,
+/// // built from metatiles of 16 x 16 pixels.
+/// NF_LoadMetatileBg("maps/world", "world", 4096, 4096, 16);
+/// ```
+///
+/// @param file File path without extension.
+/// @param name Name used for the BG for other functions.
+/// @param width BG width.
+/// @param height BG height.
+/// @param metasize Size of the metatiles in pixels (16 or 32).
+void NF_LoadMetatileBg(const char *file, const char *name, u16 width, u16 height,
+                       u8 metasize);
+
+/// Load all files needed to create a tiled BG across several frames.
+///
+/// It works like NF_LoadTiledBg(), but the files are read by NF_LoaderUpdate()
+/// in small chunks. The BG can be referenced by its name right away, and
+/// NF_TYPE_TBG_INFO.loading is true until all files have been loaded. If the BG
+/// is used before it's loaded, all pending loads are finished first.
+///
+/// Example:
+/// ```
+/// // Start loading the BG of the next room while the game keeps running
+/// u32 ticket = NF_LoadTiledBgAsync("stage1/room2", "room2", 512, 256);
+/// ```
+///
+/// @param file File path without extension.
+/// @param name Name used for the BG for other functions.
+/// @param width BG width.
+/// @param height BG height.
+/// @return Ticket to use with NF_LoaderIsDone() and NF_LoaderWait().
+u32 NF_LoadTiledBgAsync(const char *file, const char *name, u16 width, u16 height);
+
+/// Load all files needed to create a 16 color tiled BG across several frames.
+///
+/// It works like NF_LoadTiledBgAsync(), but the BG is loaded like with
+/// NF_LoadTiledBg4bpp().
+///
+/// Example:
+/// ```
+/// // Start loading the 16 color HUD of the next room
+/// u32 ticket = NF_LoadTiledBg4bppAsync("ui/hud2", "hud2", 256, 256);
+/// ```
+///
+/// @param file File path without extension.
+/// @param name Name used for the BG for other functions.
+/// @param width BG width.
+/// @param height BG height.
+/// @return Ticket to use with NF_LoaderIsDone() and NF_LoaderWait().
+u32 NF_LoadTiledBg4bppAsync(const char *file, const char *name, u16 width, u16 height);
+
 /// Load a tilesed and palette from FAT to RAM.
 ///
 /// It works like NF_LoadTiledBg() but it lets you specify the range of tiles to
@@ -220,6 +384,79 @@ void NF_LoadTiledBg(const char *file, const char *name, u16 width, u16 height);
 void NF_LoadTilesForBg(const char *file, const char *name, u16 width, u16 height,
                        u16 tile_start, u16 tile_end);
 
+/// Load a 16 color tilesed and palette from FAT to RAM.
+///
+/// It works like NF_LoadTilesForBg(), but the tiles use 4 bits per pixel (32
+/// bytes per tile), like in NF_LoadTiledBg4bpp().
+///
+/// Example:
+/// ```
+/// // Load to RAM tiles 0 to 23 of the 16 color tileset "ui/font" and its
+/// // palette, and create a blank map of 256x256 pixels called "text".
+/// NF_LoadTilesForBg4bpp("ui/font", "text", 256, 256, 0, 23);
+/// ```
+///
+/// @param file File name, without extension.
+/// @param name Name of the BG.
+/// @param width Width of the BG in pixels.
+/// @param height Height of the BG in pixels.
+/// @param tile_start First tile to load.
+/// @param tile_end Last tile to load.
+void NF_LoadTilesForBg4bpp(const char *file, const char *name, u16 width, u16 height,
+                           u16 tile_start, u16 tile_end);
+
+/// Removes duplicated tiles from a tiled background loaded in RAM.
+///
+/// Tiles that are equal to a previous tile, or to a flipped version of it, are
+/// removed from the tileset, and the map is updated to use the remaining tile
+/// with the right flip bits. Call it after loading the background and before
+/// creating it, so that it uses less VRAM.
+///
+/// Deduplication moves tiles around, so it can't be combined with animated
+/// tiles: it fails with error 121 if the BG has animations, and
+/// NF_CreateTiledBgAnim() fails with the same error after deduplicating it.
+///
+/// Example:
+/// ```
+/// // Load "mainstage" and remove its duplicated tiles
+/// NF_LoadTiledBg("stage1/mainstage", "mifondo", 2048, 256);
+/// NF_DedupTiledBg("mifondo");
+/// ```
+///
+/// @param name Name of the BG.
+/// @return Number of tiles removed.
+u32 NF_DedupTiledBg(const char *name);
+
+/// Reserves a free tiled background slot in RAM and returns its index.
+///
+/// Internal use. It fails with error 103 if there are no free slots.
+///
+/// @return Slot index.
+u8 NF_AllocTiledBgSlot(void);
+
+/// Sets the name of a tiled background slot and adds it to the name index.
+///
+/// Internal use.
+///
+/// @param slot Slot index.
+/// @param name Name of the BG.
+void NF_SetTiledBgName(u8 slot, const char *name);
+
+/// Returns the RAM slot of the BG with the specified name.
+///
+/// The slot can be used as a handle with NF_CreateTiledBgBySlot() and
+/// NF_UnloadTiledBgBySlot() to avoid looking up the name every time.
+///
+/// Example:
+/// ```
+/// // Get the slot used by the BG called "mifondo"
+/// u8 slot = NF_GetTiledBgSlot("mifondo");
+/// ```
+///
+/// @param name Name used for the BG.
+/// @return Slot index.
+u8 NF_GetTiledBgSlot(const char *name);
+
 /// Delete from RAM the BG with the specified name.
 ///
 /// You can delete from RAM the BG if you don't need it more or if the size of
@@ -236,12 +473,32 @@ void NF_LoadTilesForBg(const char *file, const char *name, u16 width, u16 height
 /// @param name Name used for the BG.
 void NF_UnloadTiledBg(const char *name);
 
+/// Delete from RAM the BG stored in the specified slot.
+///
+/// It works like NF_UnloadTiledBg(), but it uses the slot returned by
+/// NF_GetTiledBgSlot() instead of the name of the BG.
+///
+/// Example:
+/// ```
+/// // Delete from RAM the BG stored in slot 3
+/// NF_UnloadTiledBgBySlot(3);
+/// ```
+///
+/// @param slot Slot index.
+void NF_UnloadTiledBgBySlot(u8 slot);
+
 /// Create a BG on the screen, using data loaded in RAM.
 ///
 /// This function copies to VRAM all required data. Before you create the BG,
 /// you must load data to RAM using NF_LoadTiledBg(). The BG is created on the
 /// specified screen and layer.
 ///
+/// The data is placed in the smallest free area of VRAM where it fits. If there
+/// isn't any, the VRAM is compacted with NF_CompactTiledBgVram() first.
+///
+/// If another layer of the same screen already uses the tileset of this BG, the
+/// new layer uses the same tile blocks and the tileset isn't copied again.
+///
 /// Example:
 /// ```
 /// // Create a tiled BG on layer 3 of screen 0, using the BG called "mifondo"
@@ -253,9 +510,27 @@ void NF_UnloadTiledBg(const char *name);
 /// @param name Name used for the BG.
 void NF_CreateTiledBg(u8 screen, u8 layer, const char *name);
 
+/// Create a BG on the screen, using the data loaded in the specified slot.
+///
+/// It works like NF_CreateTiledBg(), but it uses the slot returned by
+/// NF_GetTiledBgSlot() instead of the name of the BG.
+///
+/// Example:
+/// ```
+/// // Create a tiled BG on layer 3 of screen 0, using the BG called "mifondo"
+/// u8 slot = NF_GetTiledBgSlot("mifondo");
+/// NF_CreateTiledBgBySlot(0, 3, slot);
+/// ```
+///
+/// @param screen Screen (0 - 1).
+/// @param layer Layer (0 - 3).
+/// @param slot Slot index.
+void NF_CreateTiledBgBySlot(u8 screen, u8 layer, u8 slot);
+
 /// Delete the BG of the specified screen and layer.
 ///
-/// This also deletes from VRAM the data used by this BG.
+/// This also deletes from VRAM the data used by this BG. The tileset is only
+/// deleted if no other layer of the screen is using it.
 ///
 /// Example:
 /// ```
@@ -267,9 +542,54 @@ void NF_CreateTiledBg(u8 screen, u8 layer, const char *name);
 /// @param layer Layer (0 - 3).
 void NF_DeleteTiledBg(u8 screen, u8 layer);
 
+/// Struct that holds information about the free VRAM of the tiled BGs.
+typedef struct {
+    u8 freetileblocks;      ///< Free 16 KB tile blocks
+    u8 largesttileblocks;   ///< Largest number of contiguous free tile blocks
+    u8 freemapblocks;       ///< Free 2 KB map blocks
+    u8 largestmapblocks;    ///< Largest number of contiguous free map blocks
+} NF_TYPE_TBGVRAM_INFO;
+
+/// Moves the tilesets and maps of all BGs of a screen to the start of VRAM.
+///
+/// After creating and deleting backgrounds the free VRAM may be split in
+/// several small areas. This function moves the data of the backgrounds so that
+/// all the free blocks are together, and updates the control registers of the
+/// backgrounds. NF_CreateTiledBg() calls it automatically if there isn't a free
+/// area big enough for a new background.
+///
+/// The backgrounds that are moved may show corrupted graphics during one frame.
+///
+/// Example:
+/// ```
+/// // Join all free VRAM of the top screen
+/// NF_CompactTiledBgVram(0);
+/// ```
+///
+/// @param screen Screen (0 - 1).
+void NF_CompactTiledBgVram(u8 screen);
+
+/// Gets information about the free VRAM used for tiled BGs.
+///
+/// If the number of free blocks is bigger than the largest number of
+/// contiguous free blocks, the VRAM is fragmented.
+///
+/// Example:
+/// ```
+/// // Check if the tile VRAM of the top screen is fragmented
+/// NF_TYPE_TBGVRAM_INFO info;
+/// NF_GetTiledBgVramInfo(0, &info);
+/// if (info.largesttileblocks < info.freetileblocks)
+///     NF_CompactTiledBgVram(0);
+/// ```
+///
+/// @param screen Screen (0 - 1).
+/// @param info Pointer to the struct to fill.
+void NF_GetTiledBgVramInfo(u8 screen, NF_TYPE_TBGVRAM_INFO *info);
+
 /// Gets the address of the tile at the specified position.
 ///
-/// Internal use.
+/// Internal use. Only valid for BGs that don't use metatiles.
 ///
 /// @param screen Screen (0 - 1).
 /// @param layer Layer (0 - 3).
@@ -278,6 +598,19 @@ void NF_DeleteTiledBg(u8 screen, u8 layer);
 /// @return Tile address.
 u32 NF_GetTileMapAddress(u8 screen, u8 layer, u16 tile_x, u16 tile_y);
 
+/// Copies blocks of 32x32 tiles of the map of a BG in RAM to VRAM.
+///
+/// Internal use. The copy is queued with NF_QueueVramCopy(). The map of BGs
+/// that use metatiles is expanded before copying it.
+///
+/// @param screen Screen (0 - 1).
+/// @param layer Layer (0 - 3).
+/// @param destination Destination address in VRAM.
+/// @param offset Offset of the first block in the expanded map (in bytes).
+/// @param size Number of bytes to copy (multiple of 2 KB).
+void NF_CopyTiledBgMapBlocks(u8 screen, u8 layer, void *destination, u32 offset,
+                             u32 size);
+
 /// Gets the value of the tile at the specified position.
 ///
 /// Example:
@@ -309,11 +642,141 @@ u16 NF_GetTileOfMap(u8 screen, u8 layer, u16 tile_x, u16 tile_y);
 /// @param tile Tile index.
 void NF_SetTileOfMap(u8 screen, u8 layer, u16 tile_x, u16 tile_y, u16 tile);
 
+/// Marks a rectangle of tiles of a map as changed.
+///
+/// NF_SetTileOfMap(), NF_SetTilePal(), NF_SetTileHflip() and NF_SetTileVflip()
+/// do this automatically. Call it if you modify NF_BUFFER_BGMAP directly, so
+/// that NF_UpdateVramMap() copies the changes to VRAM. Tiles that aren't in
+/// VRAM at the moment are ignored.
+///
+/// Example:
+/// ```
+/// // Mark as changed a 20x10 tiles rectangle at (4, 6) of layer 2 of screen 0
+/// NF_MarkTileMapDirty(0, 2, 4, 6, 20, 10);
+/// ```
+///
+/// @param screen Screen (0 - 1).
+/// @param layer Layer (0 - 3).
+/// @param tile_x X coordinate of the first tile.
+/// @param tile_y Y coordinate of the first tile.
+/// @param width Width in tiles.
+/// @param height Height in tiles.
+void NF_MarkTileMapDirty(u8 screen, u8 layer, u16 tile_x, u16 tile_y,
+                         u16 width, u16 height);
+
+/// Fills a rectangle of tiles of a map with the same value.
+///
+/// It is much faster than calling NF_SetTileOfMap() for each tile. The
+/// rectangle is marked as changed, so call NF_UpdateVramMap() afterwards.
+///
+/// Example:
+/// ```
+/// // Clear a 20x10 tiles rectangle at (4, 6) of layer 2 of screen 0 with tile 0
+/// NF_FillTileMapRect(0, 2, 4, 6, 20, 10, 0);
+/// ```
+///
+/// @param screen Screen (0 - 1).
+/// @param layer Layer (0 - 3).
+/// @param tile_x X coordinate of the first tile.
+/// @param tile_y Y coordinate of the first tile.
+/// @param width Width in tiles.
+/// @param height Height in tiles.
+/// @param tile Value of the map entries (tile index, flip and palette bits).
+void NF_FillTileMapRect(u8 screen, u8 layer, u16 tile_x, u16 tile_y,
+                        u16 width, u16 height, u16 tile);
+
+/// Copies a rectangle of tiles from a buffer to a map.
+///
+/// The buffer holds "width * height" map entries, row by row. The rectangle is
+/// marked as changed, so call NF_UpdateVramMap() afterwards.
+///
+/// Example:
+/// ```
+/// // Draw a 20x10 tiles dialog box at (4, 6) of layer 2 of screen 0
+/// NF_SetTileMapRect(0, 2, 4, 6, 20, 10, dialog_box);
+/// ```
+///
+/// @param screen Screen (0 - 1).
+/// @param layer Layer (0 - 3).
+/// @param tile_x X coordinate of the first tile.
+/// @param tile_y Y coordinate of the first tile.
+/// @param width Width in tiles.
+/// @param height Height in tiles.
+/// @param source Map entries to copy.
+void NF_SetTileMapRect(u8 screen, u8 layer, u16 tile_x, u16 tile_y,
+                       u16 width, u16 height, const u16 *source);
+
+/// Copies a rectangle of tiles from a map to a buffer.
+///
+/// The buffer must have space for "width * height" map entries, which are
+/// stored row by row.
+///
+/// Example:
+/// ```
+/// // Save the tiles under a 20x10 tiles dialog box before drawing it
+/// u16 saved[20 * 10];
+/// NF_GetTileMapRect(0, 2, 4, 6, 20, 10, saved);
+/// ```
+///
+/// @param screen Screen (0 - 1).
+/// @param layer Layer (0 - 3).
+/// @param tile_x X coordinate of the first tile.
+/// @param tile_y Y coordinate of the first tile.
+/// @param width Width in tiles.
+/// @param height Height in tiles.
+/// @param destination Buffer where the map entries are stored.
+void NF_GetTileMapRect(u8 screen, u8 layer, u16 tile_x, u16 tile_y,
+                       u16 width, u16 height, u16 *destination);
+
+/// Copies a rectangle of tiles from a map to another one, or to the same one.
+///
+/// The source and destination rectangles can overlap. The destination is
+/// marked as changed, so call NF_UpdateVramMap() afterwards.
+///
+/// Example:
+/// ```
+/// // Copy a 20x10 tiles rectangle at (0, 0) of layer 3 to (4, 6) of layer 2,
+/// // both of screen 0
+/// NF_CopyTileMapRect(0, 3, 0, 0, 0, 2, 4, 6, 20, 10);
+/// ```
+///
+/// @param src_screen Source screen (0 - 1).
+/// @param src_layer Source layer (0 - 3).
+/// @param src_x X coordinate of the first source tile.
+/// @param src_y Y coordinate of the first source tile.
+/// @param dst_screen Destination screen (0 - 1).
+/// @param dst_layer Destination layer (0 - 3).
+/// @param dst_x X coordinate of the first destination tile.
+/// @param dst_y Y coordinate of the first destination tile.
+/// @param width Width in tiles.
+/// @param height Height in tiles.
+void NF_CopyTileMapRect(u8 src_screen, u8 src_layer, u16 src_x, u16 src_y,
+                        u8 dst_screen, u8 dst_layer, u16 dst_x, u16 dst_y,
+                        u16 width, u16 height);
+
+/// Marks the whole map of the specified screen and layer as changed.
+///
+/// The next call to NF_UpdateVramMap() copies all the map that is in VRAM.
+///
+/// Example:
+/// ```
+/// // Copy the whole map of layer 2 of screen 0 in the next update
+/// NF_MarkVramMapDirty(0, 2);
+/// ```
+///
+/// @param screen Screen (0 - 1).
+/// @param layer Layer (0 - 3).
+void NF_MarkVramMapDirty(u8 screen, u8 layer);
+
 /// Updates the map of the specified screen and layer specified.
 ///
 /// This updates the map on VRAM with the copy of RAM, that can be modified. Use
 /// this fuction to apply changes made with NF_SetTileOfMap().
 ///
+/// Only the rows of tiles marked as changed are copied (see
+/// NF_MarkTileMapDirty()), so calling this function when nothing has changed
+/// doesn't copy anything.
+///
 /// Example:
 /// ```
 /// // Update the map in VRAM with the modified copy in RAM of screen 0, layer 2
@@ -324,6 +787,65 @@ void NF_SetTileOfMap(u8 screen, u8 layer, u16 tile_x, u16 tile_y, u16 tile);
 /// @param layer Layer (0 - 3).
 void NF_UpdateVramMap(u8 screen, u8 layer);
 
+/// Enables row and column streaming for a BG bigger than 512 pixels.
+///
+/// By default, when a BG bigger than 512 pixels is scrolled with
+/// NF_ScrollBg(), the whole 4 KB or 8 KB map window is copied to VRAM every
+/// time the camera crosses a 256 pixel boundary. In streaming mode the map in
+/// VRAM is used as a ring buffer, and NF_ScrollBg() only copies the rows and
+/// columns of tiles that become visible. Scrolling one tile copies 50 bytes
+/// at most, regardless of the size of the map.
+///
+/// The map in VRAM is refreshed the next time NF_ScrollBg() is called.
+///
+/// Example:
+/// ```
+/// // Stream the map of layer 3 of the top screen
+/// NF_EnableTiledBgStreaming(0, 3);
+/// NF_ScrollBg(0, 3, x, y);
+/// ```
+///
+/// @param screen Screen (0 - 1).
+/// @param layer Layer (0 - 3).
+void NF_EnableTiledBgStreaming(u8 screen, u8 layer);
+
+/// Disables row and column streaming for a BG.
+///
+/// The map in VRAM is refreshed the next time NF_ScrollBg() is called.
+///
+/// Example:
+/// ```
+/// // Go back to copying map blocks in layer 3 of the top screen
+/// NF_DisableTiledBgStreaming(0, 3);
+/// ```
+///
+/// @param screen Screen (0 - 1).
+/// @param layer Layer (0 - 3).
+void NF_DisableTiledBgStreaming(u8 screen, u8 layer);
+
+/// Copies a rectangle of tiles from the map in RAM to the ring buffer in VRAM.
+///
+/// Internal use. The rectangle is clipped to the size of the BG.
+///
+/// @param screen Screen (0 - 1).
+/// @param layer Layer (0 - 3).
+/// @param tile_x X coordinate of the first tile.
+/// @param tile_y Y coordinate of the first tile.
+/// @param width Width in tiles.
+/// @param height Height in tiles.
+void NF_StreamTiledBgArea(u8 screen, u8 layer, u16 tile_x, u16 tile_y,
+                          u16 width, u16 height);
+
+/// Updates the ring buffer in VRAM of a streamed BG for a new scroll position.
+///
+/// Internal use. Called by NF_ScrollBg().
+///
+/// @param screen Screen (0 - 1).
+/// @param layer Layer (0 - 3).
+/// @param x X coordinate (already clamped to the BG size).
+/// @param y Y coordinate (already clamped to the BG size).
+void NF_StreamTiledBg(u8 screen, u8 layer, s16 x, s16 y);
+
 /// Changes the value of one color of the palette of a background.
 ///
 /// The change is made directly in VRAM, so it may be overwritten from the copy
@@ -546,6 +1068,64 @@ void NF_SetTileVflip(u8 screen, u8 layer, u16 tile_x, u16 tile_y);
 /// @param rotation Rotation value.
 void NF_RotateTileGfx(u8 slot, u16 tile, u8 rotation);
 
+/// Creates a group of animated tiles in the tileset of a tiled BG.
+///
+/// The graphics of the frames are stored in the same tileset, one after the
+/// other: frame N uses the tiles that start at "source + N * count". The tiles
+/// of the current frame are copied over tiles "tile" to "tile + count - 1" of
+/// every layer that shows the BG, in both screens, by NF_UpdateTiledBgAnims().
+/// The maps don't change, so the cost only depends on the number of animated
+/// tiles.
+///
+/// The graphics are read from the tileset in RAM, so it must stay loaded while
+/// the animation exists. Unloading the BG deletes its animations. The BG must
+/// not have been deduplicated with NF_DedupTiledBg(), as the tiles are no longer
+/// in their original positions (error 121).
+///
+/// Example:
+/// ```
+/// // Animate tiles 0 to 15 of "water" with the 4 frames stored in tiles 16 to
+/// // 79, showing the first frame for 30 frames and the rest for 10 frames.
+/// static const u8 delays[] = { 30, 10, 10, 10 };
+/// u8 anim = NF_CreateTiledBgAnim("water", 0, 16, 16, 4, delays);
+/// ```
+///
+/// @param name Name of the BG.
+/// @param tile First animated tile.
+/// @param count Number of animated tiles.
+/// @param source First tile of the graphics of the first frame.
+/// @param frames Number of frames (1 - 32).
+/// @param delays Duration of each frame in calls to NF_UpdateTiledBgAnims().
+/// @return ID of the animation (0 - 31).
+u8 NF_CreateTiledBgAnim(const char *name, u16 tile, u16 count, u16 source,
+                        u8 frames, const u8 *delays);
+
+/// Deletes a group of animated tiles.
+///
+/// The tiles keep the graphics of the frame that was being shown.
+///
+/// Example:
+/// ```
+/// // Stop the animation with ID 3
+/// NF_DeleteTiledBgAnim(3);
+/// ```
+///
+/// @param id ID of the animation (0 - 31).
+void NF_DeleteTiledBgAnim(u8 id);
+
+/// Advances all animated tile groups and copies the frames that change.
+///
+/// Call it once per frame. The copies are done with NF_QueueVramCopy(), one per
+/// animation and screen, so they can be done in the VBlank period with the VRAM
+/// upload queue.
+///
+/// Example:
+/// ```
+/// swiWaitForVBlank();
+/// NF_UpdateTiledBgAnims();
+/// ```
+void NF_UpdateTiledBgAnims(void);
+
 /// @}
 
 #endif // NF_TILEDBG_H__
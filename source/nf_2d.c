@@ -9,6 +9,7 @@
 
 #include "nf_2d.h"
 #include "nf_basic.h"
+#include "nf_raster.h"
 #include "nf_sprite256.h"
 #include "nf_tiledbg.h"
 
@@ -166,116 +167,124 @@ void NF_ScrollBg(u8 screen, u8 layer, s16 x, s16 y)
         if (sy > (NF_TILEDBG_LAYERS[screen][layer].bgheight - 192))
             sy = NF_TILEDBG_LAYERS[screen][layer].bgheight - 192;
 
-        // Handle the different types of map
-        switch (NF_TILEDBG_LAYERS[screen][layer].bgtype)
+        // If the map is streamed, copy only the rows and columns that have
+        // become visible. The map in VRAM is a ring buffer, so the scroll
+        // registers can be used as they are.
+        if (NF_TILEDBG_LAYERS[screen][layer].streaming)
         {
-            // 512x256 - Block A and B (32x32) + (32x32) (2kb x 2 = 4kb)
-            case 1:
-                // Calculate block
-                blockx = x >> 8;
-
-                // If you have changed block...
-                if (NF_TILEDBG_LAYERS[screen][layer].blockx != blockx)
-                {
-                    // Calculate data offset
-                    mapmovex = blockx << 11;
-
-                    // Copy blocks A and B (32x32) + (32x32) (2kb x 2 = 4kb)
-                    NF_DmaMemCopy((void *)address,
-                        NF_BUFFER_BGMAP[NF_TILEDBG_LAYERS[screen][layer].bgslot] + mapmovex,
-                        4096);
-
-                    // Update the current block
-                    NF_TILEDBG_LAYERS[screen][layer].blockx = blockx;
-                }
-
-                // Calculate horizontal scroll
-                sx = x - (blockx << 8);
-                break;
-
-            // 256x512 - Block A (32x64) (2kb x 2 = 4kb)
-            case 2:
-                // Calculate block
-                blocky = y >> 8;
-
-                // If you have changed block...
-                if (NF_TILEDBG_LAYERS[screen][layer].blocky != blocky)
-                {
-                    // Calculate data offset
-                    mapmovey = blocky << 11;
-
-                    // Copy blocks A and B (32x32) + (32x32) (2kb x 2 = 4kb)
-                    NF_DmaMemCopy((void *)address,
-                        NF_BUFFER_BGMAP[NF_TILEDBG_LAYERS[screen][layer].bgslot] + mapmovey,
-                        4096);
-
-                    // Update the current block
-                    NF_TILEDBG_LAYERS[screen][layer].blocky = blocky;
-                }
-
-                // Calculate vertical scroll
-                sy = y - (blocky << 8);
-                break;
-
-            // >512 x >512
-            case 3:
-                rowsize = (((NF_TILEDBG_LAYERS[screen][layer].bgwidth - 1) >> 8) + 1) << 11;
-
-                // Calculate blocks
-                blockx = x >> 8;
-                blocky = y >> 8;
-
-                // If you have changed block in any direction...
-                if ((NF_TILEDBG_LAYERS[screen][layer].blockx != blockx)
-                 || (NF_TILEDBG_LAYERS[screen][layer].blocky != blocky))
-                {
-                    // Calculate data offset
-                    mapmovex = (blocky * rowsize) + (blockx << 11);
-                    mapmovey = mapmovex + rowsize;
-
-                    // Blocks A and B (32x32) + (32x32) (2kb x 2 = 4kb)
-                    NF_DmaMemCopy((void *)address,
-                        NF_BUFFER_BGMAP[NF_TILEDBG_LAYERS[screen][layer].bgslot] + mapmovex,
-                        4096);
-
-                    // Blocks (+4096) C and D (32x32) + (32x32) (2kb x 2 = 4kb)
-                    NF_DmaMemCopy((void *)(address + 4096),
-                        NF_BUFFER_BGMAP[NF_TILEDBG_LAYERS[screen][layer].bgslot] + mapmovey,
-                        4096);
-
-                    // Update the current block
-                    NF_TILEDBG_LAYERS[screen][layer].blockx = blockx;
-                    NF_TILEDBG_LAYERS[screen][layer].blocky = blocky;
-                }
-
-                // Calculate horizontal and vertical scrolls
-                sx = x - (blockx << 8);
-                sy = y - (blocky << 8);
-                break;
+            NF_StreamTiledBg(screen, layer, sx, sy);
+        }
+        else
+        {
+            // Handle the different types of map
+            switch (NF_TILEDBG_LAYERS[screen][layer].bgtype)
+            {
+                // 512x256 - Block A and B (32x32) + (32x32) (2kb x 2 = 4kb)
+                case 1:
+                    // Calculate block
+                    blockx = x >> 8;
+
+                    // If you have changed block...
+                    if (NF_TILEDBG_LAYERS[screen][layer].blockx != blockx)
+                    {
+                        // Calculate data offset
+                        mapmovex = blockx << 11;
+
+                        // Copy blocks A and B (32x32) + (32x32) (2kb x 2 = 4kb)
+                        NF_CopyTiledBgMapBlocks(screen, layer, (void *)address, mapmovex, 4096);
+
+                        // Update the current block
+                        NF_TILEDBG_LAYERS[screen][layer].blockx = blockx;
+                    }
+
+                    // Calculate horizontal scroll
+                    sx = x - (blockx << 8);
+                    break;
+
+                // 256x512 - Block A (32x64) (2kb x 2 = 4kb)
+                case 2:
+                    // Calculate block
+                    blocky = y >> 8;
+
+                    // If you have changed block...
+                    if (NF_TILEDBG_LAYERS[screen][layer].blocky != blocky)
+                    {
+                        // Calculate data offset
+                        mapmovey = blocky << 11;
+
+                        // Copy blocks A and B (32x32) + (32x32) (2kb x 2 = 4kb)
+                        NF_CopyTiledBgMapBlocks(screen, layer, (void *)address, mapmovey, 4096);
+
+                        // Update the current block
+                        NF_TILEDBG_LAYERS[screen][layer].blocky = blocky;
+                    }
+
+                    // Calculate vertical scroll
+                    sy = y - (blocky << 8);
+                    break;
+
+                // >512 x >512
+                case 3:
+                    rowsize = (((NF_TILEDBG_LAYERS[screen][layer].bgwidth - 1) >> 8) + 1) << 11;
+
+                    // Calculate blocks
+                    blockx = x >> 8;
+                    blocky = y >> 8;
+
+                    // If you have changed block in any direction...
+                    if ((NF_TILEDBG_LAYERS[screen][layer].blockx != blockx)
+                     || (NF_TILEDBG_LAYERS[screen][layer].blocky != blocky))
+                    {
+                        // Calculate data offset
+                        mapmovex = (blocky * rowsize) + (blockx << 11);
+                        mapmovey = mapmovex + rowsize;
+
+                        // Blocks A and B (32x32) + (32x32) (2kb x 2 = 4kb)
+                        NF_CopyTiledBgMapBlocks(screen, layer, (void *)address, mapmovex, 4096);
+
+                        // Blocks (+4096) C and D (32x32) + (32x32) (2kb x 2 = 4kb)
+                        NF_CopyTiledBgMapBlocks(screen, layer, (void *)(address + 4096), mapmovey, 4096);
+
+                        // Update the current block
+                        NF_TILEDBG_LAYERS[screen][layer].blockx = blockx;
+                        NF_TILEDBG_LAYERS[screen][layer].blocky = blocky;
+                    }
+
+                    // Calculate horizontal and vertical scrolls
+                    sx = x - (blockx << 8);
+                    sy = y - (blocky << 8);
+                    break;
+            }
         }
     }
 
-    // Set the scroll in the hardware registers
+    // If a raster effect uses the scroll of this layer, it is used as the base
+    // of the effect instead of being written to the registers.
+    if (NF_RasterScrollBg(screen, layer, sx, sy))
+        return;
+
+    // Set the scroll in the hardware registers. If the VRAM queue is enabled
+    // they are updated in the same VBlank as the map.
     if (screen == 0)
     {
         // Top screen
         switch (layer)
         {
             case 0:
-                REG_BG0HOFS = sx;
-                REG_BG0VOFS = sy;
+                NF_QueueRegWrite16(&REG_BG0HOFS, sx);
+                NF_QueueRegWrite16(&REG_BG0VOFS, sy);
                 break;
             case 1:
-                REG_BG1HOFS = sx;
-                REG_BG1VOFS = sy;
+                NF_QueueRegWrite16(&REG_BG1HOFS, sx);
+                NF_QueueRegWrite16(&REG_BG1VOFS, sy);
                 break;
             case 2:
-                REG_BG2HOFS = sx;
-                REG_BG2VOFS = sy;
+                NF_QueueRegWrite16(&REG_BG2HOFS, sx);
+                NF_QueueRegWrite16(&REG_BG2VOFS, sy);
                 break;
             case 3:
-                REG_BG3HOFS = sx;
-                REG_BG3VOFS = sy;
+                NF_QueueRegWrite16(&REG_BG3HOFS, sx);
+                NF_QueueRegWrite16(&REG_BG3VOFS, sy);
                 break;
         }
     }
@@ -285,20 +294,20 @@ void NF_ScrollBg(u8 screen, u8 layer, s16 x, s16 y)
         switch (layer)
         {
             case 0:
-                REG_BG0HOFS_SUB = sx;
-                REG_BG0VOFS_SUB = sy;
+                NF_QueueRegWrite16(&REG_BG0HOFS_SUB, sx);
+                NF_QueueRegWrite16(&REG_BG0VOFS_SUB, sy);
                 break;
             case 1:
-                REG_BG1HOFS_SUB = sx;
-                REG_BG1VOFS_SUB = sy;
+                NF_QueueRegWrite16(&REG_BG1HOFS_SUB, sx);
+                NF_QueueRegWrite16(&REG_BG1VOFS_SUB, sy);
                 break;
             case 2:
-                REG_BG2HOFS_SUB = sx;
-                REG_BG2VOFS_SUB = sy;
+                NF_QueueRegWrite16(&REG_BG2HOFS_SUB, sx);
+                NF_QueueRegWrite16(&REG_BG2VOFS_SUB, sy);
                 break;
             case 3:
-                REG_BG3HOFS_SUB = sx;
-                REG_BG3VOFS_SUB = sy;
+                NF_QueueRegWrite16(&REG_BG3HOFS_SUB, sx);
+                NF_QueueRegWrite16(&REG_BG3VOFS_SUB, sy);
                 break;
         }
     }
@@ -332,7 +341,7 @@ void NF_SpriteFrame(u8 screen, u8 id, u16 frame)
             source = NF_BUFFER_SPR256GFX[ramid] + (NF_SPRITEOAM[screen][id].framesize * frame);
             destination = NF_SPR256VRAM[screen][NF_SPRITEOAM[screen][id].gfxid].address;
 
-            NF_DmaMemCopy((void *)destination, source, NF_SPRITEOAM[screen][id].framesize);
+            NF_QueueVramCopy((void *)destination, source, NF_SPRITEOAM[screen][id].framesize);
         }
         else
         {
@@ -14,11 +14,16 @@
 #include "nf_2d.h"
 #include "nf_affinebg.h"
 #include "nf_basic.h"
+#include "nf_raster.h"
 #include "nf_tiledbg.h"
 
 // Estructura para almacenar los parametros de los fondos Affine
 NF_TYPE_AFFINE_BG NF_AFFINE_BG[2][4];
 
+// Tabla de inversos (1 / n en formato 16.16) para la perspectiva
+static u32 NF_PERSPECTIVE_RECIPROCAL[NF_RASTER_LINES];
+static bool NF_PERSPECTIVE_READY = false;
+
 void NF_InitAffineBgSys(u8 screen) {
 
 	u8 n = 0;
@@ -88,6 +93,8 @@ void NF_LoadAffineBg(const char* file, const char* name, u16 width, u16 height)
 	// Verifica si el fondo cumple las medidas correctas
 	if (((width == 256) && (height == 256)) || ((width == 512) && (height == 512))) {
 		// Medida Ok
+	} else if ((width >= 256) && (height >= 256) && ((width % 256) == 0) && ((height % 256) == 0)) {
+		// Medida Ok, fondo con streaming
 	} else {
 		// Error de tamaño
 		NF_Error(117, name, 0);
@@ -97,19 +104,7 @@ void NF_LoadAffineBg(const char* file, const char* name, u16 width, u16 height)
 	u32 pal_size = 0;
 
 	// Busca un slot libre
-	u8 n = 0;
-	u8 slot = 255;
-	for (n = 0; n < NF_SLOTS_TBG; n ++) {		// Busca en todos los slots
-		if (NF_TILEDBG[n].available) {			// Si esta libre
-			NF_TILEDBG[n].available = false;	// Marcalo como en uso
-			slot = n;							// Guarda el slot a usar
-			n = NF_SLOTS_TBG;					// Deja de buscar
-		}
-	}
-	// Si no hay ningun slot libre, error
-	if (slot == 255) {
-		NF_Error(103, "Tiled Bg", NF_SLOTS_TBG);
-	}
+	u8 slot = NF_AllocTiledBgSlot();
 
 	// Vacia los buffers que se usaran
 	free(NF_BUFFER_BGMAP[slot]);		// Buffer para los mapas
@@ -119,32 +114,12 @@ void NF_LoadAffineBg(const char* file, const char* name, u16 width, u16 height)
 	free(NF_BUFFER_BGPAL[slot]);		// Buffer para los paletas
 	NF_BUFFER_BGPAL[slot] = NULL;
 
-	// Declara los punteros a los ficheros
-	FILE* file_id;
-
 	// Variable para almacenar el path al archivo
 	char filename[256];
 
-	// Carga el archivo .IMG
+	// Carga el archivo .IMG (si esta comprimido, se descomprime)
 	snprintf(filename, sizeof(filename), "%s/%s.img", NF_ROOTFOLDER, file);
-	file_id = fopen(filename, "rb");
-	if (file_id) {	// Si el archivo existe...
-		// Obten el tamaño del archivo
-		fseek(file_id, 0, SEEK_END);
-		NF_TILEDBG[slot].tilesize = ftell(file_id);
-		rewind(file_id);
-		// Reserva el espacio en RAM
-		NF_BUFFER_BGTILES[slot] = (char*) calloc (NF_TILEDBG[slot].tilesize, sizeof(char));
-		if (NF_BUFFER_BGTILES[slot] == NULL) {		// Si no hay suficiente RAM libre
-			NF_Error(102, NULL, NF_TILEDBG[slot].tilesize);
-		}
-		// Lee el archivo y ponlo en la RAM
-		fread(NF_BUFFER_BGTILES[slot], 1, NF_TILEDBG[slot].tilesize, file_id);
-	} else {	// Si el archivo no existe...
-		NF_Error(101, filename, 0);
-	}
-	fclose(file_id);		// Cierra el archivo
-	// swiWaitForVBlank();		// Espera al cierre del archivo (Usar en caso de corrupcion de datos)
+	NF_FileLoad(filename, &NF_BUFFER_BGTILES[slot], &NF_TILEDBG[slot].tilesize, 0);
 
 	// Verifica el tamaño del tileset (Menos de 256 tiles)
 	if (NF_TILEDBG[slot].tilesize > 16384) NF_Error(117, name, 0);
@@ -152,50 +127,28 @@ void NF_LoadAffineBg(const char* file, const char* name, u16 width, u16 height)
 
 	// Carga el archivo .MAP
 	snprintf(filename, sizeof(filename), "%s/%s.map", NF_ROOTFOLDER, file);
-	file_id = fopen(filename, "rb");
-	if (file_id) {	// Si el archivo existe...
-		// Obten el tamaño del archivo
-		fseek(file_id, 0, SEEK_END);
-		NF_TILEDBG[slot].mapsize = ((((ftell(file_id) - 1) >> 10) + 1) << 10);	// Ajusta el tamaño a bloques de 1kb
-		rewind(file_id);
-		// Reserva el espacio en RAM
-		NF_BUFFER_BGMAP[slot] = (char*) calloc (NF_TILEDBG[slot].mapsize, sizeof(char));
-		if (NF_BUFFER_BGMAP[slot] == NULL) {		// Si no hay suficiente RAM libre
-			NF_Error(102, NULL, NF_TILEDBG[slot].mapsize);
+	NF_FileLoad(filename, &NF_BUFFER_BGMAP[slot], &NF_TILEDBG[slot].mapsize, 0);
+	// Ajusta el tamaño a bloques de 1kb
+	u32 map_size = ((((NF_TILEDBG[slot].mapsize - 1) >> 10) + 1) << 10);
+	if (map_size != NF_TILEDBG[slot].mapsize) {
+		char* buffer = realloc(NF_BUFFER_BGMAP[slot], map_size);
+		if (buffer == NULL) {		// Si no hay suficiente RAM libre
+			NF_Error(102, NULL, map_size);
 		}
-		// Lee el archivo y ponlo en la RAM
-		fread(NF_BUFFER_BGMAP[slot], 1, NF_TILEDBG[slot].mapsize, file_id);
-	} else {	// Si el archivo no existe...
-		NF_Error(101, filename, 0);
+		memset(buffer + NF_TILEDBG[slot].mapsize, 0, (map_size - NF_TILEDBG[slot].mapsize));
+		NF_BUFFER_BGMAP[slot] = buffer;
+		NF_TILEDBG[slot].mapsize = map_size;
 	}
-	fclose(file_id);		// Cierra el archivo
-	// swiWaitForVBlank();		// Espera al cierre del archivo (Usar en caso de corrupcion de datos)
 
-	// Carga el archivo .PAL
+	// Carga el archivo .PAL (como minimo de 512 bytes)
 	snprintf(filename, sizeof(filename), "%s/%s.pal", NF_ROOTFOLDER, file);
-	file_id = fopen(filename, "rb");
-	if (file_id) {	// Si el archivo existe...
-		// Obten el tamaño del archivo
-		fseek(file_id, 0, SEEK_END);
-		pal_size = ftell(file_id);
-		NF_TILEDBG[slot].palsize = pal_size;
-		rewind(file_id);
-		// Si el tamaño es inferior a 512 bytes, ajustalo
-		if (NF_TILEDBG[slot].palsize < 512) NF_TILEDBG[slot].palsize = 512;
-		// Reserva el espacio en RAM
-		NF_BUFFER_BGPAL[slot] = (char*) calloc (NF_TILEDBG[slot].palsize, sizeof(char));
-		if (NF_BUFFER_BGPAL[slot] == NULL) {		// Si no hay suficiente RAM libre
-			NF_Error(102, NULL, NF_TILEDBG[slot].palsize);
-		}
-		// Lee el archivo y ponlo en la RAM
-		fread(NF_BUFFER_BGPAL[slot], 1, pal_size, file_id);
-	} else {	// Si el archivo no existe...
-		NF_Error(101, filename, 0);
-	}
-	fclose(file_id);		// Cierra el archivo
+	NF_FileLoad(filename, &NF_BUFFER_BGPAL[slot], &pal_size, 512);
+	NF_TILEDBG[slot].palsize = pal_size;
+	// Si el tamaño es inferior a 512 bytes, ajustalo
+	if (NF_TILEDBG[slot].palsize < 512) NF_TILEDBG[slot].palsize = 512;
 
 	// Guarda el nombre del Fondo
-	snprintf(NF_TILEDBG[slot].name, sizeof(NF_TILEDBG[slot].name), "%s", name);
+	NF_SetTiledBgName(slot, name);
 
 	// Y las medidas
 	NF_TILEDBG[slot].width = width;
@@ -207,24 +160,12 @@ void NF_CreateAffineBg(u8 screen, u8 layer, const char* name, u8 wrap) {
 
 	// Variables
 	u8 n = 0;			// Bucle
-	u8 slot = 255;		// Slot seleccionado
-	char bg[32];		// Nombre
 
 	// Verifica la capa de destino
 	if ((layer != 2) && (layer != 3)) NF_Error(118, name, 0);
 
 	// Busca el fondo solicitado
-	snprintf(bg, sizeof(bg), "%s", name);				// Obten el nombre del fondo a buscar
-	for (n = 0; n < NF_SLOTS_TBG; n ++) {				// Busca en todos los slots
-		if (strcmp(bg, NF_TILEDBG[n].name) == 0) {		// Si lo encuentras
-			slot = n;									// Guarda el slot a usar
-			n = NF_SLOTS_TBG;							// Deja de buscar
-		}
-	}
-	// Si no se encuentra, error
-	if (slot == 255) {
-		NF_Error(104, name, 0);
-	}
+	u8 slot = NF_GetTiledBgSlot(name);
 
 	// Si ya hay un fondo existente en esta pantalla y capa, borralo antes
 	if (NF_TILEDBG_LAYERS[screen][layer].created) {
@@ -262,6 +203,20 @@ void NF_CreateAffineBg(u8 screen, u8 layer, const char* name, u8 wrap) {
 		n = 1;
 	}
 
+	// ( Otras medidas: streaming en un mapa de 512 x 512 )
+	NF_AFFINE_BG[screen][layer].streaming = false;
+	if (n == 0) {
+		NF_TILEDBG_LAYERS[screen][layer].mapwidth = 512;
+		NF_TILEDBG_LAYERS[screen][layer].mapheight = 512;
+		NF_TILEDBG_LAYERS[screen][layer].bgtype = 13;
+		NF_AFFINE_BG[screen][layer].streaming = true;
+		NF_AFFINE_BG[screen][layer].wrap = (wrap != 0);
+		// Ventana fuera del mapa, para que se copie entera la primera vez
+		NF_AFFINE_BG[screen][layer].stream_x = -0x10000;
+		NF_AFFINE_BG[screen][layer].stream_y = -0x10000;
+		n = 1;
+	}
+
 	// Verifica el tamaño del tileset (Menos de 256 tiles)
 	if (NF_TILEDBG[slot].tilesize > 16384) n = 0;
 
@@ -305,7 +260,11 @@ void NF_CreateAffineBg(u8 screen, u8 layer, const char* name, u8 wrap) {
 	start = 255;
 
 	// Calcula los bloques para mapas necesarios
-	mapblocks = ((NF_TILEDBG[slot].mapsize - 1) >> 11) + 1;
+	if (NF_AFFINE_BG[screen][layer].streaming) {
+		mapblocks = ((NF_AFFINE_STREAM_WINDOW * NF_AFFINE_STREAM_WINDOW) >> 11);
+	} else {
+		mapblocks = ((NF_TILEDBG[slot].mapsize - 1) >> 11) + 1;
+	}
 
 	for (n = 0; n < NF_BANKS_MAPS[screen]; n ++) {
 		if (NF_MAPBLOCKS[screen][n] == 0) {			// Si esta libre
@@ -346,9 +305,9 @@ void NF_CreateAffineBg(u8 screen, u8 layer, const char* name, u8 wrap) {
 		bg_size = BG_RS_64x64;
 	}
 
-	// Decide si se activa o no el WRAP
+	// Decide si se activa o no el WRAP (con streaming, el mapa de VRAM es circular)
 	u32 wrap_mode = 0;
-	if (wrap == 0) {
+	if ((wrap == 0) && !NF_AFFINE_BG[screen][layer].streaming) {
 		wrap_mode = BG_WRAP_OFF;
 	} else {
 		wrap_mode = BG_WRAP_ON;
@@ -394,7 +353,10 @@ void NF_CreateAffineBg(u8 screen, u8 layer, const char* name, u8 wrap) {
 	} else {			// (VRAM_C)
 		address = (0x6200000) + (basemap << 11);
 	}
-	NF_DmaMemCopy((void*)address, NF_BUFFER_BGMAP[slot], NF_TILEDBG[slot].mapsize);
+	if (!NF_AFFINE_BG[screen][layer].streaming) {
+		NF_DmaMemCopy((void*)address, NF_BUFFER_BGMAP[slot], NF_TILEDBG[slot].mapsize);
+	}
+	// (con streaming, NF_AffineBgTransform() copia la ventana visible)
 
 
 	// Tranfiere la Paleta a VRAM
@@ -413,8 +375,12 @@ void NF_CreateAffineBg(u8 screen, u8 layer, const char* name, u8 wrap) {
 	NF_TILEDBG_LAYERS[screen][layer].mapblocks = mapblocks;				// Bloques usados por el Map
 	NF_TILEDBG_LAYERS[screen][layer].created = true;					// Esta creado ?
 
-	// Resetea los parametros del affine
-	NF_AffineBgTransform(screen, layer, 256, 256, 0, 0);
+	// Resetea los parametros del affine. NF_AffineBgMove() los aplica, y con
+	// streaming copia la ventana visible entera una sola vez.
+	NF_AFFINE_BG[screen][layer].x_scale = 256;
+	NF_AFFINE_BG[screen][layer].x_tilt = 0;
+	NF_AFFINE_BG[screen][layer].y_tilt = 0;
+	NF_AFFINE_BG[screen][layer].y_scale = 256;
 	NF_AffineBgMove(screen, layer, 0, 0, 0);
 
 	// Haz visible el fondo creado
@@ -488,6 +454,98 @@ void NF_DeleteAffineBg(u8 screen, u8 layer) {
 	NF_TILEDBG_LAYERS[screen][layer].blockx = 0;		// Bloque de mapa actual (horizontal)
 	NF_TILEDBG_LAYERS[screen][layer].blocky = 0;		// Bloque de mapa actual (vertical)
 	NF_TILEDBG_LAYERS[screen][layer].created = false;	// Esta creado ?
+	NF_AFFINE_BG[screen][layer].streaming = false;		// Sin streaming
+
+}
+
+// Tile del mapa en RAM de un fondo affine con streaming (fuera del mapa, se
+// repite el mapa si el fondo es infinito, o se usa el tile 0 si no)
+static u8 NF_AffineBgStreamTile(u8 screen, u8 layer, s32 tile_x, s32 tile_y) {
+
+	u8 slot = NF_TILEDBG_LAYERS[screen][layer].bgslot;
+	s32 size_x = (NF_TILEDBG_LAYERS[screen][layer].bgwidth >> 3);
+	s32 size_y = (NF_TILEDBG_LAYERS[screen][layer].bgheight >> 3);
+
+	if ((tile_x < 0) || (tile_x >= size_x) || (tile_y < 0) || (tile_y >= size_y)) {
+		if (!NF_AFFINE_BG[screen][layer].wrap) return 0;
+		tile_x %= size_x;
+		if (tile_x < 0) tile_x += size_x;
+		tile_y %= size_y;
+		if (tile_y < 0) tile_y += size_y;
+	}
+
+	return NF_BUFFER_BGMAP[slot][(tile_y * size_x) + tile_x];
+
+}
+
+// Copia un area del mapa en RAM a su posicion en el mapa circular de VRAM. La
+// VRAM solo admite escrituras de 16 bits, asi que tile_x y width son pares.
+static void NF_AffineBgStreamArea(u8 screen, u8 layer, s32 tile_x, s32 tile_y, u32 width, u32 height) {
+
+	u32 address;
+	if (screen == 0) {	// (VRAM_A)
+		address = (0x6000000) + (NF_TILEDBG_LAYERS[screen][layer].mapbase << 11);
+	} else {			// (VRAM_C)
+		address = (0x6200000) + (NF_TILEDBG_LAYERS[screen][layer].mapbase << 11);
+	}
+	u16* vram = (u16*)address;
+	u32 mask = (NF_AFFINE_STREAM_WINDOW - 1);
+
+	for (u32 y = 0; y < height; y ++) {
+		s32 ty = (tile_y + y);
+		u16* row = vram + ((ty & mask) * (NF_AFFINE_STREAM_WINDOW >> 1));
+		for (u32 x = 0; x < width; x += 2) {
+			s32 tx = (tile_x + x);
+			u8 lobyte = NF_AffineBgStreamTile(screen, layer, tx, ty);
+			u8 hibyte = NF_AffineBgStreamTile(screen, layer, (tx + 1), ty);
+			row[(tx & mask) >> 1] = ((hibyte << 8) | lobyte);
+		}
+	}
+
+}
+
+// Mueve la ventana de un fondo con streaming para que cubra el area visible,
+// copiando solo las filas y columnas nuevas
+static void NF_AffineBgStreamView(u8 screen, u8 layer, s32 pa, s32 pb, s32 pc, s32 pd, s32 pos_x, s32 pos_y) {
+
+	// Calcula el rectangulo del mapa que se ve en las esquinas de la pantalla
+	s32 min_x = pos_x, max_x = pos_x;
+	s32 min_y = pos_y, max_y = pos_y;
+	for (u32 n = 1; n < 4; n ++) {
+		s32 sx = (n & 1) ? 256 : 0;
+		s32 sy = (n & 2) ? 192 : 0;
+		s32 tx = (pos_x + (pa * sx) + (pb * sy));
+		s32 ty = (pos_y + (pc * sx) + (pd * sy));
+		if (tx < min_x) min_x = tx;
+		if (tx > max_x) max_x = tx;
+		if (ty < min_y) min_y = ty;
+		if (ty > max_y) max_y = ty;
+	}
+
+	// Centra la ventana en ese rectangulo (en tiles, con el origen X par)
+	s32 half = (NF_AFFINE_STREAM_WINDOW >> 1);
+	s32 new_x = ((((min_x + max_x) >> 1) >> 11) - half) & ~1;
+	s32 new_y = ((((min_y + max_y) >> 1) >> 11) - half);
+	s32 old_x = NF_AFFINE_BG[screen][layer].stream_x;
+	s32 old_y = NF_AFFINE_BG[screen][layer].stream_y;
+	s32 dx = (new_x - old_x);
+	s32 dy = (new_y - old_y);
+	s32 window = NF_AFFINE_STREAM_WINDOW;
+
+	if ((dx <= -window) || (dx >= window) || (dy <= -window) || (dy >= window)) {
+		// Si se ha movido demasiado, copia la ventana entera
+		NF_AffineBgStreamArea(screen, layer, new_x, new_y, window, window);
+	} else {
+		// Columnas nuevas
+		if (dx > 0) NF_AffineBgStreamArea(screen, layer, (old_x + window), new_y, dx, window);
+		if (dx < 0) NF_AffineBgStreamArea(screen, layer, new_x, new_y, -dx, window);
+		// Filas nuevas
+		if (dy > 0) NF_AffineBgStreamArea(screen, layer, new_x, (old_y + window), window, dy);
+		if (dy < 0) NF_AffineBgStreamArea(screen, layer, new_x, new_y, window, -dy);
+	}
+
+	NF_AFFINE_BG[screen][layer].stream_x = new_x;
+	NF_AFFINE_BG[screen][layer].stream_y = new_y;
 
 }
 
@@ -531,6 +589,11 @@ void NF_AffineBgTransform(u8 screen, u8 layer, s32 x_scale, s32 y_scale, s32 x_t
 	NF_AFFINE_BG[screen][layer].y_tilt = y_tilt;
 	NF_AFFINE_BG[screen][layer].y_scale = y_scale;
 
+	// Si el mapa no cabe en VRAM, actualiza la ventana visible
+	if (NF_AFFINE_BG[screen][layer].streaming) {
+		NF_AffineBgStreamView(screen, layer, x_scale, x_tilt, y_tilt, y_scale, NF_AFFINE_BG[screen][layer].pos_x, NF_AFFINE_BG[screen][layer].pos_y);
+	}
+
 }
 
 void NF_AffineBgMove(u8 screen, u8 layer, s32 x, s32 y, s32 angle) {
@@ -580,12 +643,11 @@ void NF_AffineBgMove(u8 screen, u8 layer, s32 x, s32 y, s32 angle) {
 	pc = ( angle_sin * NF_AFFINE_BG[screen][layer].y_scale ) >> 12;
 	pd = ( angle_cos * NF_AFFINE_BG[screen][layer].y_scale ) >> 12;
 
-	// Aplica los parametros de tranformacion
-	NF_AffineBgTransform(screen, layer, pa, pd, pb, pc);
-
 	// Ahora calcula la posicion del fondo
     pos_x = ((x << 8) - (((pa * (NF_AFFINE_BG[screen][layer].x_center << 8)) + (pb * (NF_AFFINE_BG[screen][layer].y_center << 8))) >> 8));
 	pos_y = ((y << 8) - (((pc * (NF_AFFINE_BG[screen][layer].x_center << 8)) + (pd * (NF_AFFINE_BG[screen][layer].y_center << 8))) >> 8));
+	NF_AFFINE_BG[screen][layer].pos_x = pos_x;
+	NF_AFFINE_BG[screen][layer].pos_y = pos_y;
 
 	// Aplica la posicion del centro
 	if (screen == 0) {
@@ -612,9 +674,70 @@ void NF_AffineBgMove(u8 screen, u8 layer, s32 x, s32 y, s32 angle) {
 		}
 	}
 
+	// Aplica los parametros de tranformacion (y actualiza la ventana visible
+	// si el mapa no cabe en VRAM)
+	NF_AffineBgTransform(screen, layer, pa, pd, pb, pc);
+
 	// Guarda los parametros
 	NF_AFFINE_BG[screen][layer].angle = out;
 	NF_AFFINE_BG[screen][layer].x = x;
 	NF_AFFINE_BG[screen][layer].y = y;
 
 }
+
+void NF_AffineBgPerspective(u8 screen, u8 layer, s32 x, s32 y, s32 height, s32 angle, u8 horizon, s32 fov) {
+
+	// Verifica los parametros
+	if ((layer < 2) || (layer > 3)) NF_Error(106, "Affine layer", 3);
+	if ((height < 1) || (height > 32767)) NF_Error(106, "Camera height", 32767);
+	if (horizon >= NF_RASTER_LINES) NF_Error(106, "Horizon", (NF_RASTER_LINES - 1));
+	if ((fov < 1) || (fov > 1023)) NF_Error(106, "Field of view", 1023);
+
+	// Calcula la tabla de inversos la primera vez
+	if (!NF_PERSPECTIVE_READY) {
+		NF_PERSPECTIVE_RECIPROCAL[0] = 0;
+		for (u32 n = 1; n < NF_RASTER_LINES; n ++) {
+			NF_PERSPECTIVE_RECIPROCAL[n] = ((1 << 16) / n);
+		}
+		NF_PERSPECTIVE_READY = true;
+	}
+
+	// Usa el sistema de efectos por linea en esta capa
+	if (!NF_RasterUses(screen, NF_RASTER_AFFINE, layer)) {
+		NF_RasterStart(screen, NF_RASTER_AFFINE, layer);
+	}
+
+	// Direccion de la camara (mismo sentido que NF_AffineBgMove())
+	s16 out = -(angle << 4);
+	s32 angle_sin = sinLerp(out);
+	s32 angle_cos = cosLerp(out);
+
+	// Distancia focal: media pantalla / tan(fov / 2)
+	s32 fov_sin = sinLerp(fov << 3);
+	s32 fov_cos = cosLerp(fov << 3);
+	s32 focal = ((128 * fov_cos) / fov_sin);
+
+	// Por encima del horizonte se muestra el pixel (0, 0)
+	for (u32 line = 0; line <= horizon; line ++) {
+		NF_RasterSetAffine(line, 0, 0, 0, 0, 0, 0);
+	}
+
+	// Debajo del horizonte, cada linea esta a una distancia proporcional a
+	// 1 / (linea - horizonte). lambda es el tamaño de un pixel de la pantalla en
+	// el suelo (formato 20.12).
+	for (u32 line = (horizon + 1); line < NF_RASTER_LINES; line ++) {
+		s32 lambda = ((height * NF_PERSPECTIVE_RECIPROCAL[line - horizon]) >> 4);
+		s64 lcf = ((s64)lambda * angle_cos);		// Formato .24
+		s64 lsf = ((s64)lambda * angle_sin);
+		s32 pa = (lcf >> 16);
+		s32 pc = (lsf >> 16);
+		// Punto del suelo visto en el pixel 0 de la linea (formato .8)
+		s32 pos_x = ((x << 8) - (pa << 7) + (s32)((focal * lsf) >> 16));
+		s32 pos_y = ((y << 8) - (pc << 7) - (s32)((focal * lcf) >> 16));
+		NF_RasterSetAffine(line, pa, 0, pc, 0, pos_x, pos_y);
+	}
+
+	// Usa la tabla nueva a partir del siguiente frame
+	NF_RasterSwap();
+
+}
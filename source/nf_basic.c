@@ -10,10 +10,13 @@
 #endif
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include <nds.h>
 
 #include "nf_basic.h"
+#include "nf_compress.h"
 
 // Folder used as root by NFLib
 char NF_ROOTFOLDER[64];
@@ -118,11 +121,12 @@ __attribute__((noreturn)) void NF_Error(u16 code, const char *text, unsigned int
             iprintf("file is %u KB.\n", value >> 10);
             break;
 
-        case 117: // Invalid affine background size (only 256x256 and 512x512 allowed)
+        case 117: // Invalid affine background size (256x256, 512x512 or streamed)
             iprintf("Affine BG %s\n", text);
             iprintf("has wrong size.\n");
             iprintf("Your bg sizes must be\n");
-            iprintf("256x256 or 512x512 and\n");
+            iprintf("256x256, 512x512 or\n");
+            iprintf("multiples of 256, and\n");
             iprintf("with 256 tiles or less.\n");
             break;
 
@@ -143,6 +147,13 @@ __attribute__((noreturn)) void NF_Error(u16 code, const char *text, unsigned int
             iprintf("8x8 Sprites can't be used\n");
             iprintf("in 1D_128 mode.\n");
             break;
+
+        case 121: // Deduplicated background with animated tiles
+            iprintf("Tiled Bg %s\n", text);
+            iprintf("can't be deduplicated\n");
+            iprintf("and have animated\n");
+            iprintf("tiles at the same time.\n");
+            break;
     }
 
     // Print error code
@@ -284,6 +295,235 @@ void NF_SetRootFolder(const char *folder)
     }
 }
 
+// Asset pack opened with NF_OpenAssetPack()
+static FILE *NF_ASSETPACK_FILE = NULL;
+static NF_TYPE_ASSETPACK_ENTRY *NF_ASSETPACK_INDEX = NULL;
+static u32 NF_ASSETPACK_COUNT = 0;
+static u32 NF_ASSETPACK_POS = 0; // Current position of the pack file handle
+
+void NF_OpenAssetPack(const char *file)
+{
+    NF_CloseAssetPack();
+
+    char filename[256];
+    snprintf(filename, sizeof(filename), "%s/%s", NF_ROOTFOLDER, file);
+
+    FILE *file_id = fopen(filename, "rb");
+    if (file_id == NULL) // If the file doesn't exist
+        NF_Error(101, filename, 0);
+
+    // Read and check the header
+    u32 header[4];
+    if ((fread(header, 1, sizeof(header), file_id) != sizeof(header))
+        || (memcmp(header, NF_ASSETPACK_MAGIC, 4) != 0)
+        || (header[1] != NF_ASSETPACK_VERSION))
+    {
+        NF_Error(101, filename, 0);
+    }
+
+    // Load the index to RAM
+    u32 count = header[2];
+    NF_ASSETPACK_INDEX = calloc(count, sizeof(NF_TYPE_ASSETPACK_ENTRY));
+    if ((NF_ASSETPACK_INDEX == NULL) && (count > 0)) // Not enough memory
+        NF_Error(102, NULL, count * sizeof(NF_TYPE_ASSETPACK_ENTRY));
+    fread(NF_ASSETPACK_INDEX, sizeof(NF_TYPE_ASSETPACK_ENTRY), count, file_id);
+
+    NF_ASSETPACK_FILE = file_id;
+    NF_ASSETPACK_COUNT = count;
+    NF_ASSETPACK_POS = ftell(file_id);
+}
+
+void NF_CloseAssetPack(void)
+{
+    if (NF_ASSETPACK_FILE != NULL)
+        fclose(NF_ASSETPACK_FILE);
+
+    free(NF_ASSETPACK_INDEX);
+
+    NF_ASSETPACK_FILE = NULL;
+    NF_ASSETPACK_INDEX = NULL;
+    NF_ASSETPACK_COUNT = 0;
+}
+
+// Looks for a file in the asset pack. Returns NULL if it isn't there.
+static const NF_TYPE_ASSETPACK_ENTRY *NF_AssetPackFind(const char *path)
+{
+    if (NF_ASSETPACK_FILE == NULL)
+        return NULL;
+
+    // Names in the pack are relative to the root folder
+    size_t root_len = strlen(NF_ROOTFOLDER);
+    if (strncmp(path, NF_ROOTFOLDER, root_len) == 0)
+        path += root_len;
+    while (*path == '/')
+        path++;
+
+    // Binary search in the sorted index
+    u32 low = 0;
+    u32 high = NF_ASSETPACK_COUNT;
+    while (low < high)
+    {
+        u32 mid = (low + high) / 2;
+        int cmp = strncmp(path, NF_ASSETPACK_INDEX[mid].name, NF_ASSETPACK_NAME_LENGTH);
+        if (cmp == 0)
+            return &NF_ASSETPACK_INDEX[mid];
+        if (cmp < 0)
+            high = mid;
+        else
+            low = mid + 1;
+    }
+
+    return NULL;
+}
+
+bool NF_FileOpen(NF_TYPE_FILE *file, const char *path)
+{
+    const NF_TYPE_ASSETPACK_ENTRY *entry = NF_AssetPackFind(path);
+    if (entry != NULL)
+    {
+        file->file = NF_ASSETPACK_FILE;
+        file->start = entry->offset;
+        file->size = entry->size;
+        file->flags = entry->flags;
+        file->packed = true;
+    }
+    else
+    {
+        file->file = fopen(path, "rb");
+        if (file->file == NULL)
+            return false;
+
+        // Get file size
+        fseek(file->file, 0, SEEK_END);
+        file->size = ftell(file->file);
+        rewind(file->file);
+
+        file->start = 0;
+        file->flags = 0;
+        file->packed = false;
+    }
+
+    file->pos = 0;
+
+    return true;
+}
+
+u32 NF_FileRead(NF_TYPE_FILE *file, void *buffer, u32 size)
+{
+    if (size > (file->size - file->pos))
+        size = file->size - file->pos;
+
+    if (file->packed)
+    {
+        // Only seek if this isn't the continuation of the last read, so that
+        // files stored one after the other are read sequentially.
+        u32 offset = file->start + file->pos;
+        if (NF_ASSETPACK_POS != offset)
+            fseek(file->file, offset, SEEK_SET);
+    }
+
+    u32 done = fread(buffer, 1, size, file->file);
+    file->pos += done;
+
+    if (file->packed)
+        NF_ASSETPACK_POS = file->start + file->pos;
+
+    return done;
+}
+
+void NF_FileSeek(NF_TYPE_FILE *file, u32 pos)
+{
+    file->pos = (pos < file->size) ? pos : file->size;
+
+    if (!file->packed)
+        fseek(file->file, file->pos, SEEK_SET);
+}
+
+void NF_FileClose(NF_TYPE_FILE *file)
+{
+    // The asset pack stays open
+    if (!file->packed)
+        fclose(file->file);
+
+    file->file = NULL;
+}
+
+// Loads a whole file. It returns false if the file is in the asset pack and
+// it isn't marked as compressed, so it doesn't need to be checked.
+static bool NF_FileLoadData(const char *path, char **buffer, u32 *size)
+{
+    NF_TYPE_FILE file;
+    if (!NF_FileOpen(&file, path)) // If the file doesn't exist
+        NF_Error(101, path, 0);
+
+    // Allocate space in RAM
+    *size = file.size;
+    *buffer = calloc(*size, sizeof(char));
+    if ((*buffer == NULL) && (*size > 0)) // Not enough memory
+        NF_Error(102, NULL, *size);
+
+    // Read file and save it to RAM
+    NF_FileRead(&file, *buffer, *size);
+    NF_FileClose(&file);
+
+    return !file.packed || (file.flags & NF_ASSETPACK_COMPRESSED);
+}
+
+void NF_FileLoadRaw(const char *path, char **buffer, u32 *size)
+{
+    NF_FileLoadData(path, buffer, size);
+}
+
+void NF_FileLoad(const char *path, char **buffer, u32 *size, u32 min_size)
+{
+    bool check = NF_FileLoadData(path, buffer, size);
+
+    NF_FileUnpack(buffer, size, min_size, check);
+}
+
+void NF_FileUnpack(char **buffer, u32 *size, u32 min_size, bool check)
+{
+    char *data = *buffer;
+    u32 data_size = *size;
+
+    // If the file is compressed, decompress it to a new buffer. Files in the
+    // asset pack are only decompressed if the packer marked them as compressed.
+    u32 out_size = 0;
+    if (check)
+        out_size = NF_GetDecompressedSize(data, data_size);
+    if (out_size > 0)
+    {
+        // If there isn't enough memory for the size in the header, the data is
+        // treated as uncompressed data. It's usually an uncompressed file that
+        // starts like a compressed one.
+        char *out = calloc((out_size > min_size) ? out_size : min_size, sizeof(char));
+
+        if ((out != NULL) && NF_Decompress(data, data_size, out))
+        {
+            free(data);
+            *buffer = out;
+            *size = out_size;
+            return;
+        }
+
+        // The data isn't valid compressed data, use it as it is
+        free(out);
+    }
+
+    // Make sure that the buffer has the minimum size
+    if (data_size < min_size)
+    {
+        char *out = realloc(data, min_size);
+        if (out == NULL) // Not enough memory
+            NF_Error(102, NULL, min_size);
+        memset(out + data_size, 0, min_size - data_size);
+        data = out;
+    }
+
+    *buffer = data;
+    *size = data_size;
+}
+
 void NF_DmaMemCopy(void *destination, const void *source, u32 size)
 {
     // Based on Coranac's function:
@@ -303,20 +543,264 @@ void NF_DmaMemCopy(void *destination, const void *source, u32 size)
     {
         // Addresses are aligned, use DMA
 
-        // Wait until channel 3 is available
-        while (dmaBusy(3));
-
         // Make sure that the data in the cache is sent to the main RAM
         DC_FlushRange(source, size);
 
+        // NF_FlushVramQueue() may use channel 3 from the VBlank interrupt.
+        // Interrupts are disabled while the registers are set so that it can't
+        // change them halfway, but not during the copy.
+        u32 ime = REG_IME;
+        REG_IME = 0;
+
+        // Wait until channel 3 is available
+        while (dmaBusy(3));
+
         // Depending on the alignment use 32-bit or 16-bit copy modes
         if ((src | dst | size) & 3)
-            dmaCopyHalfWords(3, source, destination, size);
+            dmaCopyHalfWordsAsynch(3, source, destination, size);
         else
-            dmaCopyWords(3, source, destination, size);
+            dmaCopyWordsAsynch(3, source, destination, size);
+
+        REG_IME = ime;
+
+        while (dmaBusy(3));
 
         // Prevent the destination from being in cache, it would corrupt the
         // data when it is flushed
         DC_InvalidateRange(destination, size);
     }
 }
+
+// Fences of the last copies started in each DMA channel. A fence holds the
+// channel in the 2 lowest bits and a sequence number in the rest, so that it
+// is never equal to NF_DMA_FENCE_DONE.
+static u32 NF_DMA_FENCE[4];
+static u32 NF_DMA_SEQUENCE = 0;
+static u32 NF_DMA_NEXT_CHANNEL = NF_DMA_ASYNC_FIRST_CHANNEL;
+
+u32 NF_DmaMemCopyAsync(void *destination, const void *source, u32 size)
+{
+    u32 src = (u32)source;
+    u32 dst = (u32)destination;
+
+    if ((size == 0) || ((src | dst) & 1))
+    {
+        // DMA can't be used, use memcpy()
+        memcpy(destination, source, size);
+        return NF_DMA_FENCE_DONE;
+    }
+
+    // Look for a free channel starting from the one after the last used one.
+    // If all of them are busy, use the one that was started first.
+    u32 channel = NF_DMA_NEXT_CHANNEL;
+    for (u32 i = NF_DMA_ASYNC_FIRST_CHANNEL; i <= NF_DMA_ASYNC_LAST_CHANNEL; i++)
+    {
+        if (!dmaBusy(channel))
+            break;
+
+        channel++;
+        if (channel > NF_DMA_ASYNC_LAST_CHANNEL)
+            channel = NF_DMA_ASYNC_FIRST_CHANNEL;
+    }
+
+    while (dmaBusy(channel));
+
+    NF_DMA_NEXT_CHANNEL = channel + 1;
+    if (NF_DMA_NEXT_CHANNEL > NF_DMA_ASYNC_LAST_CHANNEL)
+        NF_DMA_NEXT_CHANNEL = NF_DMA_ASYNC_FIRST_CHANNEL;
+
+    // Make sure that the data in the cache is sent to the main RAM, and that
+    // the destination isn't in the cache. The destination must not be used
+    // until the copy ends, so it can be invalidated now.
+    DC_FlushRange(source, size);
+    DC_InvalidateRange(destination, size);
+
+    NF_DMA_SEQUENCE++;
+    u32 fence = (NF_DMA_SEQUENCE << 2) | channel;
+    NF_DMA_FENCE[channel] = fence;
+
+    // Channel 3 may also be used by NF_FlushVramQueue() from the VBlank
+    // interrupt, don't let it change the registers halfway.
+    u32 ime = REG_IME;
+    REG_IME = 0;
+
+    if ((src | dst | size) & 3)
+        dmaCopyHalfWordsAsynch(channel, source, destination, size);
+    else
+        dmaCopyWordsAsynch(channel, source, destination, size);
+
+    REG_IME = ime;
+
+    return fence;
+}
+
+bool NF_DmaIsDone(u32 fence)
+{
+    if (fence == NF_DMA_FENCE_DONE)
+        return true;
+
+    u32 channel = fence & 3;
+
+    // If another copy has been started in the same channel, this one has
+    // already finished.
+    if (NF_DMA_FENCE[channel] != fence)
+        return true;
+
+    return !dmaBusy(channel);
+}
+
+void NF_DmaWait(u32 fence)
+{
+    while (!NF_DmaIsDone(fence));
+}
+
+void NF_DmaWaitAll(void)
+{
+    for (u32 i = NF_DMA_ASYNC_FIRST_CHANNEL; i <= NF_DMA_ASYNC_LAST_CHANNEL; i++)
+        while (dmaBusy(i));
+}
+
+// VRAM upload queue
+NF_TYPE_VRAMQUEUE_INFO NF_VRAMQUEUE[NF_VRAM_QUEUE_SIZE];
+u32 NF_VRAMQUEUE_COUNT = 0;
+bool NF_VRAMQUEUE_ENABLED = false;
+
+// Do one transfer of the queue, or a transfer that couldn't be queued
+static void NF_VramQueueTransfer(const NF_TYPE_VRAMQUEUE_INFO *entry)
+{
+    if (entry->source == NULL)
+    {
+        // Register write
+        *(vu16 *)entry->destination = entry->value;
+        return;
+    }
+
+    if (entry->bank == NULL)
+    {
+        NF_DmaMemCopy(entry->destination, entry->source, entry->size);
+    }
+    else
+    {
+        // Map the bank as LCD during the copy and restore it afterwards
+        u8 mapping = *entry->bank;
+        *entry->bank = VRAM_ENABLE;
+        NF_DmaMemCopy(entry->destination, entry->source, entry->size);
+        *entry->bank = mapping;
+    }
+}
+
+static void NF_VramQueueAdd(vu8 *bank, void *destination, const void *source,
+                            u32 size, u16 value)
+{
+    NF_TYPE_VRAMQUEUE_INFO entry = {
+        .destination = destination,
+        .source = source,
+        .size = size,
+        .bank = bank,
+        .value = value,
+    };
+
+    if ((size == 0) && (source != NULL))
+        return;
+
+    if (!NF_VRAMQUEUE_ENABLED)
+    {
+        NF_VramQueueTransfer(&entry);
+        return;
+    }
+
+    // Don't let the VBlank handler flush the queue while it's being modified
+    u32 ime = REG_IME;
+    REG_IME = 0;
+
+    // Drop previous transfers to the same destination that are completely
+    // overwritten by this one. They are removed instead of replaced so that
+    // the order of the transfers is preserved.
+    for (u32 i = 0; i < NF_VRAMQUEUE_COUNT; i++)
+    {
+        NF_TYPE_VRAMQUEUE_INFO *old = &NF_VRAMQUEUE[i];
+
+        if ((old->destination == destination) && (old->size <= size)
+            && ((old->source == NULL) == (source == NULL)))
+        {
+            old->size = 0;
+        }
+    }
+
+    // If this transfer continues the last one, merge them
+    if (NF_VRAMQUEUE_COUNT > 0)
+    {
+        NF_TYPE_VRAMQUEUE_INFO *last = &NF_VRAMQUEUE[NF_VRAMQUEUE_COUNT - 1];
+
+        if ((source != NULL) && (last->source != NULL) && (last->size > 0)
+            && (last->bank == bank)
+            && (((u32)last->destination + last->size) == (u32)destination)
+            && (((u32)last->source + last->size) == (u32)source))
+        {
+            last->size += size;
+            REG_IME = ime;
+            return;
+        }
+    }
+
+    if (NF_VRAMQUEUE_COUNT < NF_VRAM_QUEUE_SIZE)
+    {
+        NF_VRAMQUEUE[NF_VRAMQUEUE_COUNT] = entry;
+        NF_VRAMQUEUE_COUNT++;
+    }
+    else
+    {
+        // The queue is full. Copy the data now, after the transfers that are
+        // already in the queue so that they are done in order.
+        NF_FlushVramQueue();
+        NF_VramQueueTransfer(&entry);
+    }
+
+    REG_IME = ime;
+}
+
+void NF_EnableVramQueue(void)
+{
+    NF_VRAMQUEUE_COUNT = 0;
+    NF_VRAMQUEUE_ENABLED = true;
+}
+
+void NF_DisableVramQueue(void)
+{
+    // Don't let the VBlank handler flush the queue at the same time, or queue
+    // new transfers between the flush and disabling the queue
+    u32 ime = REG_IME;
+    REG_IME = 0;
+
+    NF_FlushVramQueue();
+    NF_VRAMQUEUE_ENABLED = false;
+
+    REG_IME = ime;
+}
+
+void NF_QueueVramCopy(void *destination, const void *source, u32 size)
+{
+    NF_VramQueueAdd(NULL, destination, source, size, 0);
+}
+
+void NF_QueueVramBankCopy(vu8 *bank, void *destination, const void *source,
+                          u32 size)
+{
+    NF_VramQueueAdd(bank, destination, source, size, 0);
+}
+
+void NF_QueueRegWrite16(vu16 *reg, u16 value)
+{
+    NF_VramQueueAdd(NULL, (void *)reg, NULL, 2, value);
+}
+
+void NF_FlushVramQueue(void)
+{
+    for (u32 i = 0; i < NF_VRAMQUEUE_COUNT; i++)
+    {
+        if (NF_VRAMQUEUE[i].size > 0)
+            NF_VramQueueTransfer(&NF_VRAMQUEUE[i]);
+    }
+
+    NF_VRAMQUEUE_COUNT = 0;
+}
@@ -6,6 +6,7 @@
 // http://www.nightfoxandco.com/
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <nds.h>
@@ -26,6 +27,705 @@ NF_TYPE_BG8B_INFO NF_BG8B[NF_SLOTS_BG8B];
 // Backbuffer of 8 bit bitmaps for each screen
 NF_TYPE_BB8B_INFO NF_8BITS_BACKBUFFER[2];
 
+// Page flipping of the 16 bit backbuffer of the main engine. The page that
+// isn't displayed is the backbuffer.
+static bool NF_16BITS_PAGEFLIP = false;
+static u32 NF_16BITS_PAGE = 0; // Page being displayed
+
+// Minimum size in bytes of a copy to VRAM done with DMA by NF_Copy16()
+#define NF_COPY16_DMA_MIN 1024
+
+// Copies 16-bit pixels. The backbuffer may be in VRAM when page flipping is
+// used, and VRAM can't be written in units of 8 bits. memcpy() can't be used
+// because it may copy small blocks byte by byte even if they are aligned.
+static void NF_Copy16(void *dst, const void *src, u32 size)
+{
+    u16 *dst16 = dst;
+    const u16 *src16 = src;
+
+    // VRAM isn't cached, so big blocks can be copied with DMA without having
+    // to worry about the cache lines of the destination.
+    if ((size >= NF_COPY16_DMA_MIN) && (((u32)dst >> 24) == 0x06))
+    {
+        NF_DmaMemCopy(dst, src, size);
+        return;
+    }
+
+    if (((u32)dst16 & 2) && (size > 0))
+    {
+        *dst16++ = *src16++;
+        size -= 2;
+    }
+
+    if (((u32)src16 & 3) == 0)
+    {
+        // Both addresses are aligned to 32 bits
+        u32 *dst32 = (u32 *)dst16;
+        const u32 *src32 = (const u32 *)src16;
+
+        while (size >= 16)
+        {
+            dst32[0] = src32[0];
+            dst32[1] = src32[1];
+            dst32[2] = src32[2];
+            dst32[3] = src32[3];
+            dst32 += 4;
+            src32 += 4;
+            size -= 16;
+        }
+
+        while (size >= 4)
+        {
+            *dst32++ = *src32++;
+            size -= 4;
+        }
+
+        dst16 = (u16 *)dst32;
+        src16 = (const u16 *)src32;
+    }
+
+    while (size > 0)
+    {
+        *dst16++ = *src16++;
+        size -= 2;
+    }
+}
+
+// Areas of a backbuffer modified since the last flip
+typedef struct {
+    u16 rects[NF_BACKBUFFER_DIRTY_RECTS][4];    // X, Y, width, height
+    u32 count;
+    bool full;                                  // Copy the whole backbuffer
+    bool pal;                                   // Copy the palette (8 bit only)
+} nf_dirty_info;
+
+static nf_dirty_info NF_16BITS_DIRTY[2];
+static nf_dirty_info NF_8BITS_DIRTY[2];
+
+static void NF_DirtyReset(nf_dirty_info *dirty, bool full)
+{
+    dirty->count = 0;
+    dirty->full = full;
+    dirty->pal = full;
+}
+
+// Grows the rectangle (x0, y0) - (x1, y1) to include a dirty rectangle
+static void NF_DirtyMerge(const u16 *r, s32 *x0, s32 *y0, s32 *x1, s32 *y1)
+{
+    if (r[0] < *x0)
+        *x0 = r[0];
+    if (r[1] < *y0)
+        *y0 = r[1];
+    if ((r[0] + r[2]) > *x1)
+        *x1 = r[0] + r[2];
+    if ((r[1] + r[3]) > *y1)
+        *y1 = r[1] + r[3];
+}
+
+// Adds a rectangle to the list of dirty areas. Overlapping rectangles are
+// merged so that no row is copied twice.
+static void NF_DirtyAdd(nf_dirty_info *dirty, s32 x, s32 y, s32 w, s32 h)
+{
+    if (dirty->full)
+        return;
+
+    // Clip the rectangle to the backbuffer
+    s32 x0 = (x < 0) ? 0 : x;
+    s32 y0 = (y < 0) ? 0 : y;
+    s32 x1 = ((x + w) > 256) ? 256 : (x + w);
+    s32 y1 = ((y + h) > 256) ? 256 : (y + h);
+
+    if ((x0 >= x1) || (y0 >= y1))
+        return;
+
+    u32 n = 0;
+    while (n < dirty->count)
+    {
+        u16 *r = dirty->rects[n];
+
+        // Merge it if it overlaps, and check all the rectangles again
+        if ((x0 < (r[0] + r[2])) && (r[0] < x1) && (y0 < (r[1] + r[3])) && (r[1] < y1))
+        {
+            NF_DirtyMerge(r, &x0, &y0, &x1, &y1);
+
+            dirty->count--;
+            memcpy(r, dirty->rects[dirty->count], sizeof(dirty->rects[0]));
+            n = 0;
+            continue;
+        }
+
+        n++;
+    }
+
+    // If the list is full, merge it with the rectangle that grows the least
+    if (dirty->count == NF_BACKBUFFER_DIRTY_RECTS)
+    {
+        u32 best = 0;
+        u32 best_growth = 0xFFFFFFFF;
+
+        for (n = 0; n < dirty->count; n++)
+        {
+            u16 *r = dirty->rects[n];
+            s32 ux0 = x0, uy0 = y0, ux1 = x1, uy1 = y1;
+            NF_DirtyMerge(r, &ux0, &uy0, &ux1, &uy1);
+
+            u32 growth = ((ux1 - ux0) * (uy1 - uy0)) - (r[2] * r[3]);
+            if (growth < best_growth)
+            {
+                best = n;
+                best_growth = growth;
+            }
+        }
+
+        u16 *r = dirty->rects[best];
+        NF_DirtyMerge(r, &x0, &y0, &x1, &y1);
+
+        dirty->count--;
+        memcpy(r, dirty->rects[dirty->count], sizeof(dirty->rects[0]));
+    }
+
+    u16 *r = dirty->rects[dirty->count++];
+    r[0] = x0;
+    r[1] = y0;
+    r[2] = x1 - x0;
+    r[3] = y1 - y0;
+}
+
+// Returns true if it's better to copy the whole backbuffer
+static bool NF_DirtyIsFull(const nf_dirty_info *dirty)
+{
+    if (dirty->full)
+        return true;
+
+    u32 area = 0;
+    for (u32 n = 0; n < dirty->count; n++)
+        area += dirty->rects[n][2] * dirty->rects[n][3];
+
+    return area > NF_BACKBUFFER_DIRTY_AREA;
+}
+
+// Copies the rows of the dirty rectangles of a 256x256 backbuffer with pixels
+// of (1 << shift) bytes to VRAM
+static void NF_DirtyCopy(const nf_dirty_info *dirty, u32 vram,
+                         const void *buffer, u32 shift)
+{
+    u32 pitch = 256 << shift;
+
+    for (u32 n = 0; n < dirty->count; n++)
+    {
+        const u16 *r = dirty->rects[n];
+        u32 x = r[0];
+        u32 w = r[2];
+
+        // VRAM can only be written in units of 16 bits
+        if (shift == 0)
+        {
+            w += x & 1;
+            x &= ~1;
+            w = (w + 1) & ~1;
+        }
+
+        u32 offset = ((r[1] << 8) + x) << shift;
+        u32 size = w << shift;
+        const u8 *src = (const u8 *)buffer + offset;
+        u32 dst = vram + offset;
+
+        // Full rows are a single block
+        if (size == pitch)
+        {
+            NF_DmaMemCopy((void *)dst, src, r[3] * pitch);
+            continue;
+        }
+
+        DC_FlushRange(src, ((r[3] - 1) * pitch) + size);
+
+        for (u32 row = 0; row < r[3]; row++)
+        {
+            // NF_DmaMemCopyAsync() may be using channel 3, and the VBlank
+            // interrupt may use it too (NF_FlushVramQueue()). Interrupts are
+            // disabled while the registers are set so that it can't change
+            // them halfway.
+            u32 ime = REG_IME;
+            REG_IME = 0;
+
+            while (dmaBusy(3));
+
+            if ((offset | size) & 3)
+                dmaCopyHalfWordsAsynch(3, src, (void *)dst, size);
+            else
+                dmaCopyWordsAsynch(3, src, (void *)dst, size);
+
+            REG_IME = ime;
+
+            src += pitch;
+            dst += pitch;
+        }
+    }
+
+    while (dmaBusy(3));
+}
+
+// Finds the runs of pixels that aren't transparent in each row of an image with
+// pixels of (1 << shift) bytes. The runs of each row are stored as the number
+// of runs followed by the start and length of each run. If the image doesn't
+// have any transparent pixel both pointers are set to NULL.
+static void NF_BuildSpans(const void *src, u32 width, u32 height, u32 shift,
+                          u32 key, u32 **spanrows, u16 **spans)
+{
+    free(*spanrows);
+    free(*spans);
+    *spanrows = NULL;
+    *spans = NULL;
+
+    const u8 *src8 = src;
+    const u16 *src16 = src;
+
+    // Count the runs first to allocate the exact size
+    u32 runs = 0;
+    bool transparent = false;
+
+    for (u32 y = 0; y < height; y++)
+    {
+        bool opaque = false;
+        for (u32 x = 0; x < width; x++)
+        {
+            u32 idx = (y * width) + x;
+            u32 pixel = (shift == 0) ? src8[idx] : src16[idx];
+
+            if (pixel == key)
+            {
+                transparent = true;
+                opaque = false;
+            }
+            else if (!opaque)
+            {
+                runs++;
+                opaque = true;
+            }
+        }
+    }
+
+    if (!transparent)
+        return;
+
+    *spanrows = malloc(height * sizeof(u32));
+    *spans = malloc((height + (runs << 1)) * sizeof(u16));
+    if ((*spanrows == NULL) || (*spans == NULL))
+        NF_Error(102, NULL, (height * sizeof(u32)) + ((height + (runs << 1)) * sizeof(u16)));
+
+    u16 *out = *spans;
+
+    for (u32 y = 0; y < height; y++)
+    {
+        (*spanrows)[y] = out - *spans;
+
+        u16 *count = out++;
+        *count = 0;
+
+        u32 x = 0;
+        while (x < width)
+        {
+            u32 idx = (y * width) + x;
+
+            // Skip transparent pixels
+            if (((shift == 0) ? src8[idx] : src16[idx]) == key)
+            {
+                x++;
+                continue;
+            }
+
+            // Measure the run of opaque pixels
+            u32 start = x;
+            while (x < width)
+            {
+                idx = (y * width) + x;
+                if (((shift == 0) ? src8[idx] : src16[idx]) == key)
+                    break;
+                x++;
+            }
+
+            *out++ = start;
+            *out++ = x - start;
+            (*count)++;
+        }
+    }
+}
+
+// Function that draws "size" bytes of pixels of an image into a backbuffer
+typedef void (*nf_blit_kernel)(void *dst, const void *src, u32 size,
+                               const void *arg);
+
+static inline void NF_BlitCopy(void *dst, const void *src, u32 size, u32 shift,
+                               nf_blit_kernel kernel, const void *arg)
+{
+    if (kernel != NULL)
+        kernel(dst, src, size, arg);
+    else if (shift == 0)
+        memcpy(dst, src, size);
+    else
+        NF_Copy16(dst, src, size);
+}
+
+// Copies an image of pixels of (1 << shift) bytes to a 256x256 buffer. The
+// image is clipped once, and each visible row (or visible part of each run of
+// opaque pixels, if spanrows isn't NULL) is copied with memcpy(), which uses
+// 32-bit copies when the addresses are aligned. If a kernel is provided, it's
+// used instead of memcpy().
+static void NF_BlitSpans(void *dst, const void *src, u32 width, u32 height,
+                         s32 x, s32 y, const u32 *spanrows, const u16 *spans,
+                         u32 shift, nf_blit_kernel kernel, const void *arg)
+{
+    // Visible part of the image, in image coordinates
+    s32 sx0 = (x < 0) ? -x : 0;
+    s32 sy0 = (y < 0) ? -y : 0;
+    s32 sx1 = ((x + (s32)width) > 256) ? (256 - x) : (s32)width;
+    s32 sy1 = ((y + (s32)height) > 256) ? (256 - y) : (s32)height;
+
+    if ((sx0 >= sx1) || (sy0 >= sy1))
+        return;
+
+    u8 *dst8 = dst;
+    const u8 *src8 = src;
+
+    if (spanrows == NULL)
+    {
+        u32 size = (sx1 - sx0) << shift;
+
+        // Full width images are a single block
+        if (size == (256u << shift))
+        {
+            NF_BlitCopy(dst8 + (((y + sy0) << 8) << shift),
+                        src8 + ((sy0 * width) << shift), (sy1 - sy0) * size, shift,
+                        kernel, arg);
+            return;
+        }
+
+        for (s32 row = sy0; row < sy1; row++)
+        {
+            NF_BlitCopy(dst8 + ((((y + row) << 8) + x + sx0) << shift),
+                        src8 + (((row * width) + sx0) << shift), size, shift,
+                        kernel, arg);
+        }
+        return;
+    }
+
+    for (s32 row = sy0; row < sy1; row++)
+    {
+        const u16 *span = spans + spanrows[row];
+        u32 count = *span++;
+
+        u8 *dst_row = dst8 + ((((y + row) << 8) + x) << shift);
+        const u8 *src_row = src8 + ((row * width) << shift);
+
+        for (u32 n = 0; n < count; n++, span += 2)
+        {
+            s32 start = span[0];
+            s32 end = start + span[1];
+
+            // Runs are sorted, so the rest of them are clipped too
+            if (start >= sx1)
+                break;
+            if (end <= sx0)
+                continue;
+
+            if (start < sx0)
+                start = sx0;
+            if (end > sx1)
+                end = sx1;
+
+            NF_BlitCopy(dst_row + (start << shift), src_row + (start << shift),
+                        (end - start) << shift, shift, kernel, arg);
+        }
+    }
+}
+
+// Transformation of an image drawn with NF_BlitRotScale(). Texture coordinates
+// are in 16.16 fixed point.
+typedef struct {
+    s32 ox, oy;         // Destination pixel with texture coordinates (u0, v0)
+    s64 u0, v0;
+    s32 dudx, dvdx;     // Change of the texture coordinates per pixel...
+    s32 dudy, dvdy;     // ...and per row
+    s32 x0, y0, x1, y1; // Bounding box in the destination (inclusive)
+} nf_rotscale_info;
+
+static s64 NF_FloorDiv(s64 n, s64 d)
+{
+    s64 q = n / d;
+    if (((n % d) != 0) && ((n < 0) != (d < 0)))
+        q--;
+    return q;
+}
+
+// Limits [x0, x1] to the values of x that make 0 <= a + x * b < limit. Returns
+// false if there aren't any.
+static bool NF_SpanRange(s64 a, s64 b, s64 limit, s32 *x0, s32 *x1)
+{
+    s64 lo, hi;
+
+    if (b == 0)
+    {
+        return (a >= 0) && (a < limit) && (*x0 <= *x1);
+    }
+    else if (b > 0)
+    {
+        lo = -NF_FloorDiv(a, b);                // ceil(-a / b)
+        hi = NF_FloorDiv(limit - 1 - a, b);
+    }
+    else
+    {
+        lo = -NF_FloorDiv(limit - 1 - a, -b);   // ceil((limit - 1 - a) / b)
+        hi = NF_FloorDiv(a, -b);                // floor(-a / b)
+    }
+
+    if (lo > *x0)
+        *x0 = lo;
+    if (hi < *x1)
+        *x1 = hi;
+
+    return *x0 <= *x1;
+}
+
+// Draws an image of pixels of (1 << shift) bytes into a 256x256 buffer using
+// nearest neighbour sampling. The range of pixels of each row that samples the
+// image is found once per row, so the inner loop doesn't need to check bounds.
+static void NF_BlitRotScale(void *dst, const void *src, u32 width, u32 height,
+                            const nf_rotscale_info *t, u32 shift, bool alpha,
+                            u32 key)
+{
+    s32 y0 = (t->y0 < 0) ? 0 : t->y0;
+    s32 y1 = (t->y1 > 255) ? 255 : t->y1;
+
+    s64 u_limit = (s64)width << 16;
+    s64 v_limit = (s64)height << 16;
+
+    for (s32 py = y0; py <= y1; py++)
+    {
+        // Texture coordinates of the pixel at x = 0 of this row
+        s64 u_row = t->u0 + ((s64)(py - t->oy) * t->dudy) - ((s64)t->ox * t->dudx);
+        s64 v_row = t->v0 + ((s64)(py - t->oy) * t->dvdy) - ((s64)t->ox * t->dvdx);
+
+        s32 x0 = (t->x0 < 0) ? 0 : t->x0;
+        s32 x1 = (t->x1 > 255) ? 255 : t->x1;
+
+        if (!NF_SpanRange(u_row, t->dudx, u_limit, &x0, &x1))
+            continue;
+        if (!NF_SpanRange(v_row, t->dvdx, v_limit, &x0, &x1))
+            continue;
+
+        s32 u = u_row + ((s64)x0 * t->dudx);
+        s32 v = v_row + ((s64)x0 * t->dvdx);
+        s32 dudx = t->dudx;
+        s32 dvdx = t->dvdx;
+        u32 count = x1 - x0 + 1;
+
+        if (shift == 0)
+        {
+            u8 *d = (u8 *)dst + (py << 8) + x0;
+            const u8 *s = src;
+            for (u32 n = 0; n < count; n++, u += dudx, v += dvdx)
+            {
+                u32 color = s[((v >> 16) * width) + (u >> 16)];
+                if (!alpha || (color != key))
+                    d[n] = color;
+            }
+        }
+        else
+        {
+            u16 *d = (u16 *)dst + (py << 8) + x0;
+            const u16 *s = src;
+
+            if (dvdx == 0)
+            {
+                // Only scaled, all pixels come from the same row
+                s += (v >> 16) * width;
+                for (u32 n = 0; n < count; n++, u += dudx)
+                {
+                    u32 color = s[u >> 16];
+                    if (!alpha || (color != key))
+                        d[n] = color;
+                }
+            }
+            else
+            {
+                for (u32 n = 0; n < count; n++, u += dudx, v += dvdx)
+                {
+                    u32 color = s[((v >> 16) * width) + (u >> 16)];
+                    if (!alpha || (color != key))
+                        d[n] = color;
+                }
+            }
+        }
+    }
+}
+
+// Fills the transformation of an image of "width" x "height" pixels scaled by
+// x_scale / 256 and y_scale / 256, rotated by angle and centered at (x, y).
+// Returns false if it can't be drawn.
+static bool NF_RotScaleSetup(nf_rotscale_info *t, u32 width, u32 height,
+                             s32 x, s32 y, s32 angle, s32 x_scale, s32 y_scale)
+{
+    if ((x_scale <= 0) || (y_scale <= 0))
+        return false;
+
+    // Same angle range as NF_AffineBgMove(). Positive angles rotate clockwise.
+    s32 angle_sin = sinLerp(angle * 16);
+    s32 angle_cos = cosLerp(angle * 16);
+
+    // Inverse transformation, from the destination to the image (16.16)
+    t->dudx = (angle_cos * 4096) / x_scale;
+    t->dudy = (angle_sin * 4096) / x_scale;
+    t->dvdx = (-angle_sin * 4096) / y_scale;
+    t->dvdy = (angle_cos * 4096) / y_scale;
+
+    // Sample the center of the pixels
+    t->ox = x;
+    t->oy = y;
+    t->u0 = ((s64)width << 15) + ((t->dudx + t->dudy) >> 1);
+    t->v0 = ((s64)height << 15) + ((t->dvdx + t->dvdy) >> 1);
+
+    // Half of the size of the bounding box of the transformed image
+    s32 abs_sin = (angle_sin < 0) ? -angle_sin : angle_sin;
+    s32 abs_cos = (angle_cos < 0) ? -angle_cos : angle_cos;
+    s32 ex = (((s64)abs_cos * width * x_scale) + ((s64)abs_sin * height * y_scale)) >> 21;
+    s32 ey = (((s64)abs_sin * width * x_scale) + ((s64)abs_cos * height * y_scale)) >> 21;
+
+    t->x0 = x - ex - 1;
+    t->y0 = y - ey - 1;
+    t->x1 = x + ex + 1;
+    t->y1 = y + ey + 1;
+
+    return true;
+}
+
+// Fills the transformation of an image of "width" x "height" pixels stretched
+// to the rectangle (x, y) - (x + w - 1, y + h - 1). Returns false if it can't
+// be drawn.
+static bool NF_ScaledSetup(nf_rotscale_info *t, u32 width, u32 height,
+                           s32 x, s32 y, s32 w, s32 h)
+{
+    if ((w <= 0) || (h <= 0))
+        return false;
+
+    t->dudx = ((s64)width << 16) / w;
+    t->dudy = 0;
+    t->dvdx = 0;
+    t->dvdy = ((s64)height << 16) / h;
+
+    t->ox = x;
+    t->oy = y;
+    t->u0 = t->dudx >> 1;
+    t->v0 = t->dvdy >> 1;
+
+    t->x0 = x;
+    t->y0 = y;
+    t->x1 = x + w - 1;
+    t->y1 = y + h - 1;
+
+    return true;
+}
+
+// Parameters of a blend kernel
+typedef struct {
+    u32 mode;
+    u32 alpha;          // 0 - 32
+    const u8 *mask;     // Mask of the image (NF_BLEND_MASK)
+    const u16 *image;   // First pixel of the image, to find the mask values
+} nf_blend_info;
+
+// RGB15 colors are spread in a 32-bit value as 000000GGGGG00000 0BBBBB00000RRRRR
+// so that each component has 5 free bits above it. Multiplications by 0 - 32
+// and additions of two colors can then be done with all three components at
+// the same time.
+#define NF_RGB15_SPREAD_MASK 0x03E07C1F
+
+static inline u32 NF_Rgb15Spread(u32 color)
+{
+    return (color | (color << 16)) & NF_RGB15_SPREAD_MASK;
+}
+
+static inline u16 NF_Rgb15Pack(u32 spread)
+{
+    return ((spread | (spread >> 16)) & 0x7FFF) | BIT(15);
+}
+
+// (src * alpha + dst * (32 - alpha)) / 32 for spread colors
+static inline u32 NF_Rgb15Lerp(u32 src, u32 dst, u32 alpha)
+{
+    return (((src * alpha) + (dst * (32 - alpha))) >> 5) & NF_RGB15_SPREAD_MASK;
+}
+
+static void NF_BlendKernel(void *dst, const void *src, u32 size, const void *arg)
+{
+    const nf_blend_info *info = arg;
+    u16 *d = dst;
+    const u16 *s = src;
+    u32 count = size >> 1;
+    u32 alpha = info->alpha;
+
+    switch (info->mode)
+    {
+        case NF_BLEND_ALPHA:
+            for (u32 n = 0; n < count; n++)
+            {
+                u32 color = NF_Rgb15Lerp(NF_Rgb15Spread(s[n]), NF_Rgb15Spread(d[n]), alpha);
+                d[n] = NF_Rgb15Pack(color);
+            }
+            break;
+
+        case NF_BLEND_MASK:
+        {
+            const u8 *m = info->mask + (s - info->image);
+            for (u32 n = 0; n < count; n++)
+            {
+                // Convert the value of the mask from 0 - 255 to 0 - 32
+                u32 a = (((m[n] + 4) >> 3) * alpha) >> 5;
+                if (a == 0)
+                    continue;
+
+                u32 color = NF_Rgb15Lerp(NF_Rgb15Spread(s[n]), NF_Rgb15Spread(d[n]), a);
+                d[n] = NF_Rgb15Pack(color);
+            }
+            break;
+        }
+
+        case NF_BLEND_ADD:
+            for (u32 n = 0; n < count; n++)
+            {
+                u32 color = NF_Rgb15Spread(s[n]);
+                if (alpha < 32)
+                    color = ((color * alpha) >> 5) & NF_RGB15_SPREAD_MASK;
+                color += NF_Rgb15Spread(d[n]);
+
+                // Saturate the components that have overflowed to bit 5
+                u32 carry = color & 0x04008020;
+                color = (color | (carry - (carry >> 5))) & NF_RGB15_SPREAD_MASK;
+                d[n] = NF_Rgb15Pack(color);
+            }
+            break;
+
+        case NF_BLEND_MULTIPLY:
+            for (u32 n = 0; n < count; n++)
+            {
+                // Each component needs a different multiplier
+                u32 c1 = s[n];
+                u32 c2 = d[n];
+                u32 r = (((c1 & 0x1F) * (c2 & 0x1F)) + 31) >> 5;
+                u32 g = ((((c1 >> 5) & 0x1F) * ((c2 >> 5) & 0x1F)) + 31) >> 5;
+                u32 b = ((((c1 >> 10) & 0x1F) * ((c2 >> 10) & 0x1F)) + 31) >> 5;
+                u32 color = r | (g << 5) | (b << 10);
+
+                if (alpha < 32)
+                    color = NF_Rgb15Lerp(NF_Rgb15Spread(color), NF_Rgb15Spread(c2), alpha);
+                else
+                    color = NF_Rgb15Spread(color);
+
+                d[n] = NF_Rgb15Pack(color);
+            }
+            break;
+    }
+}
+
 void NF_Init16bitsBgBuffers(void)
 {
     for (int n = 0; n < NF_SLOTS_BG16B; n++)
@@ -35,6 +735,9 @@ void NF_Init16bitsBgBuffers(void)
         NF_BG16B[n].inuse = false;
         NF_BG16B[n].width = 0;
         NF_BG16B[n].height = 0;
+        NF_BG16B[n].spanrows = NULL;
+        NF_BG16B[n].spans = NULL;
+        NF_BG16B[n].mask = NULL;
     }
 }
 
@@ -42,7 +745,12 @@ void NF_Reset16bitsBgBuffers(void)
 {
     // Free buffers
     for (int n = 0; n < NF_SLOTS_BG16B; n++)
+    {
         free(NF_BG16B[n].buffer);
+        free(NF_BG16B[n].spanrows);
+        free(NF_BG16B[n].spans);
+        free(NF_BG16B[n].mask);
+    }
 
     // Reset background information
     NF_Init16bitsBgBuffers();
@@ -54,6 +762,13 @@ void NF_Init16bitsBackBuffer(u8 screen)
         screen = 1;
 
     NF_16BITS_BACKBUFFER[screen] = NULL;
+    NF_DirtyReset(&NF_16BITS_DIRTY[screen], false);
+
+    if (screen == 0)
+    {
+        NF_16BITS_PAGEFLIP = false;
+        NF_16BITS_PAGE = 0;
+    }
 }
 
 void NF_Enable16bitsBackBuffer(u8 screen)
@@ -61,6 +776,10 @@ void NF_Enable16bitsBackBuffer(u8 screen)
     if (screen > 1)
         screen = 1;
 
+    // The backbuffer can't be in VRAM and in RAM at the same time
+    if ((screen == 0) && NF_16BITS_PAGEFLIP)
+        NF_Disable16bitsPageFlip(0);
+
     // Free buffer if it was already allocated
     free(NF_16BITS_BACKBUFFER[screen]);
     NF_16BITS_BACKBUFFER[screen] = NULL;
@@ -71,6 +790,8 @@ void NF_Enable16bitsBackBuffer(u8 screen)
     // Fail if there isn't enough free memory
     if (NF_16BITS_BACKBUFFER[screen] == NULL)
         NF_Error(102, NULL, 131072);
+
+    NF_DirtyReset(&NF_16BITS_DIRTY[screen], true);
 }
 
 void NF_Disble16bitsBackBuffer(u8 screen)
@@ -78,6 +799,12 @@ void NF_Disble16bitsBackBuffer(u8 screen)
     if (screen > 1)
         screen = 1;
 
+    if ((screen == 0) && NF_16BITS_PAGEFLIP)
+    {
+        NF_Disable16bitsPageFlip(0);
+        return;
+    }
+
     // Free buffer if it was already allocated
     free(NF_16BITS_BACKBUFFER[screen]);
     NF_16BITS_BACKBUFFER[screen] = NULL;
@@ -85,6 +812,14 @@ void NF_Disble16bitsBackBuffer(u8 screen)
 
 void NF_Flip16bitsBackBuffer(u8 screen)
 {
+    if ((screen == 0) && NF_16BITS_PAGEFLIP)
+    {
+        NF_Flip16bitsPage(0);
+        return;
+    }
+
+    NF_DirtyReset(&NF_16BITS_DIRTY[screen ? 1 : 0], false);
+
     // Copy contents of the backuffer to VRAM
     if (screen == 0)
         NF_DmaMemCopy((void *)0x06000000, NF_16BITS_BACKBUFFER[0], 131072);
@@ -92,6 +827,129 @@ void NF_Flip16bitsBackBuffer(u8 screen)
         NF_DmaMemCopy((void *)0x06200000, NF_16BITS_BACKBUFFER[1], 131072);
 }
 
+u32 NF_Flip16bitsBackBufferAsync(u8 screen)
+{
+    if ((screen == 0) && NF_16BITS_PAGEFLIP)
+    {
+        NF_Flip16bitsPage(0);
+        return NF_DMA_FENCE_DONE;
+    }
+
+    NF_DirtyReset(&NF_16BITS_DIRTY[screen ? 1 : 0], false);
+
+    // Start the copy of the backbuffer to VRAM and return without waiting
+    if (screen == 0)
+        return NF_DmaMemCopyAsync((void *)0x06000000, NF_16BITS_BACKBUFFER[0], 131072);
+    else
+        return NF_DmaMemCopyAsync((void *)0x06200000, NF_16BITS_BACKBUFFER[1], 131072);
+}
+
+void NF_Mark16bitsBackBufferDirty(u8 screen, s16 x, s16 y, u16 w, u16 h)
+{
+    if (screen > 1)
+        screen = 1;
+
+    NF_DirtyAdd(&NF_16BITS_DIRTY[screen], x, y, w, h);
+}
+
+void NF_Flip16bitsBackBufferDirty(u8 screen)
+{
+    if (screen > 1)
+        screen = 1;
+
+    nf_dirty_info *dirty = &NF_16BITS_DIRTY[screen];
+
+    // Page flipping doesn't copy anything
+    if (NF_DirtyIsFull(dirty) || ((screen == 0) && NF_16BITS_PAGEFLIP))
+    {
+        NF_Flip16bitsBackBuffer(screen);
+        return;
+    }
+
+    NF_DirtyCopy(dirty, (screen == 0) ? 0x06000000 : 0x06200000,
+                 NF_16BITS_BACKBUFFER[screen], 1);
+    NF_DirtyReset(dirty, false);
+}
+
+void NF_Enable16bitsPageFlip(u8 screen)
+{
+    // The sub engine can only use VRAM_C (128 KB) for backgrounds
+    if (screen != 0)
+        NF_Error(106, "16 bits page flip screen", 0);
+
+    // Free the backbuffer in RAM, it isn't needed anymore
+    free(NF_16BITS_BACKBUFFER[0]);
+    NF_16BITS_BACKBUFFER[0] = NULL;
+
+    // VRAM_B: Second page of the main engine backgrounds (128 KB)
+    vramSetBankB(VRAM_B_MAIN_BG_0x06020000);
+
+    // Clear it with DMA, VRAM doesn't support 8-bit writes. NF_DmaMemCopyAsync()
+    // and the VBlank interrupt (NF_FlushVramQueue()) may use channel 3 too, so
+    // interrupts are disabled while the registers are set, like in
+    // NF_DmaMemCopyAsync().
+    u32 ime = REG_IME;
+    REG_IME = 0;
+
+    while (dmaBusy(3));
+
+    DMA_FILL(3) = 0;
+    DMA_SRC(3) = (u32)&DMA_FILL(3);
+    DMA_DEST(3) = 0x06020000;
+    DMA_CR(3) = DMA_SRC_FIX | DMA_COPY_WORDS | (131072 >> 2);
+
+    REG_IME = ime;
+
+    while (dmaBusy(3));
+
+    // Display the first page and draw into the second one
+    REG_BG3CNT = (REG_BG3CNT & ~BG_BMP_BASE(31)) | BG_BMP_BASE(0);
+    NF_16BITS_PAGE = 0;
+    NF_16BITS_BACKBUFFER[0] = (u16 *)0x06020000;
+    NF_16BITS_PAGEFLIP = true;
+
+    NF_DirtyReset(&NF_16BITS_DIRTY[0], false);
+}
+
+void NF_Disable16bitsPageFlip(u8 screen)
+{
+    if ((screen != 0) || !NF_16BITS_PAGEFLIP)
+        return;
+
+    // Move the page being displayed to VRAM_A if required
+    if (NF_16BITS_PAGE == 1)
+        NF_DmaMemCopy((void *)0x06000000, (void *)0x06020000, 131072);
+
+    REG_BG3CNT = (REG_BG3CNT & ~BG_BMP_BASE(31)) | BG_BMP_BASE(0);
+    vramSetBankB(VRAM_B_LCD);
+
+    NF_16BITS_BACKBUFFER[0] = NULL;
+    NF_16BITS_PAGEFLIP = false;
+    NF_16BITS_PAGE = 0;
+}
+
+void NF_Flip16bitsPage(u8 screen)
+{
+    if ((screen != 0) || !NF_16BITS_PAGEFLIP)
+        return;
+
+    // Display the page that has been drawn, and draw into the other one
+    NF_16BITS_BACKBUFFER[0] = (u16 *)(NF_16BITS_PAGE ? 0x06020000 : 0x06000000);
+    NF_16BITS_PAGE ^= 1;
+    REG_BG3CNT = (REG_BG3CNT & ~BG_BMP_BASE(31)) | BG_BMP_BASE(NF_16BITS_PAGE * 8);
+}
+
+u16 *NF_Get16bitsDisplayedPage(u8 screen)
+{
+    if (screen != 0)
+        return (u16 *)0x06200000;
+
+    if (NF_16BITS_PAGEFLIP && (NF_16BITS_PAGE == 1))
+        return (u16 *)0x06020000;
+
+    return (u16 *)0x06000000;
+}
+
 void NF_InitBitmapBgSys(u8 screen, u8 mode)
 {
     // Setup layer 3 (and optionally layer 2) of the selected screen as a bitmap
@@ -202,38 +1060,24 @@ void NF_Load16bImgData(const char *file, u8 slot, u16 x, u16 y, u8 type)
             NF_Error(106, "16 bit image", NF_SLOTS_BG16B);
     }
 
-    // Free buffer if it is already in use
+    // Free buffers if they are already in use
     free(NF_BG16B[slot].buffer);
     NF_BG16B[slot].buffer = NULL;
+    free(NF_BG16B[slot].mask);
+    NF_BG16B[slot].mask = NULL;
 
-    // Load .IMG file
+    // Load .IMG file (it is decompressed if required)
     char filename[256];
     snprintf(filename, sizeof(filename), "%s/%s.img", NF_ROOTFOLDER, file);
-    FILE *file_id = fopen(filename, "rb");
-    if (file_id == NULL)
-    {
-        // If the file can't be found
-        NF_Error(101, filename, 0);
-    }
-
-    // Get file size
-    fseek(file_id, 0, SEEK_END);
-    u32 size = ftell(file_id);
-    rewind(file_id);
+    char *buffer;
+    u32 size;
+    NF_FileLoad(filename, &buffer, &size, 0);
+    NF_BG16B[slot].buffer = (u16 *)buffer;
 
     // If the size is too big (over 128kb), fail
     if (size > 131072)
         NF_Error(116, filename, 131072);
 
-    // Allocate memory in RAM
-    NF_BG16B[slot].buffer = calloc(size >> 1, sizeof(u16));
-    if (NF_BG16B[slot].buffer == NULL)
-        NF_Error(102, NULL, size); // Not enough free RAM
-
-    // Read file to the RAM
-    fread(NF_BG16B[slot].buffer, 1, size, file_id);
-    fclose(file_id);
-
     // Ensure that the alpha bit is set to 1
     for (u32 n = 0; n < (size >> 1); n++)
         NF_BG16B[slot].buffer[n] |= BIT(15);
@@ -243,6 +1087,85 @@ void NF_Load16bImgData(const char *file, u8 slot, u16 x, u16 y, u8 type)
     NF_BG16B[slot].width = x;
     NF_BG16B[slot].height = y;
     NF_BG16B[slot].inuse = true; // Set slot as being used
+
+    // Find the runs of pixels that aren't magenta
+    NF_Update16bitsImageSpans(slot);
+}
+
+void NF_Update16bitsImageSpans(u8 slot)
+{
+    // Verify that the slot contains data
+    if (!NF_BG16B[slot].inuse)
+        NF_Error(110, "16 Bits Image", slot);
+
+    // Don't read past the end of the buffer if the size is wrong
+    u32 width = NF_BG16B[slot].width;
+    u32 height = NF_BG16B[slot].height;
+    if ((width * height) > (NF_BG16B[slot].size >> 1))
+        height = (NF_BG16B[slot].size >> 1) / width;
+
+    NF_BuildSpans(NF_BG16B[slot].buffer, width, height, 1, 0xFC1F,
+                  &NF_BG16B[slot].spanrows, &NF_BG16B[slot].spans);
+}
+
+void NF_Draw16bitsImageRotScale(u8 screen, u8 slot, s16 x, s16 y, s32 angle,
+                                s32 x_scale, s32 y_scale, bool alpha)
+{
+    // Verify that the slot contains data
+    if (!NF_BG16B[slot].inuse)
+        NF_Error(110, "16 Bits Image", slot);
+
+    if (screen > 1)
+        screen = 1;
+
+    NF_TYPE_BG16B_INFO *img = &NF_BG16B[slot];
+
+    nf_rotscale_info t;
+    if (!NF_RotScaleSetup(&t, img->width, img->height, x, y, angle, x_scale, y_scale))
+        return;
+
+    NF_DirtyAdd(&NF_16BITS_DIRTY[screen], t.x0, t.y0, t.x1 - t.x0 + 1, t.y1 - t.y0 + 1);
+    NF_BlitRotScale(NF_16BITS_BACKBUFFER[screen], img->buffer, img->width,
+                    img->height, &t, 1, alpha, 0xFC1F);
+}
+
+void NF_Draw16bitsImageScaled(u8 screen, u8 slot, s16 x, s16 y, u16 w, u16 h,
+                              bool alpha)
+{
+    // Verify that the slot contains data
+    if (!NF_BG16B[slot].inuse)
+        NF_Error(110, "16 Bits Image", slot);
+
+    if (screen > 1)
+        screen = 1;
+
+    NF_TYPE_BG16B_INFO *img = &NF_BG16B[slot];
+
+    nf_rotscale_info t;
+    if (!NF_ScaledSetup(&t, img->width, img->height, x, y, w, h))
+        return;
+
+    NF_DirtyAdd(&NF_16BITS_DIRTY[screen], x, y, w, h);
+    NF_BlitRotScale(NF_16BITS_BACKBUFFER[screen], img->buffer, img->width,
+                    img->height, &t, 1, alpha, 0xFC1F);
+}
+
+void NF_Load16bitsImageMask(const char *file, u8 slot)
+{
+    // Verify that the slot contains data
+    if (!NF_BG16B[slot].inuse)
+        NF_Error(110, "16 Bits Image", slot);
+
+    free(NF_BG16B[slot].mask);
+    NF_BG16B[slot].mask = NULL;
+
+    // Load .MSK file. If it's too small the rest of the image is transparent.
+    char filename[256];
+    snprintf(filename, sizeof(filename), "%s/%s.msk", NF_ROOTFOLDER, file);
+    char *buffer;
+    u32 size;
+    NF_FileLoad(filename, &buffer, &size, NF_BG16B[slot].width * NF_BG16B[slot].height);
+    NF_BG16B[slot].mask = (u8 *)buffer;
 }
 
 void NF_Unload16bitsBg(u8 slot)
@@ -251,9 +1174,15 @@ void NF_Unload16bitsBg(u8 slot)
     if (!NF_BG16B[slot].inuse)
         NF_Error(110, "16 bit BG", slot);
 
-    // Free the buffer
+    // Free the buffers
     free(NF_BG16B[slot].buffer);
     NF_BG16B[slot].buffer = NULL;
+    free(NF_BG16B[slot].spanrows);
+    NF_BG16B[slot].spanrows = NULL;
+    free(NF_BG16B[slot].spans);
+    NF_BG16B[slot].spans = NULL;
+    free(NF_BG16B[slot].mask);
+    NF_BG16B[slot].mask = NULL;
 
     NF_BG16B[slot].size = 0;
     NF_BG16B[slot].inuse = false; // Mark slot as being free
@@ -267,17 +1196,18 @@ void NF_Copy16bitsBuffer(u8 screen, u8 destination, u8 slot)
 
     if (destination == 0) // Destination is VRAM
     {
-        if (screen == 0)
-            NF_DmaMemCopy((void *)0x06000000, NF_BG16B[slot].buffer, NF_BG16B[slot].size);
-        else
-            NF_DmaMemCopy((void *)0x06200000, NF_BG16B[slot].buffer, NF_BG16B[slot].size);
+        // With page flipping, the page being displayed
+        NF_DmaMemCopy(NF_Get16bitsDisplayedPage(screen), NF_BG16B[slot].buffer,
+                      NF_BG16B[slot].size);
     }
     else // Destination is backbuffer
     {
+        NF_16BITS_DIRTY[screen ? 1 : 0].full = true;
+
         if (screen == 0)
-            memcpy(NF_16BITS_BACKBUFFER[0], NF_BG16B[slot].buffer, NF_BG16B[slot].size);
+            NF_Copy16(NF_16BITS_BACKBUFFER[0], NF_BG16B[slot].buffer, NF_BG16B[slot].size);
         else
-            memcpy(NF_16BITS_BACKBUFFER[1], NF_BG16B[slot].buffer, NF_BG16B[slot].size);
+            NF_Copy16(NF_16BITS_BACKBUFFER[1], NF_BG16B[slot].buffer, NF_BG16B[slot].size);
     }
 }
 
@@ -291,27 +1221,46 @@ void NF_Draw16bitsImage(u8 screen, u8 slot, s16 x, s16 y, bool alpha)
     if (scr > 1)
         scr = 1;
 
-    // The destination is the backbuffer
-    for (int img_y = 0; img_y < NF_BG16B[slot].height; img_y++)
-    {
-        for (int img_x = 0; img_x < NF_BG16B[slot].width; img_x++)
-        {
-            // Location of the destination pixel
-            int buff_x = img_x + x;
-            int buff_y = img_y + y;
+    NF_TYPE_BG16B_INFO *img = &NF_BG16B[slot];
 
-            // Draw it if it's inside the background
-            if ((buff_x >= 0) && (buff_x <= 255) && (buff_y >= 0) && (buff_y <= 255))
-            {
-                u32 buff_idx = (buff_y << 8) + buff_x;
-                u32 data = NF_BG16B[slot].buffer[(img_y * NF_BG16B[slot].width) + img_x];
+    NF_DirtyAdd(&NF_16BITS_DIRTY[scr], x, y, img->width, img->height);
 
-                // Write pixel if it isn't magenta (RGB15(31, 0, 31) | BIT(15))
-                if ((data != 0xFC1F) || (!alpha))
-                    *(NF_16BITS_BACKBUFFER[scr] + buff_idx) = data;
-            }
-        }
-    }
+    // The destination is the backbuffer. Magenta pixels (RGB15(31, 0, 31) |
+    // BIT(15)) are skipped using the runs of opaque pixels.
+    NF_BlitSpans(NF_16BITS_BACKBUFFER[scr], img->buffer, img->width, img->height,
+                 x, y, alpha ? img->spanrows : NULL, img->spans, 1, NULL, NULL);
+}
+
+void NF_Draw16bitsImageBlend(u8 screen, u8 slot, s16 x, s16 y, u8 mode, u8 alpha)
+{
+    // Verify that the slot contains data
+    if (!NF_BG16B[slot].inuse)
+        NF_Error(110, "16 Bits Image", slot);
+
+    if (mode > NF_BLEND_MULTIPLY)
+        NF_Error(106, "Blend mode", NF_BLEND_MULTIPLY);
+
+    if (screen > 1)
+        screen = 1;
+
+    NF_TYPE_BG16B_INFO *img = &NF_BG16B[slot];
+
+    if ((mode == NF_BLEND_MASK) && (img->mask == NULL))
+        NF_Error(110, "16 Bits Image mask", slot);
+
+    nf_blend_info info = {
+        .mode = mode,
+        .alpha = (alpha > 32) ? 32 : alpha,
+        .mask = img->mask,
+        .image = img->buffer,
+    };
+
+    NF_DirtyAdd(&NF_16BITS_DIRTY[screen], x, y, img->width, img->height);
+
+    // Magenta pixels are skipped in all modes
+    NF_BlitSpans(NF_16BITS_BACKBUFFER[screen], img->buffer, img->width,
+                 img->height, x, y, img->spanrows, img->spans, 1,
+                 NF_BlendKernel, &info);
 }
 
 void NF_Init8bitsBgBuffers(void)
@@ -322,6 +1271,8 @@ void NF_Init8bitsBgBuffers(void)
         NF_BG8B[n].pal = NULL;
         NF_BG8B[n].data_size = 0;
         NF_BG8B[n].pal_size = 0;
+        NF_BG8B[n].spanrows = NULL;
+        NF_BG8B[n].spans = NULL;
         NF_BG8B[n].inuse = false;
     }
 }
@@ -333,6 +1284,8 @@ void NF_Reset8bitsBgBuffers(void)
     {
         free(NF_BG8B[n].data);
         free(NF_BG8B[n].pal);
+        free(NF_BG8B[n].spanrows);
+        free(NF_BG8B[n].spans);
     }
 
     // Reset data structures
@@ -354,56 +1307,32 @@ void NF_Load8bitsBg(const char *file, u8 slot)
     // File path
     char filename[256];
 
-    // Load .IMG file
+    // Load .IMG file (it is decompressed if required)
     snprintf(filename, sizeof(filename), "%s/%s.img", NF_ROOTFOLDER, file);
-    FILE *file_id = fopen(filename, "rb");
-    if (file_id == NULL) // If the file doesn't exist
-        NF_Error(101, filename, 0);
-
-    // Get file size
-    fseek(file_id, 0, SEEK_END);
-    u32 size = ftell(file_id);
-    rewind(file_id);
+    char *buffer;
+    u32 size;
+    NF_FileLoad(filename, &buffer, &size, 0);
+    NF_BG8B[slot].data = (u8 *)buffer;
 
     // If it's too big (more than 64 KB), fail
     if (size > 65536)
         NF_Error(116, filename, 65536);
 
-    // Allocate space in RAM
-    NF_BG8B[slot].data = calloc(size, sizeof(u8));
-    if (NF_BG8B[slot].data == NULL) // Not enough memory
-        NF_Error(102, NULL, size);
-
-    // Read file and save it to RAM
-    fread(NF_BG8B[slot].data, 1, size, file_id);
-    fclose(file_id);
-
     NF_BG8B[slot].data_size = size; // Save file size
 
-    // Load .PAL file
-    snprintf(filename, sizeof(filename), "%s/%s.pal", NF_ROOTFOLDER, file);
-    file_id = fopen(filename, "rb");
-    if (file_id == NULL) // If the file doesn't exist
-        NF_Error(101, filename, 0);
+    // Find the runs of pixels that don't use color 0
+    NF_BuildSpans(NF_BG8B[slot].data, 256, size >> 8, 0, 0,
+                  &NF_BG8B[slot].spanrows, &NF_BG8B[slot].spans);
 
-    // Get file size
-    fseek(file_id, 0, SEEK_END);
-    size = ftell(file_id);
-    rewind(file_id);
+    // Load .PAL file (with a minimum size of 512 bytes)
+    snprintf(filename, sizeof(filename), "%s/%s.pal", NF_ROOTFOLDER, file);
+    NF_FileLoad(filename, &buffer, &size, 512);
+    NF_BG8B[slot].pal = (u16 *)buffer;
 
     // If the size is smaller than the maximum size, adjust the size
     if (size < 512)
         size = 512;
 
-    // Allocate space in RAM
-    NF_BG8B[slot].pal = calloc(size >> 1, sizeof(u16));
-    if (NF_BG8B[slot].pal == NULL) // Not enough free RAM
-        NF_Error(102, NULL, size);
-
-    // Read file and save it to RAM
-    fread(NF_BG8B[slot].pal, 1, size, file_id);
-    fclose(file_id);
-
     NF_BG8B[slot].pal_size = size; // Save file size
 
     // Mark this slot as being in use
@@ -423,6 +1352,10 @@ void NF_Unload8bitsBg(u8 slot)
     free(NF_BG8B[slot].pal);
     NF_BG8B[slot].pal = NULL;
     NF_BG8B[slot].pal_size = 0;
+    free(NF_BG8B[slot].spanrows);
+    NF_BG8B[slot].spanrows = NULL;
+    free(NF_BG8B[slot].spans);
+    NF_BG8B[slot].spans = NULL;
 
     NF_BG8B[slot].inuse = false; // Mark slot as free
 }
@@ -461,6 +1394,7 @@ void NF_Copy8bitsBuffer(u8 screen, u8 destination, u8 slot)
     else
     {
         // Copy data to backbuffer
+        NF_DirtyReset(&NF_8BITS_DIRTY[screen], true);
         memcpy(NF_8BITS_BACKBUFFER[screen].data, NF_BG8B[slot].data,
                NF_BG8B[slot].data_size);
         memcpy(NF_8BITS_BACKBUFFER[screen].pal, NF_BG8B[slot].pal,
@@ -468,6 +1402,68 @@ void NF_Copy8bitsBuffer(u8 screen, u8 destination, u8 slot)
     }
 }
 
+void NF_Draw8bitsImage(u8 screen, u8 slot, s16 x, s16 y, bool alpha)
+{
+    // Verify that the slot contains data
+    if (!NF_BG8B[slot].inuse)
+        NF_Error(110, "8 Bits Bg", slot);
+
+    if (screen > 1)
+        screen = 1;
+
+    NF_TYPE_BG8B_INFO *img = &NF_BG8B[slot];
+
+    NF_DirtyAdd(&NF_8BITS_DIRTY[screen], x, y, 256, img->data_size >> 8);
+
+    NF_BlitSpans(NF_8BITS_BACKBUFFER[screen].data, img->data, 256,
+                 img->data_size >> 8, x, y, alpha ? img->spanrows : NULL,
+                 img->spans, 0, NULL, NULL);
+}
+
+void NF_Draw8bitsImageRotScale(u8 screen, u8 slot, s16 x, s16 y, s32 angle,
+                               s32 x_scale, s32 y_scale, bool alpha)
+{
+    // Verify that the slot contains data
+    if (!NF_BG8B[slot].inuse)
+        NF_Error(110, "8 Bits Bg", slot);
+
+    if (screen > 1)
+        screen = 1;
+
+    NF_TYPE_BG8B_INFO *img = &NF_BG8B[slot];
+    u32 height = img->data_size >> 8;
+
+    nf_rotscale_info t;
+    if (!NF_RotScaleSetup(&t, 256, height, x, y, angle, x_scale, y_scale))
+        return;
+
+    NF_DirtyAdd(&NF_8BITS_DIRTY[screen], t.x0, t.y0, t.x1 - t.x0 + 1, t.y1 - t.y0 + 1);
+    NF_BlitRotScale(NF_8BITS_BACKBUFFER[screen].data, img->data, 256, height,
+                    &t, 0, alpha, 0);
+}
+
+void NF_Draw8bitsImageScaled(u8 screen, u8 slot, s16 x, s16 y, u16 w, u16 h,
+                             bool alpha)
+{
+    // Verify that the slot contains data
+    if (!NF_BG8B[slot].inuse)
+        NF_Error(110, "8 Bits Bg", slot);
+
+    if (screen > 1)
+        screen = 1;
+
+    NF_TYPE_BG8B_INFO *img = &NF_BG8B[slot];
+    u32 height = img->data_size >> 8;
+
+    nf_rotscale_info t;
+    if (!NF_ScaledSetup(&t, 256, height, x, y, w, h))
+        return;
+
+    NF_DirtyAdd(&NF_8BITS_DIRTY[screen], x, y, w, h);
+    NF_BlitRotScale(NF_8BITS_BACKBUFFER[screen].data, img->data, 256, height,
+                    &t, 0, alpha, 0);
+}
+
 void NF_Init8bitsBackBuffer(u8 screen)
 {
     if (screen > 1)
@@ -475,6 +1471,7 @@ void NF_Init8bitsBackBuffer(u8 screen)
 
     NF_8BITS_BACKBUFFER[screen].data = NULL;
     NF_8BITS_BACKBUFFER[screen].pal = NULL;
+    NF_DirtyReset(&NF_8BITS_DIRTY[screen], false);
 }
 
 void NF_Enable8bitsBackBuffer(u8 screen)
@@ -497,6 +1494,8 @@ void NF_Enable8bitsBackBuffer(u8 screen)
     NF_8BITS_BACKBUFFER[screen].pal = calloc(256, sizeof(u16));
     if (NF_8BITS_BACKBUFFER[screen].pal == NULL)
         NF_Error(102, NULL, 512);
+
+    NF_DirtyReset(&NF_8BITS_DIRTY[screen], true);
 }
 
 void NF_Disble8bitsBackBuffer(u8 screen)
@@ -536,4 +1535,50 @@ void NF_Flip8bitsBackBuffer(u8 screen, u8 destination)
 
     NF_DmaMemCopy((void *)data, NF_8BITS_BACKBUFFER[screen].data, 65536);
     NF_DmaMemCopy((void *)pal, NF_8BITS_BACKBUFFER[screen].pal, 512);
+
+    NF_DirtyReset(&NF_8BITS_DIRTY[screen], false);
+}
+
+void NF_Mark8bitsBackBufferDirty(u8 screen, s16 x, s16 y, u16 w, u16 h)
+{
+    if (screen > 1)
+        screen = 1;
+
+    NF_DirtyAdd(&NF_8BITS_DIRTY[screen], x, y, w, h);
+}
+
+void NF_Mark8bitsBackBufferPalDirty(u8 screen)
+{
+    if (screen > 1)
+        screen = 1;
+
+    NF_8BITS_DIRTY[screen].pal = true;
+}
+
+void NF_Flip8bitsBackBufferDirty(u8 screen, u8 destination)
+{
+    if (screen > 1)
+        screen = 1;
+
+    nf_dirty_info *dirty = &NF_8BITS_DIRTY[screen];
+
+    if (NF_DirtyIsFull(dirty))
+    {
+        NF_Flip8bitsBackBuffer(screen, destination);
+        return;
+    }
+
+    u32 data = (screen == 0) ? 0x06000000 : 0x06200000;
+    if (destination == 1)
+        data += 65536;
+
+    NF_DirtyCopy(dirty, data, NF_8BITS_BACKBUFFER[screen].data, 0);
+
+    if (dirty->pal)
+    {
+        u32 pal = (screen == 0) ? 0x05000000 : 0x05000400;
+        NF_DmaMemCopy((void *)pal, NF_8BITS_BACKBUFFER[screen].pal, 512);
+    }
+
+    NF_DirtyReset(dirty, false);
 }
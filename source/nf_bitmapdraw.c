@@ -0,0 +1,436 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright (c) 2009-2014 Cesar Rincon "NightFox"
+//
+// NightFox LIB - Funciones de dibujo en fondos Bitmap
+// http://www.nightfoxandco.com/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <nds.h>
+
+#include "nf_bitmapbg.h"
+#include "nf_bitmapdraw.h"
+
+// Backbuffer being drawn. Pixels are (1 << shift) bytes long.
+typedef struct {
+    void *data;
+    u32 shift;
+    u8 screen;
+    u32 color;
+} nf_draw_target;
+
+static nf_draw_target NF_DrawTarget16(u8 screen, u16 color)
+{
+    if (screen > 1)
+        screen = 1;
+
+    nf_draw_target t = { NF_16BITS_BACKBUFFER[screen], 1, screen, color };
+    return t;
+}
+
+static nf_draw_target NF_DrawTarget8(u8 screen, u8 color)
+{
+    if (screen > 1)
+        screen = 1;
+
+    nf_draw_target t = { NF_8BITS_BACKBUFFER[screen].data, 0, screen, color };
+    return t;
+}
+
+// Marks the area (x0, y0) - (x1, y1), both included, as dirty
+static void NF_DrawMark(const nf_draw_target *t, s32 x0, s32 y0, s32 x1, s32 y1)
+{
+    // Clip it here, the coordinates may not fit in the arguments
+    if (x0 < 0)
+        x0 = 0;
+    if (y0 < 0)
+        y0 = 0;
+    if (x1 > 255)
+        x1 = 255;
+    if (y1 > 255)
+        y1 = 255;
+    if ((x0 > x1) || (y0 > y1))
+        return;
+
+    if (t->shift == 0)
+        NF_Mark8bitsBackBufferDirty(t->screen, x0, y0, x1 - x0 + 1, y1 - y0 + 1);
+    else
+        NF_Mark16bitsBackBufferDirty(t->screen, x0, y0, x1 - x0 + 1, y1 - y0 + 1);
+}
+
+// Fills a block of memory with 32-bit values using DMA
+static void NF_DrawDmaFill(void *dst, u32 value, u32 size)
+{
+    // Write back any cached data first so that it doesn't overwrite the values
+    // written by the DMA later, and drop the stale lines afterwards.
+    DC_FlushRange(dst, size);
+
+    // NF_DmaMemCopyAsync() may be using channel 3, and the VBlank interrupt may
+    // use it too (NF_FlushVramQueue()). Interrupts are disabled while the
+    // registers are set so that it can't change them halfway. This does the
+    // same as dmaFillWords() without waiting with interrupts disabled.
+    u32 ime = REG_IME;
+    REG_IME = 0;
+
+    while (dmaBusy(3));
+
+    DMA_FILL(3) = value;
+    DMA_SRC(3) = (u32)&DMA_FILL(3);
+    DMA_DEST(3) = (u32)dst;
+    DMA_CR(3) = DMA_SRC_FIX | DMA_COPY_WORDS | (size >> 2);
+
+    REG_IME = ime;
+
+    while (dmaBusy(3));
+
+    DC_InvalidateRange(dst, size);
+}
+
+// Fills "count" pixels starting at "offset" (in pixels) of the backbuffer
+static void NF_DrawFill(const nf_draw_target *t, u32 offset, u32 count)
+{
+    if (t->shift == 0)
+    {
+        u8 *dst = (u8 *)t->data + offset;
+
+        if ((count >= NF_BITMAPDRAW_DMA_MIN) && ((((u32)dst) | count) & 3) == 0)
+            NF_DrawDmaFill(dst, t->color * 0x01010101, count);
+        else
+            memset(dst, t->color, count);
+
+        return;
+    }
+
+    u16 *dst = (u16 *)t->data + offset;
+
+    // Align the destination to 32 bits
+    if ((((u32)dst) & 2) && (count > 0))
+    {
+        *dst++ = t->color;
+        count--;
+    }
+
+    // Write pairs of pixels
+    u32 pair = t->color | (t->color << 16);
+    u32 words = count >> 1;
+    u32 *dst32 = (u32 *)dst;
+
+    if ((words << 2) >= NF_BITMAPDRAW_DMA_MIN)
+    {
+        NF_DrawDmaFill(dst32, pair, words << 2);
+        dst32 += words;
+    }
+    else
+    {
+        while (words >= 4)
+        {
+            dst32[0] = pair;
+            dst32[1] = pair;
+            dst32[2] = pair;
+            dst32[3] = pair;
+            dst32 += 4;
+            words -= 4;
+        }
+        while (words > 0)
+        {
+            *dst32++ = pair;
+            words--;
+        }
+    }
+
+    if (count & 1)
+        *(u16 *)dst32 = t->color;
+}
+
+// Draws a horizontal span from x0 to x1 (both included), clipped
+static void NF_DrawSpan(const nf_draw_target *t, s32 x0, s32 x1, s32 y)
+{
+    if ((y < 0) || (y > 255))
+        return;
+
+    if (x0 < 0)
+        x0 = 0;
+    if (x1 > 255)
+        x1 = 255;
+    if (x0 > x1)
+        return;
+
+    NF_DrawFill(t, (y << 8) + x0, x1 - x0 + 1);
+}
+
+// Draws a single pixel, clipped
+static inline void NF_DrawPixel(const nf_draw_target *t, s32 x, s32 y)
+{
+    if (((u32)x > 255) || ((u32)y > 255))
+        return;
+
+    if (t->shift == 0)
+        ((u8 *)t->data)[(y << 8) + x] = t->color;
+    else
+        ((u16 *)t->data)[(y << 8) + x] = t->color;
+}
+
+static void NF_DrawVLine(const nf_draw_target *t, s32 x, s32 y, s32 h)
+{
+    if ((x < 0) || (x > 255) || (h <= 0))
+        return;
+
+    s32 y0 = (y < 0) ? 0 : y;
+    s32 y1 = ((y + h) > 256) ? 256 : (y + h);
+
+    if (t->shift == 0)
+    {
+        u8 *dst = (u8 *)t->data + (y0 << 8) + x;
+        for (s32 row = y0; row < y1; row++, dst += 256)
+            *dst = t->color;
+    }
+    else
+    {
+        u16 *dst = (u16 *)t->data + (y0 << 8) + x;
+        for (s32 row = y0; row < y1; row++, dst += 256)
+            *dst = t->color;
+    }
+
+    NF_DrawMark(t, x, y0, x, y1 - 1);
+}
+
+static void NF_DrawRect(const nf_draw_target *t, s32 x, s32 y, s32 w, s32 h)
+{
+    s32 x0 = (x < 0) ? 0 : x;
+    s32 y0 = (y < 0) ? 0 : y;
+    s32 x1 = ((x + w) > 256) ? 256 : (x + w);
+    s32 y1 = ((y + h) > 256) ? 256 : (y + h);
+
+    if ((x0 >= x1) || (y0 >= y1))
+        return;
+
+    if ((x1 - x0) == 256)
+    {
+        // Full rows are a single block
+        NF_DrawFill(t, y0 << 8, (y1 - y0) << 8);
+    }
+    else
+    {
+        for (s32 row = y0; row < y1; row++)
+            NF_DrawFill(t, (row << 8) + x0, x1 - x0);
+    }
+
+    NF_DrawMark(t, x0, y0, x1 - 1, y1 - 1);
+}
+
+static void NF_DrawLine(const nf_draw_target *t, s32 x1, s32 y1, s32 x2, s32 y2)
+{
+    // Horizontal and vertical lines are spans
+    if (y1 == y2)
+    {
+        s32 x0 = (x1 < x2) ? x1 : x2;
+        s32 w = abs(x2 - x1) + 1;
+        NF_DrawRect(t, x0, y1, w, 1);
+        return;
+    }
+    if (x1 == x2)
+    {
+        NF_DrawVLine(t, x1, (y1 < y2) ? y1 : y2, abs(y2 - y1) + 1);
+        return;
+    }
+
+    // Bresenham's algorithm
+    s32 dx = abs(x2 - x1);
+    s32 dy = -abs(y2 - y1);
+    s32 sx = (x1 < x2) ? 1 : -1;
+    s32 sy = (y1 < y2) ? 1 : -1;
+    s32 err = dx + dy;
+    s32 x = x1;
+    s32 y = y1;
+
+    while (1)
+    {
+        NF_DrawPixel(t, x, y);
+
+        if ((x == x2) && (y == y2))
+            break;
+
+        s32 e2 = err << 1;
+        if (e2 >= dy)
+        {
+            err += dy;
+            x += sx;
+        }
+        if (e2 <= dx)
+        {
+            err += dx;
+            y += sy;
+        }
+    }
+
+    NF_DrawMark(t, (x1 < x2) ? x1 : x2, (y1 < y2) ? y1 : y2,
+                (x1 > x2) ? x1 : x2, (y1 > y2) ? y1 : y2);
+}
+
+static void NF_DrawCircle(const nf_draw_target *t, s32 cx, s32 cy, s32 radius,
+                          bool fill)
+{
+    // Midpoint circle algorithm. It walks one octant: (px, py) goes from
+    // (radius, 0) to the diagonal.
+    s32 px = radius;
+    s32 py = 0;
+    s32 err = 1 - radius;
+
+    while (px >= py)
+    {
+        if (fill)
+        {
+            // Rows cy +/- py are drawn once per step
+            NF_DrawSpan(t, cx - px, cx + px, cy + py);
+            if (py != 0)
+                NF_DrawSpan(t, cx - px, cx + px, cy - py);
+
+            // Rows cy +/- px are drawn once, when they are as wide as they get
+            if ((err >= 0) && (px != py))
+            {
+                NF_DrawSpan(t, cx - py, cx + py, cy + px);
+                NF_DrawSpan(t, cx - py, cx + py, cy - px);
+            }
+        }
+        else
+        {
+            NF_DrawPixel(t, cx + px, cy + py);
+            NF_DrawPixel(t, cx - px, cy + py);
+            NF_DrawPixel(t, cx + px, cy - py);
+            NF_DrawPixel(t, cx - px, cy - py);
+            NF_DrawPixel(t, cx + py, cy + px);
+            NF_DrawPixel(t, cx - py, cy + px);
+            NF_DrawPixel(t, cx + py, cy - px);
+            NF_DrawPixel(t, cx - py, cy - px);
+        }
+
+        py++;
+        if (err < 0)
+        {
+            err += (py << 1) + 1;
+        }
+        else
+        {
+            px--;
+            err += ((py - px) << 1) + 1;
+        }
+    }
+
+    NF_DrawMark(t, cx - radius, cy - radius, cx + radius, cy + radius);
+}
+
+// Draws an image of palette indices. If "pal" is NULL the indices are copied.
+static void NF_DrawSprite(const nf_draw_target *t, const u8 *data, const u16 *pal,
+                          s32 x, s32 y, s32 w, s32 h)
+{
+    // Visible part of the image, in image coordinates
+    s32 sx0 = (x < 0) ? -x : 0;
+    s32 sy0 = (y < 0) ? -y : 0;
+    s32 sx1 = ((x + w) > 256) ? (256 - x) : w;
+    s32 sy1 = ((y + h) > 256) ? (256 - y) : h;
+
+    if ((sx0 >= sx1) || (sy0 >= sy1))
+        return;
+
+    for (s32 row = sy0; row < sy1; row++)
+    {
+        const u8 *src = data + (row * w);
+        u32 offset = ((y + row) << 8) + x;
+
+        if (pal == NULL)
+        {
+            u8 *dst = (u8 *)t->data + offset;
+            for (s32 col = sx0; col < sx1; col++)
+            {
+                if (src[col] != 0)
+                    dst[col] = src[col];
+            }
+        }
+        else
+        {
+            u16 *dst = (u16 *)t->data + offset;
+            for (s32 col = sx0; col < sx1; col++)
+            {
+                if (src[col] != 0)
+                    dst[col] = pal[src[col]] | BIT(15);
+            }
+        }
+    }
+
+    NF_DrawMark(t, x + sx0, y + sy0, x + sx1 - 1, y + sy1 - 1);
+}
+
+void NF_Draw16bitsHLine(u8 screen, s16 x, s16 y, u16 w, u16 color)
+{
+    nf_draw_target t = NF_DrawTarget16(screen, color);
+    NF_DrawRect(&t, x, y, w, 1);
+}
+
+void NF_Draw16bitsVLine(u8 screen, s16 x, s16 y, u16 h, u16 color)
+{
+    nf_draw_target t = NF_DrawTarget16(screen, color);
+    NF_DrawVLine(&t, x, y, h);
+}
+
+void NF_Fill16bitsRect(u8 screen, s16 x, s16 y, u16 w, u16 h, u16 color)
+{
+    nf_draw_target t = NF_DrawTarget16(screen, color);
+    NF_DrawRect(&t, x, y, w, h);
+}
+
+void NF_Draw16bitsLine(u8 screen, s16 x1, s16 y1, s16 x2, s16 y2, u16 color)
+{
+    nf_draw_target t = NF_DrawTarget16(screen, color);
+    NF_DrawLine(&t, x1, y1, x2, y2);
+}
+
+void NF_Draw16bitsCircle(u8 screen, s16 x, s16 y, u16 radius, u16 color, bool fill)
+{
+    nf_draw_target t = NF_DrawTarget16(screen, color);
+    NF_DrawCircle(&t, x, y, radius, fill);
+}
+
+void NF_Draw16bitsSprite(u8 screen, const u8 *data, const u16 *pal, s16 x, s16 y,
+                         u16 w, u16 h)
+{
+    nf_draw_target t = NF_DrawTarget16(screen, 0);
+    NF_DrawSprite(&t, data, pal, x, y, w, h);
+}
+
+void NF_Draw8bitsHLine(u8 screen, s16 x, s16 y, u16 w, u8 color)
+{
+    nf_draw_target t = NF_DrawTarget8(screen, color);
+    NF_DrawRect(&t, x, y, w, 1);
+}
+
+void NF_Draw8bitsVLine(u8 screen, s16 x, s16 y, u16 h, u8 color)
+{
+    nf_draw_target t = NF_DrawTarget8(screen, color);
+    NF_DrawVLine(&t, x, y, h);
+}
+
+void NF_Fill8bitsRect(u8 screen, s16 x, s16 y, u16 w, u16 h, u8 color)
+{
+    nf_draw_target t = NF_DrawTarget8(screen, color);
+    NF_DrawRect(&t, x, y, w, h);
+}
+
+void NF_Draw8bitsLine(u8 screen, s16 x1, s16 y1, s16 x2, s16 y2, u8 color)
+{
+    nf_draw_target t = NF_DrawTarget8(screen, color);
+    NF_DrawLine(&t, x1, y1, x2, y2);
+}
+
+void NF_Draw8bitsCircle(u8 screen, s16 x, s16 y, u16 radius, u8 color, bool fill)
+{
+    nf_draw_target t = NF_DrawTarget8(screen, color);
+    NF_DrawCircle(&t, x, y, radius, fill);
+}
+
+void NF_Draw8bitsSprite(u8 screen, const u8 *data, s16 x, s16 y, u16 w, u16 h)
+{
+    nf_draw_target t = NF_DrawTarget8(screen, 0);
+    NF_DrawSprite(&t, data, NULL, x, y, w, h);
+}
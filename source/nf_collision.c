@@ -54,31 +54,12 @@ void NF_LoadCollisionMap(const char* file, u8 id, u16 width, u16 height) {
 	free(NF_CMAP[id].map);
 	NF_CMAP[id].map = NULL;
 
-	// Declara los punteros a los ficheros
-	FILE* file_id;
-
 	// Variable para almacenar el path al archivo
 	char filename[256];
 
-	// Carga el archivo .CMP
+	// Carga el archivo .CMP (si esta comprimido, se descomprime)
 	snprintf(filename, sizeof(filename), "%s/%s.cmp", NF_ROOTFOLDER, file);
-	file_id = fopen(filename, "rb");
-	if (file_id) {	// Si el archivo existe...
-		// Obten el tamaño del archivo
-		fseek(file_id, 0, SEEK_END);
-		NF_CMAP[id].map_size = ftell(file_id);
-		rewind(file_id);
-		// Reserva el espacio en RAM
-		NF_CMAP[id].map = (char*) calloc (NF_CMAP[id].map_size, sizeof(char));
-		if (NF_CMAP[id].map == NULL) {		// Si no hay suficiente RAM libre
-			NF_Error(102, NULL, NF_CMAP[id].map_size);
-		}
-		// Lee el archivo y ponlo en la RAM
-		fread(NF_CMAP[id].map, 1, NF_CMAP[id].map_size, file_id);
-	} else {	// Si el archivo no existe...
-		NF_Error(101, filename, 0);
-	}
-	fclose(file_id);		// Cierra el archivo
+	NF_FileLoad(filename, &NF_CMAP[id].map, &NF_CMAP[id].map_size, 0);
 
 	// Guarda las medidas
 	NF_CMAP[id].width = width;
@@ -203,51 +184,16 @@ void NF_LoadCollisionBg(const char* file, u8 id, u16 width, u16 height) {
 	free(NF_CMAP[id].map);
 	NF_CMAP[id].map = NULL;
 
-	// Declara los punteros a los ficheros
-	FILE* file_id;
-
 	// Variable para almacenar el path al archivo
 	char filename[256];
 
-	// Carga el archivo .DAT (TILES)
-	snprintf(filename, sizeof(filename),  "%s/%s.dat", NF_ROOTFOLDER, file);
-	file_id = fopen(filename, "rb");
-	if (file_id) {	// Si el archivo existe...
-		// Obten el tamaño del archivo
-		fseek(file_id, 0, SEEK_END);
-		NF_CMAP[id].tiles_size = ftell(file_id);
-		rewind(file_id);
-		// Reserva el espacio en RAM
-		NF_CMAP[id].tiles = (char*) calloc (NF_CMAP[id].tiles_size, sizeof(char));
-		if (NF_CMAP[id].tiles == NULL) {		// Si no hay suficiente RAM libre
-			NF_Error(102, NULL, NF_CMAP[id].tiles_size);
-		}
-		// Lee el archivo y ponlo en la RAM
-		fread(NF_CMAP[id].tiles, 1, NF_CMAP[id].tiles_size, file_id);
-	} else {	// Si el archivo no existe...
-		NF_Error(101, filename, 0);
-	}
-	fclose(file_id);		// Cierra el archivo
+	// Carga el archivo .DAT (TILES) (si esta comprimido, se descomprime)
+	snprintf(filename, sizeof(filename), "%s/%s.dat", NF_ROOTFOLDER, file);
+	NF_FileLoad(filename, &NF_CMAP[id].tiles, &NF_CMAP[id].tiles_size, 0);
 
-	// Carga el archivo .CMP
+	// Carga el archivo .CMP (si esta comprimido, se descomprime)
 	snprintf(filename, sizeof(filename), "%s/%s.cmp", NF_ROOTFOLDER, file);
-	file_id = fopen(filename, "rb");
-	if (file_id) {	// Si el archivo existe...
-		// Obten el tamaño del archivo
-		fseek(file_id, 0, SEEK_END);
-		NF_CMAP[id].map_size = ftell(file_id);
-		rewind(file_id);
-		// Reserva el espacio en RAM
-		NF_CMAP[id].map = (char*) calloc (NF_CMAP[id].map_size, sizeof(char));
-		if (NF_CMAP[id].map == NULL) {		// Si no hay suficiente RAM libre
-			NF_Error(102, NULL, NF_CMAP[id].map_size);
-		}
-		// Lee el archivo y ponlo en la RAM
-		fread(NF_CMAP[id].map, 1, NF_CMAP[id].map_size, file_id);
-	} else {	// Si el archivo no existe...
-		NF_Error(101, filename, 0);
-	}
-	fclose(file_id);		// Cierra el archivo
+	NF_FileLoad(filename, &NF_CMAP[id].map, &NF_CMAP[id].map_size, 0);
 
 	// Guarda las medidas
 	NF_CMAP[id].width = width;
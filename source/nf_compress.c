@@ -0,0 +1,380 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright (c) 2009-2014 Cesar Rincon "NightFox"
+//
+// NightFox LIB - Funciones de descompresion
+// http://www.nightfoxandco.com/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <nds.h>
+
+#include "nf_basic.h"
+#include "nf_compress.h"
+
+// Maximum decompressed size accepted. Anything bigger can't fit in main RAM, so
+// it must be an uncompressed file that starts with a valid compression type.
+#define NF_COMPRESS_MAX_SIZE (4 * 1024 * 1024)
+
+// Maximum number of padding bytes allowed after the compressed data. Encoders
+// pad the data to a multiple of 4 bytes.
+#define NF_COMPRESS_MAX_PADDING 3
+
+// Output of the decompressors. When writing to VRAM, bytes are written in
+// pairs, so the last byte of an odd number of bytes is kept in "pending". If
+// "data" is NULL nothing is written, the data is only validated.
+typedef struct {
+    u8 *data;
+    u32 pos;
+    u32 size;
+    bool vram;
+    u8 pending;
+} nf_output;
+
+static inline void NF_OutputByte(nf_output *out, u8 value)
+{
+    if (out->data == NULL)
+    {
+        // Validation only
+    }
+    else if (!out->vram)
+    {
+        out->data[out->pos] = value;
+    }
+    else if (out->pos & 1)
+    {
+        *(vu16 *)(out->data + out->pos - 1) = out->pending | (value << 8);
+    }
+    else
+    {
+        out->pending = value;
+    }
+
+    out->pos++;
+}
+
+static inline u8 NF_OutputRead(const nf_output *out, u32 pos)
+{
+    if (out->data == NULL)
+        return 0;
+
+    // The last byte may not have been written to VRAM yet
+    if (out->vram && (pos == (out->pos - 1)) && (out->pos & 1))
+        return out->pending;
+
+    return out->data[pos];
+}
+
+static void NF_OutputEnd(nf_output *out)
+{
+    // Write the last byte of VRAM output, keeping the byte after it
+    if ((out->data != NULL) && out->vram && (out->pos & 1))
+    {
+        vu16 *last = (vu16 *)(out->data + out->pos - 1);
+        *last = (*last & 0xFF00) | out->pending;
+    }
+}
+
+static bool NF_DecompressLZ(const u8 *src, u32 size, nf_output *out, bool lz11)
+{
+    u32 in = 4;
+
+    while (out->pos < out->size)
+    {
+        if (in >= size)
+            return false;
+
+        u8 flags = src[in++];
+
+        for (int i = 0; (i < 8) && (out->pos < out->size); i++, flags <<= 1)
+        {
+            if (!(flags & 0x80))
+            {
+                // Uncompressed byte
+                if (in >= size)
+                    return false;
+                NF_OutputByte(out, src[in++]);
+                continue;
+            }
+
+            // Reference to previous data
+            u32 length, disp;
+
+            if (in + 1 >= size)
+                return false;
+
+            if (!lz11)
+            {
+                length = (src[in] >> 4) + 3;
+                disp = (((src[in] & 0xF) << 8) | src[in + 1]) + 1;
+                in += 2;
+            }
+            else
+            {
+                u32 indicator = src[in] >> 4;
+
+                if (indicator == 0)
+                {
+                    // 8-bit length
+                    if (in + 2 >= size)
+                        return false;
+                    length = (((src[in] & 0xF) << 4) | (src[in + 1] >> 4)) + 0x11;
+                    disp = (((src[in + 1] & 0xF) << 8) | src[in + 2]) + 1;
+                    in += 3;
+                }
+                else if (indicator == 1)
+                {
+                    // 16-bit length
+                    if (in + 3 >= size)
+                        return false;
+                    length = (((src[in] & 0xF) << 12) | (src[in + 1] << 4)
+                             | (src[in + 2] >> 4)) + 0x111;
+                    disp = (((src[in + 2] & 0xF) << 8) | src[in + 3]) + 1;
+                    in += 4;
+                }
+                else
+                {
+                    // 4-bit length
+                    length = indicator + 1;
+                    disp = (((src[in] & 0xF) << 8) | src[in + 1]) + 1;
+                    in += 2;
+                }
+            }
+
+            if (disp > out->pos)
+                return false;
+
+            if (length > (out->size - out->pos))
+                length = out->size - out->pos;
+
+            for (u32 n = 0; n < length; n++)
+                NF_OutputByte(out, NF_OutputRead(out, out->pos - disp));
+        }
+    }
+
+    // All the input must have been used
+    return (size - in) <= NF_COMPRESS_MAX_PADDING;
+}
+
+static bool NF_DecompressRLE(const u8 *src, u32 size, nf_output *out)
+{
+    u32 in = 4;
+
+    while (out->pos < out->size)
+    {
+        if (in >= size)
+            return false;
+
+        u8 flag = src[in++];
+
+        if (flag & 0x80)
+        {
+            // Run of the same byte
+            u32 length = (flag & 0x7F) + 3;
+            if (in >= size)
+                return false;
+            u8 value = src[in++];
+
+            for (u32 n = 0; (n < length) && (out->pos < out->size); n++)
+                NF_OutputByte(out, value);
+        }
+        else
+        {
+            // Uncompressed bytes
+            u32 length = (flag & 0x7F) + 1;
+            if ((in + length) > size)
+                return false;
+
+            for (u32 n = 0; (n < length) && (out->pos < out->size); n++)
+                NF_OutputByte(out, src[in++]);
+        }
+    }
+
+    // All the input must have been used
+    return (size - in) <= NF_COMPRESS_MAX_PADDING;
+}
+
+static bool NF_DecompressHuffman(const u8 *src, u32 size, nf_output *out)
+{
+    u32 bits = src[0] & 0xF;        // Bits per symbol (4 or 8)
+    u32 tree_end = 4 + ((src[4] + 1) << 1);
+
+    if (tree_end > size)
+        return false;
+
+    u32 in = tree_end;              // Next word of the bitstream
+    u32 word = 0;                   // Current word of the bitstream
+    u32 word_bits = 0;              // Bits left in the current word
+    u32 node = 5;                   // Current node (starts at the root)
+    u32 symbol = 0;                 // Symbols of 4 bits are joined in pairs
+    u32 symbol_bits = 0;
+
+    while (out->pos < out->size)
+    {
+        if (word_bits == 0)
+        {
+            if ((in + 4) > size)
+                return false;
+            word = src[in] | (src[in + 1] << 8) | (src[in + 2] << 16)
+                 | ((u32)src[in + 3] << 24);
+            in += 4;
+            word_bits = 32;
+        }
+
+        u32 bit = word >> 31;
+        word <<= 1;
+        word_bits--;
+
+        // Move to the child node selected by the bit
+        u8 value = src[node];
+        u32 child = (node & ~1) + ((value & 0x3F) << 1) + 2 + bit;
+        if (child >= tree_end)
+            return false;
+
+        if (!(value & (0x80 >> bit)))
+        {
+            node = child;
+            continue;
+        }
+
+        // The child is a data node
+        symbol |= src[child] << symbol_bits;
+        symbol_bits += bits;
+        node = 5;
+
+        if (symbol_bits >= 8)
+        {
+            NF_OutputByte(out, symbol & 0xFF);
+            symbol = 0;
+            symbol_bits = 0;
+        }
+    }
+
+    // All the input must have been used
+    return (size - in) <= NF_COMPRESS_MAX_PADDING;
+}
+
+u32 NF_GetDecompressedSize(const void *source, u32 size)
+{
+    const u8 *src = source;
+
+    if (size < 4)
+        return 0;
+
+    // Maximum ratio between the decompressed data and the compressed data that
+    // each format can achieve, without counting the header.
+    u32 ratio;
+
+    switch (src[0])
+    {
+        case NF_COMPRESS_LZ77:
+            ratio = 9;      // 17 bytes for 8 references of 18 bytes
+            break;
+        case NF_COMPRESS_LZ11:
+            ratio = 16384;  // 33 bytes for 8 references of 65808 bytes
+            break;
+        case NF_COMPRESS_HUFF4:
+            ratio = 4;      // 1 bit per symbol, 2 symbols per byte
+            break;
+        case NF_COMPRESS_HUFF8:
+            ratio = 8;      // 1 bit per symbol
+            break;
+        case NF_COMPRESS_RLE:
+            ratio = 65;     // 2 bytes for a run of 130 bytes
+            break;
+        default:
+            return 0;
+    }
+
+    u32 out_size = src[1] | (src[2] << 8) | (src[3] << 16);
+    if ((out_size == 0) || (out_size > NF_COMPRESS_MAX_SIZE))
+        return 0;
+
+    // Uncompressed files that start with a compression type usually announce
+    // sizes that the rest of the file can't produce.
+    if ((size - 4) < ((out_size + ratio - 1) / ratio))
+        return 0;
+
+    return out_size;
+}
+
+static bool NF_DecompressData(const void *source, u32 size, nf_output *out)
+{
+    const u8 *src = source;
+
+    out->pos = 0;
+    out->size = NF_GetDecompressedSize(source, size);
+    if (out->size == 0)
+        return false;
+
+    bool ok = false;
+
+    switch (src[0])
+    {
+        case NF_COMPRESS_LZ77:
+            ok = NF_DecompressLZ(src, size, out, false);
+            break;
+        case NF_COMPRESS_LZ11:
+            ok = NF_DecompressLZ(src, size, out, true);
+            break;
+        case NF_COMPRESS_HUFF4:
+        case NF_COMPRESS_HUFF8:
+            ok = NF_DecompressHuffman(src, size, out);
+            break;
+        case NF_COMPRESS_RLE:
+            ok = NF_DecompressRLE(src, size, out);
+            break;
+    }
+
+    NF_OutputEnd(out);
+
+    return ok;
+}
+
+bool NF_Decompress(const void *source, u32 size, void *destination)
+{
+    nf_output out = { .data = destination, .vram = false };
+    return NF_DecompressData(source, size, &out);
+}
+
+bool NF_CheckCompressed(const void *source, u32 size)
+{
+    nf_output out = { .data = NULL, .vram = false };
+    return NF_DecompressData(source, size, &out);
+}
+
+bool NF_DecompressToVram(const void *source, u32 size, void *destination)
+{
+    // Check the data before writing anything, VRAM after the destination may
+    // be in use.
+    if (!NF_CheckCompressed(source, size))
+        return false;
+
+    nf_output out = { .data = destination, .vram = true };
+    return NF_DecompressData(source, size, &out);
+}
+
+u32 NF_LoadFileToVram(const char *file, void *destination)
+{
+    char filename[256];
+    snprintf(filename, sizeof(filename), "%s/%s", NF_ROOTFOLDER, file);
+
+    // Load the file as it is, without decompressing it
+    char *buffer = NULL;
+    u32 size = 0;
+    NF_FileLoadRaw(filename, &buffer, &size);
+
+    u32 out_size = NF_GetDecompressedSize(buffer, size);
+    if ((out_size == 0) || !NF_DecompressToVram(buffer, size, destination))
+    {
+        // It isn't compressed
+        out_size = size;
+        NF_DmaMemCopy(destination, buffer, size);
+    }
+
+    free(buffer);
+
+    return out_size;
+}
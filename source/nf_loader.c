@@ -0,0 +1,231 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright (c) 2009-2014 Cesar Rincon "NightFox"
+//
+// NightFox LIB - Funciones de carga incremental
+// http://www.nightfoxandco.com/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <nds.h>
+
+#include "nf_basic.h"
+#include "nf_loader.h"
+
+// Load job
+typedef struct {
+    u32 ticket;
+    char file[256];                             // Path without extension
+    const char *const *extensions;              // Extensions of the files
+    u32 count;                                  // Number of files
+    u32 current;                                // File being loaded
+    NF_LoaderCallback callback;
+    u32 slot;
+    char *buffers[NF_LOADER_MAX_FILES];
+    u32 sizes[NF_LOADER_MAX_FILES];
+} nf_loader_job;
+
+// Queue of jobs. Jobs are completed in order, so a ticket is complete if it's
+// older than the ticket of the job at the head of the queue.
+static nf_loader_job NF_LOADER_QUEUE[NF_LOADER_JOBS];
+static u32 NF_LOADER_HEAD = 0;
+static u32 NF_LOADER_COUNT = 0;
+static u32 NF_LOADER_TICKET = NF_LOADER_TICKET_DONE; // Last ticket given
+
+// File of the job at the head of the queue
+static NF_TYPE_FILE NF_LOADER_FILE;
+static bool NF_LOADER_FILE_OPEN = false;
+
+u32 NF_LoaderQueue(const char *file, const char *const *extensions, u32 count,
+                   NF_LoaderCallback callback, u32 slot)
+{
+    if ((count == 0) || (count > NF_LOADER_MAX_FILES))
+        NF_Error(106, "Loader files", NF_LOADER_MAX_FILES);
+
+    // If the queue is full, finish the oldest job
+    if (NF_LOADER_COUNT == NF_LOADER_JOBS)
+        NF_LoaderWait(NF_LOADER_QUEUE[NF_LOADER_HEAD].ticket);
+
+    nf_loader_job *job = &NF_LOADER_QUEUE[(NF_LOADER_HEAD + NF_LOADER_COUNT) % NF_LOADER_JOBS];
+
+    // Save the full path now in case the root folder changes later
+    job->ticket = ++NF_LOADER_TICKET;
+    snprintf(job->file, sizeof(job->file), "%s/%s", NF_ROOTFOLDER, file);
+    job->extensions = extensions;
+    job->count = count;
+    job->current = 0;
+    job->callback = callback;
+    job->slot = slot;
+    for (u32 n = 0; n < NF_LOADER_MAX_FILES; n++)
+    {
+        job->buffers[n] = NULL;
+        job->sizes[n] = 0;
+    }
+
+    NF_LOADER_COUNT++;
+
+    return job->ticket;
+}
+
+// Reads the next chunk of the job at the head of the queue. Returns the number
+// of bytes read.
+static u32 NF_LoaderStep(void)
+{
+    nf_loader_job *job = &NF_LOADER_QUEUE[NF_LOADER_HEAD];
+    NF_TYPE_FILE *file = &NF_LOADER_FILE;
+    u32 read = 0;
+
+    if (job->current < job->count)
+    {
+        u32 current = job->current;
+
+        if (!NF_LOADER_FILE_OPEN)
+        {
+            char filename[256];
+            snprintf(filename, sizeof(filename), "%s.%s", job->file,
+                     job->extensions[current]);
+
+            if (!NF_FileOpen(file, filename)) // If the file doesn't exist
+                NF_Error(101, filename, 0);
+            NF_LOADER_FILE_OPEN = true;
+
+            job->sizes[current] = file->size;
+            job->buffers[current] = calloc(file->size, sizeof(char));
+            if ((job->buffers[current] == NULL) && (file->size > 0)) // Not enough memory
+                NF_Error(102, NULL, file->size);
+        }
+
+        u32 size = file->size - file->pos;
+        if (size > NF_LOADER_CHUNK_SIZE)
+            size = NF_LOADER_CHUNK_SIZE;
+
+        if (size > 0)
+        {
+            read = NF_FileRead(file, job->buffers[current] + file->pos, size);
+            if (read == 0) // The file is shorter than expected
+                NF_Error(101, job->file, 0);
+        }
+
+        if (file->pos < file->size)
+            return read;
+
+        // The file has been read, decompress it if required
+        bool check = !file->packed || (file->flags & NF_ASSETPACK_COMPRESSED);
+        NF_FileClose(file);
+        NF_LOADER_FILE_OPEN = false;
+
+        NF_FileUnpack(&job->buffers[current], &job->sizes[current], 0, check);
+
+        job->current++;
+        if (job->current < job->count)
+            return read;
+    }
+
+    // All files have been loaded. Remove the job from the queue before calling
+    // the callback, so that it can't be cancelled or waited for from it. The
+    // callback gets a copy of the job, as it may queue new jobs that reuse the
+    // entry of the queue.
+    nf_loader_job done = *job;
+    NF_LOADER_HEAD = (NF_LOADER_HEAD + 1) % NF_LOADER_JOBS;
+    NF_LOADER_COUNT--;
+
+    done.callback(done.slot, done.buffers, done.sizes);
+
+    return read;
+}
+
+u32 NF_LoaderUpdate(u32 max_bytes, u32 max_usec)
+{
+    // Limit of the time budget in timer ticks
+    u32 max_ticks = 0;
+    if (max_usec > 0)
+    {
+        u64 ticks = ((u64)max_usec * (BUS_CLOCK >> 8)) / 1000000;
+        max_ticks = (ticks > 0xFFFF) ? 0xFFFF : ((ticks > 0) ? ticks : 1);
+
+        TIMER_CR(NF_LOADER_TIMER) = 0;
+        TIMER_DATA(NF_LOADER_TIMER) = 0;
+        TIMER_CR(NF_LOADER_TIMER) = TIMER_ENABLE | TIMER_DIV_256;
+    }
+
+    u32 total = 0;
+
+    while (NF_LOADER_COUNT > 0)
+    {
+        total += NF_LoaderStep();
+
+        if ((max_bytes > 0) && (total >= max_bytes))
+            break;
+
+        if ((max_ticks > 0) && (TIMER_DATA(NF_LOADER_TIMER) >= max_ticks))
+            break;
+    }
+
+    if (max_usec > 0)
+        TIMER_CR(NF_LOADER_TIMER) = 0;
+
+    return total;
+}
+
+bool NF_LoaderIsDone(u32 ticket)
+{
+    if (NF_LOADER_COUNT == 0)
+        return true;
+
+    return ticket < NF_LOADER_QUEUE[NF_LOADER_HEAD].ticket;
+}
+
+void NF_LoaderWait(u32 ticket)
+{
+    while (!NF_LoaderIsDone(ticket))
+        NF_LoaderStep();
+}
+
+void NF_LoaderWaitAll(void)
+{
+    while (NF_LOADER_COUNT > 0)
+        NF_LoaderStep();
+}
+
+u32 NF_LoaderPendingJobs(void)
+{
+    return NF_LOADER_COUNT;
+}
+
+void NF_LoaderCancel(NF_LoaderCallback callback)
+{
+    u32 count = NF_LOADER_COUNT;
+    u32 kept = 0;
+
+    for (u32 n = 0; n < count; n++)
+    {
+        nf_loader_job *job = &NF_LOADER_QUEUE[(NF_LOADER_HEAD + n) % NF_LOADER_JOBS];
+
+        if (job->callback == callback)
+        {
+            // Close the file if this job was being loaded
+            if ((n == 0) && NF_LOADER_FILE_OPEN)
+            {
+                NF_FileClose(&NF_LOADER_FILE);
+                NF_LOADER_FILE_OPEN = false;
+            }
+
+            for (u32 i = 0; i < NF_LOADER_MAX_FILES; i++)
+                free(job->buffers[i]);
+
+            continue;
+        }
+
+        // Move the jobs that are kept to fill the gaps
+        nf_loader_job *dst = &NF_LOADER_QUEUE[(NF_LOADER_HEAD + kept) % NF_LOADER_JOBS];
+        if (dst != job)
+            *dst = *job;
+        kept++;
+    }
+
+    // The tickets of cancelled jobs are complete when all the jobs that were
+    // queued before them are complete.
+    NF_LOADER_COUNT = kept;
+}
@@ -6,6 +6,7 @@
 // http://www.nightfoxandco.com/
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 
@@ -15,192 +16,416 @@
 #include "nf_bitmapbg.h"
 #include "nf_media.h"
 
-void NF_LoadBMP(const char* file, u8 slot) {
+// Tamaño del buffer de lectura de los datos comprimidos con RLE
+#define NF_BMP_CHUNK 512
 
-	// Buffers locales
-	char* buffer;		// Buffer temporal
-	buffer = NULL;
-	char* palette;		// Paleta (requerida por algun modo)
-	palette = NULL;
-
-	// Magic ID
-	char magic_id[4];
-	memset(magic_id, 0, 4);
-
-	// Define la estructura para almacenar la cabecera del BMP
-	typedef struct {
-		u32 bmp_size;		// Tamaño en bytes del BMP
-		u16 res_a;			// Reservado
-		u16 res_b;			// Reservado
-		u32 offset;			// Offset donde empiezan los datos
-		u32 header_size;	// Tamaño de la cabecera (40 bytes)
-		u32 bmp_width;		// Ancho de la imagen en pixeles
-		u32 bmp_height;		// Altura de la imagen en pixeles
-		u16 color_planes;	// Numero de planos de color
-		u16 bpp;			// Numero de bits por pixel
-		u32 compression;	// Compresion usada
-		u32 raw_size;		// Tamaño de los datos en RAW despues de la cabecera
-		u32 dpi_hor;		// Puntos por pulgada (horizontal)
-		u32 dpi_ver;		// Puntos por pulgada (vertical)
-		u32 pal_colors;		// Numero de colores en la paleta
-		u32 imp_colors;		// Colores importantes
-	} bmp_header_info;
-	bmp_header_info bmp_header;
-
-	// Pon todos los bytes de la estructura a 0
-	memset(&bmp_header, 0, sizeof(bmp_header));
-
-	// Declara los punteros a los ficheros
-	FILE* file_id;
-
-	// Variable para almacenar el path al archivo
-	char filename[256];
+// Cabecera del BMP (a partir del Magic ID)
+typedef struct {
+	u32 bmp_size;		// Tamaño en bytes del BMP
+	u16 res_a;			// Reservado
+	u16 res_b;			// Reservado
+	u32 offset;			// Offset donde empiezan los datos
+	u32 header_size;	// Tamaño de la cabecera (40 bytes)
+	s32 bmp_width;		// Ancho de la imagen en pixeles
+	s32 bmp_height;		// Altura de la imagen en pixeles (negativa si las lineas van de arriba a abajo)
+	u16 color_planes;	// Numero de planos de color
+	u16 bpp;			// Numero de bits por pixel
+	u32 compression;	// Compresion usada
+	u32 raw_size;		// Tamaño de los datos en RAW despues de la cabecera
+	u32 dpi_hor;		// Puntos por pulgada (horizontal)
+	u32 dpi_ver;		// Puntos por pulgada (vertical)
+	u32 pal_colors;		// Numero de colores en la paleta
+	u32 imp_colors;		// Colores importantes
+} nf_bmp_header;
 
-	// Carga el archivo .BMP
-	snprintf(filename, sizeof(filename), "%s/%s.bmp", NF_ROOTFOLDER, file);
-	file_id = fopen(filename, "rb");
-
-	if (file_id) {	// Si el archivo existe...
-		// Posicionate en el byte 0
-		fseek(file_id, 0, SEEK_SET);
-		// Lee el Magic String del archivo BMP (2 primeros Bytes, "BM") / (0x00 - 0x01)
-		fread(magic_id, 1, 2, file_id);
-		// Si es un archivo BMP... (Magic string == "BM")
-		if (strcmp(magic_id, "BM") == 0) {
-			// Posicionate en el byte 2
-			fseek(file_id, 2, SEEK_SET);
-			// Lee la cabecera del archivo BMP (0x02 - 0x36)
-			fread((void*)&bmp_header, 1, sizeof(bmp_header), file_id);
-			/////////////////////////////////////////////////////////////
-			// Es un archivo BMP valido, cargalo en un buffer temporal //
-			/////////////////////////////////////////////////////////////
-			// Crea un buffer temporal
-			buffer = (char*) calloc (bmp_header.raw_size, sizeof(char));
-			if (buffer == NULL) NF_Error(102, NULL, bmp_header.raw_size);
-			// Si se ha creado con exito, carga el archivo al buffer
-			fseek(file_id, bmp_header.offset, SEEK_SET);
-			fread(buffer, 1, bmp_header.raw_size, file_id);
-		} else {
-			// No es un archivo BMP valido
-			NF_Error(101, "BMP", 0);
-		}
-	} else {
-		// El archivo no existe
-		NF_Error(101, filename, 0);
+// Destino de las lineas decodificadas
+typedef struct {
+	u16* buffer;		// Primer pixel del destino
+	u32 pitch;			// Pixeles entre lineas del destino
+	u32 skip_x;			// Pixeles no visibles a la izquierda de la imagen
+	u32 skip_y;			// Lineas no visibles encima de la imagen
+	u32 width;			// Ancho visible (desde el borde izquierdo de la imagen)
+	u32 height;			// Alto visible (desde el borde superior de la imagen)
+	u32 rows;			// Lineas del archivo
+	bool bottom_up;		// La primera linea del archivo es la de abajo
+} nf_bmp_dest;
+
+// Lector de bytes con un buffer de tamaño fijo
+typedef struct {
+	NF_TYPE_FILE* file;
+	u8 data[NF_BMP_CHUNK];
+	u32 pos;
+	u32 size;
+} nf_bmp_reader;
+
+// Devuelve la linea de destino de una linea del archivo, o NULL si no es visible
+static u16* NF_BmpRow(const nf_bmp_dest* dest, u32 row) {
+
+	if (row >= dest->rows) return NULL;
+	if (dest->bottom_up) row = (dest->rows - 1) - row;
+	if ((row < dest->skip_y) || (row >= dest->height)) return NULL;
+
+	return dest->buffer + ((row - dest->skip_y) * dest->pitch);
+
+}
+
+// Lee el siguiente byte de los datos comprimidos (-1 al final del archivo)
+static s32 NF_BmpReadByte(nf_bmp_reader* reader) {
+
+	if (reader->pos >= reader->size) {
+		reader->size = NF_FileRead(reader->file, reader->data, NF_BMP_CHUNK);
+		reader->pos = 0;
+		if (reader->size == 0) return -1;
 	}
-	// Cierra el archivo
-	fclose(file_id);
-
-	// Variables que se usaran a partir de aqui
-	u16 pixel = 0;		// Color del pixel
-	u16 x = 0;			// Coordemada X
-	u16 y = 0;			// Coordenada Y
-	u32 idx = 0;		// Indice en el buffer temporal
-	u32 offset = 0;		// Indice en el buffer de destino
-	u8 r = 0;			// Valores RGB
-	u8 g = 0;
-	u8 b = 0;
-	u16 colors = 0;		// En 8 bits, numero de colores
-	u32 size = 0;		// Tamaño del buffer de 16 bits (en bytes)
-
-	// Habilita el buffer de destino (u16 de alto x ancho del tamaño de imagen)
-	size = ((bmp_header.bmp_width * bmp_header.bmp_height) << 1);
-	free(NF_BG16B[slot].buffer);
-	NF_BG16B[slot].buffer = NULL;
-	NF_BG16B[slot].buffer = (u16*) calloc ((size >> 1), sizeof(u16));
-	if (NF_BG16B[slot].buffer == NULL) NF_Error(102, NULL, size);
 
-	// Segun los BITS por Pixel (8, 16, 24)
-	switch (bmp_header.bpp) {
-
-		case 8:		// 8 bits por pixel
-			// Calcula el tamaño de la paleta
-			colors = ((bmp_header.offset - 0x36) >> 2);
-			palette = (char*) calloc ((colors << 2), sizeof(char));
-			if (palette == NULL) NF_Error(102, NULL, (colors << 2));
-			// Abre de nuevo el archivo y carga la paleta
-			file_id = fopen(filename, "rb");
-			if (!file_id) NF_Error(101, filename, 0);
-			fseek(file_id, 0x36, SEEK_SET);
-			fread(palette, 1, (colors << 2), file_id);
-			fclose(file_id);
-			// Convierte el archivo a 16 bits
-			for (y = 0; y < bmp_header.bmp_height; y ++) {
-				for (x = 0; x < bmp_header.bmp_width; x ++) {
-					// Calcula los offsets
-					offset = ((((bmp_header.bmp_height - 1) - y) * bmp_header.bmp_width) + x);
-					// Obten el pixel
-					pixel = (buffer[idx] << 2);
-					// Desglosa el RGB para rotar los colores BGR -> RGB
-					b = (palette[pixel] >> 3);
-					g = (palette[(pixel + 1)] >> 3);
-					r = (palette[(pixel + 2)] >> 3);
-					// Recombina el RGB a 16 bits
-					pixel = ((r)|((g) << 5)|((b) << 10)|(BIT(15)));
-					NF_BG16B[slot].buffer[offset] = pixel;
-					// Siguiente pixel
-					idx ++;
-				}
-				// Ajusta la alineacion a 4 bytes al final de linea
-				while ((idx % 4) != 0) idx ++;
+	return reader->data[reader->pos ++];
+
+}
+
+// Decodifica datos RLE8 (bpp = 8) o RLE4 (bpp = 4)
+static void NF_BmpDecodeRle(NF_TYPE_FILE* file, const nf_bmp_dest* dest, const u16* table, u32 bpp) {
+
+	nf_bmp_reader reader;
+	reader.file = file;
+	reader.pos = 0;
+	reader.size = 0;
+
+	u32 x = 0;		// Posicion en la linea
+	u32 y = 0;		// Linea del archivo
+	u16* row = NF_BmpRow(dest, 0);
+
+	while (y < dest->rows) {
+
+		s32 count = NF_BmpReadByte(&reader);
+		s32 value = NF_BmpReadByte(&reader);
+		if ((count < 0) || (value < 0)) break;
+
+		if (count > 0) {
+			// Secuencia de pixeles repetidos (en RLE4 alterna los dos nibbles)
+			for (s32 n = 0; n < count; n ++) {
+				u32 index = value;
+				if (bpp == 4) index = (n & 1) ? (value & 0x0F) : (value >> 4);
+				if ((row != NULL) && (x >= dest->skip_x) && (x < dest->width)) row[x - dest->skip_x] = table[index];
+				x ++;
 			}
-			// Elimina la paleta de la RAM
-			free(palette);
-			palette = NULL;
-			break;
+			continue;
+		}
+
+		switch (value) {
 
-		case 16:	// 16 bits por pixel
-			for (y = 0; y < bmp_header.bmp_height; y ++) {
-				for (x = 0; x < bmp_header.bmp_width; x ++) {
-					// Calcula los offsets
-					offset = ((((bmp_header.bmp_height - 1) - y) * bmp_header.bmp_width) + x);
-					// Obten el pixel
-					pixel = buffer[idx] + (buffer[(idx + 1)] << 8);
-					// Desglosa el RGB para rotar los colores BGR -> RGB
-					b = (pixel & 0x1F);
-					g = ((pixel >> 5) & 0x1F);
-					r = ((pixel >> 10) & 0x1F);
-					// Recombina el RGB a 16 bits
-					pixel = ((r)|((g) << 5)|((b) << 10)|(BIT(15)));
-					NF_BG16B[slot].buffer[offset] = pixel;
-					// Siguiente pixel
-					idx += 2;
+			case 0:		// Fin de linea
+				x = 0;
+				y ++;
+				row = NF_BmpRow(dest, y);
+				break;
+
+			case 1:		// Fin de la imagen
+				return;
+
+			case 2:		// Salto a otra posicion
+				{
+					s32 dx = NF_BmpReadByte(&reader);
+					s32 dy = NF_BmpReadByte(&reader);
+					if ((dx < 0) || (dy < 0)) return;
+					x += dx;
+					y += dy;
+					row = NF_BmpRow(dest, y);
 				}
-				// Ajusta la alineacion a 4 bytes al final de linea
-				while ((idx % 4) != 0) idx ++;
-			}
-			break;
+				break;
 
-		case 24:	// 24 bits por pixel
-			for (y = 0; y < bmp_header.bmp_height; y ++) {
-				for (x = 0; x < bmp_header.bmp_width; x ++) {
-					// Calcula los offsets
-					offset = ((((bmp_header.bmp_height - 1) - y) * bmp_header.bmp_width) + x);
-					// Obten el pixel
-					b = ((buffer[idx]) >> 3);
-					g = ((buffer[idx + 1]) >> 3);
-					r = ((buffer[idx + 2]) >> 3);
-					// Recombina el RGB a 16 bits
-					pixel = ((r)|((g) << 5)|((b) << 10)|(BIT(15)));
-					NF_BG16B[slot].buffer[offset] = pixel;
-					// Siguiente pixel
-					idx += 3;
+			default:	// Secuencia de pixeles sin comprimir
+				{
+					u32 bytes = (bpp == 4) ? ((value + 1) >> 1) : value;
+					s32 data = 0;
+					for (s32 n = 0; n < value; n ++) {
+						u32 index;
+						if (bpp == 4) {
+							if ((n & 1) == 0) data = NF_BmpReadByte(&reader);
+							index = (n & 1) ? (data & 0x0F) : ((data >> 4) & 0x0F);
+						} else {
+							data = NF_BmpReadByte(&reader);
+							index = data & 0xFF;
+						}
+						if (data < 0) return;
+						if ((row != NULL) && (x >= dest->skip_x) && (x < dest->width)) row[x - dest->skip_x] = table[index];
+						x ++;
+					}
+					// Las secuencias estan alineadas a 16 bits
+					if (bytes & 1) NF_BmpReadByte(&reader);
 				}
-				// Ajusta la alineacion a 4 bytes al final de linea
-				while ((idx % 4) != 0) idx ++;
+				break;
+
+		}
+
+	}
+
+}
+
+// Convierte un componente de color definido por una mascara a 5 bits
+static inline u32 NF_BmpMaskComponent(u32 pixel, u32 mask, u32 shift, u32 bits) {
+	u32 value = (pixel & mask) >> shift;
+	return (bits > 5) ? (value >> (bits - 5)) : (value << (5 - bits));
+}
+
+// Decodifica datos sin comprimir linea a linea. Si hay mascaras (BI_BITFIELDS),
+// los pixeles de 16 y 32 bits se convierten con ellas (rojo, verde, azul)
+static void NF_BmpDecodeRaw(NF_TYPE_FILE* file, const nf_bmp_dest* dest, const u16* table, u32 bpp, u32 width, const u32* masks) {
+
+	// Posicion y numero de bits de cada componente de las mascaras
+	u32 shift[3] = { 0, 0, 0 };
+	u32 bits[3] = { 0, 0, 0 };
+	if (masks != NULL) {
+		for (u32 n = 0; n < 3; n ++) {
+			shift[n] = __builtin_ctz(masks[n]);
+			bits[n] = __builtin_popcount(masks[n]);
+		}
+	}
+
+	// Las lineas del archivo estan alineadas a 4 bytes
+	u32 line_size = (((width * bpp) + 31) >> 5) << 2;
+	u8* line = (u8*) malloc (line_size);
+	if (line == NULL) NF_Error(102, NULL, line_size);
+
+	u32 first = dest->skip_x;
+	u32 last = (width < dest->width) ? width : dest->width;
+
+	for (u32 y = 0; y < dest->rows; y ++) {
+
+		u16* row = NF_BmpRow(dest, y);
+
+		if (NF_FileRead(file, line, line_size) < line_size) break;
+		if (row == NULL) continue;
+
+		// Los pixeles recortados por la izquierda no se convierten
+		if (masks != NULL) {
+			u32 step = bpp >> 3;
+			const u8* src = line + (first * step);
+			for (u32 x = first; x < last; x ++) {
+				u32 pixel = src[0] | (src[1] << 8);
+				if (step == 4) pixel |= (src[2] << 16) | ((u32)src[3] << 24);
+				row[x - first] = NF_BmpMaskComponent(pixel, masks[0], shift[0], bits[0])
+							| (NF_BmpMaskComponent(pixel, masks[1], shift[1], bits[1]) << 5)
+							| (NF_BmpMaskComponent(pixel, masks[2], shift[2], bits[2]) << 10)
+							| BIT(15);
+				src += step;
 			}
+			continue;
+		}
+
+		switch (bpp) {
+
+			case 4:		// 4 bits por pixel, con paleta
+				for (u32 x = first; x < last; x ++) {
+					u32 index = (x & 1) ? (line[x >> 1] & 0x0F) : (line[x >> 1] >> 4);
+					row[x - first] = table[index];
+				}
+				break;
+
+			case 8:		// 8 bits por pixel, con paleta
+				for (u32 x = first; x < last; x ++) row[x - first] = table[line[x]];
+				break;
+
+			case 16:	// 16 bits por pixel (X1R5G5B5)
+				for (u32 x = first; x < last; x ++) {
+					u32 pixel = line[x << 1] | (line[(x << 1) + 1] << 8);
+					row[x - first] = ((pixel >> 10) & 0x1F) | (pixel & 0x03E0) | ((pixel & 0x1F) << 10) | BIT(15);
+				}
+				break;
+
+			case 24:	// 24 bits por pixel (BGR)
+			case 32:	// 32 bits por pixel (BGRA)
+				{
+					u32 step = bpp >> 3;
+					const u8* src = line + (first * step);
+					for (u32 x = first; x < last; x ++) {
+						row[x - first] = (src[2] >> 3) | ((src[1] >> 3) << 5) | ((src[0] >> 3) << 10) | BIT(15);
+						src += step;
+					}
+				}
+				break;
+
+		}
+
+	}
+
+	free(line);
+
+}
+
+// Abre un BMP, lee su cabecera y su paleta, y deja el archivo al principio
+// de los datos de la imagen
+static void NF_BmpOpen(const char* file, NF_TYPE_FILE* file_id, nf_bmp_header* header, u16* table, u32* masks) {
+
+	// Carga el archivo .BMP
+	char filename[256];
+	snprintf(filename, sizeof(filename), "%s/%s.bmp", NF_ROOTFOLDER, file);
+	if (!NF_FileOpen(file_id, filename)) NF_Error(101, filename, 0);
+
+	// Lee el Magic String del archivo BMP (2 primeros Bytes, "BM") / (0x00 - 0x01)
+	char magic_id[2] = { 0, 0 };
+	NF_FileRead(file_id, magic_id, 2);
+	if ((magic_id[0] != 'B') || (magic_id[1] != 'M')) NF_Error(101, "BMP", 0);
+
+	// Lee la cabecera del archivo BMP (0x02 - 0x36)
+	memset(header, 0, sizeof(nf_bmp_header));
+	NF_FileRead(file_id, header, sizeof(nf_bmp_header));
+
+	// Formatos soportados: 4 y 8 bits con o sin RLE, 24 bits sin comprimir,
+	// y 16 y 32 bits sin comprimir o con mascaras de color (BI_BITFIELDS)
+	bool valid;
+	switch (header->bpp) {
+		case 4:
+			valid = (header->compression == 0) || (header->compression == 2);
+			break;
+		case 8:
+			valid = (header->compression == 0) || (header->compression == 1);
+			break;
+		case 16:
+		case 32:
+			valid = (header->compression == 0) || (header->compression == 3);
+			break;
+		case 24:
+			valid = (header->compression == 0);
 			break;
+		default:
+			valid = false;
+			break;
+	}
+	if (!valid || (header->bmp_width <= 0) || (header->bmp_height == 0)) NF_Error(101, "BMP", 0);
+
+	// Las mascaras de color (rojo, verde, azul) van despues de la cabecera de
+	// 40 bytes, tambien en las cabeceras V4 y V5, que las incluyen
+	if (header->compression == 3) {
+		NF_FileSeek(file_id, 14 + 40);
+		if (NF_FileRead(file_id, masks, 3 * sizeof(u32)) < (3 * sizeof(u32))) NF_Error(101, "BMP", 0);
+		for (u32 n = 0; n < 3; n ++) {
+			// Cada mascara debe ser un solo bloque de bits seguidos
+			if (masks[n] == 0) NF_Error(101, "BMP", 0);
+			u32 bits = masks[n] >> __builtin_ctz(masks[n]);
+			if ((bits & (bits + 1)) != 0) NF_Error(101, "BMP", 0);
+		}
+	}
+
+	// Convierte la paleta a RGB15 una sola vez (el resto de colores son negros)
+	for (u32 n = 0; n < 256; n ++) table[n] = BIT(15);
+	if (header->bpp <= 8) {
+		u32 pal_start = 14 + header->header_size;
+		u32 colors = header->pal_colors;
+		if ((colors == 0) || (colors > (1u << header->bpp))) colors = 1 << header->bpp;
+		// La paleta termina donde empiezan los datos de la imagen
+		if (header->offset < pal_start) {
+			colors = 0;
+		} else if (header->offset < (pal_start + (colors << 2))) {
+			colors = (header->offset - pal_start) >> 2;
+		}
+		if (colors > 256) colors = 256;
+
+		u8 palette[1024];
+		NF_FileSeek(file_id, pal_start);
+		NF_FileRead(file_id, palette, colors << 2);
+		for (u32 n = 0; n < colors; n ++) {
+			u8* color = &palette[n << 2];	// BGR0
+			table[n] = (color[2] >> 3) | ((color[1] >> 3) << 5) | ((color[0] >> 3) << 10) | BIT(15);
+		}
+	}
+
+	// Situate al principio de los datos de la imagen
+	NF_FileSeek(file_id, header->offset);
 
+}
+
+// Decodifica los datos de la imagen en el destino
+static void NF_BmpDecode(NF_TYPE_FILE* file_id, const nf_bmp_header* header, const u16* table, const u32* masks, nf_bmp_dest* dest) {
+
+	dest->rows = (header->bmp_height < 0) ? -header->bmp_height : header->bmp_height;
+	dest->bottom_up = (header->bmp_height > 0);
+
+	if ((header->compression == 1) || (header->compression == 2)) {
+		NF_BmpDecodeRle(file_id, dest, table, header->bpp);
+	} else {
+		NF_BmpDecodeRaw(file_id, dest, table, header->bpp, header->bmp_width, (header->compression == 3) ? masks : NULL);
 	}
 
+}
+
+void NF_LoadBMP(const char* file, u8 slot) {
+
+	// Verifica el rango de slots
+	if (slot >= NF_SLOTS_BG16B) NF_Error(106, "16 bit image", NF_SLOTS_BG16B);
+
+	// Abre el archivo y lee la cabecera y la paleta
+	NF_TYPE_FILE file_id;
+	nf_bmp_header header;
+	u16 table[256];
+	u32 masks[3];
+	NF_BmpOpen(file, &file_id, &header, table, masks);
+
+	u32 width = header.bmp_width;
+	u32 height = (header.bmp_height < 0) ? -header.bmp_height : header.bmp_height;
+
+	// Habilita el buffer de destino (u16 de alto x ancho del tamaño de imagen).
+	// Los pixeles que no esten en el archivo (saltos RLE) son transparentes.
+	u32 size = ((width * height) << 1);
+	free(NF_BG16B[slot].buffer);
+	NF_BG16B[slot].buffer = NULL;
+	free(NF_BG16B[slot].mask);
+	NF_BG16B[slot].mask = NULL;
+	NF_BG16B[slot].buffer = (u16*) calloc ((size >> 1), sizeof(u16));
+	if (NF_BG16B[slot].buffer == NULL) NF_Error(102, NULL, size);
+
+	// Decodifica las lineas directamente en el slot
+	nf_bmp_dest dest;
+	dest.buffer = NF_BG16B[slot].buffer;
+	dest.pitch = width;
+	dest.skip_x = 0;
+	dest.skip_y = 0;
+	dest.width = width;
+	dest.height = height;
+	NF_BmpDecode(&file_id, &header, table, masks, &dest);
+
+	// Cierra el archivo
+	NF_FileClose(&file_id);
+
 	// Guarda los parametros del fondo
 	NF_BG16B[slot].size = size;			// Guarda el tamaño
-	NF_BG16B[slot].width = bmp_header.bmp_width;		// Ancho del fondo
-	NF_BG16B[slot].height = bmp_header.bmp_height;		// Altura del fondo
-	NF_BG16B[slot].inuse = true;						// Marca que esta en uso
+	NF_BG16B[slot].width = width;		// Ancho del fondo
+	NF_BG16B[slot].height = height;		// Altura del fondo
+	NF_BG16B[slot].inuse = true;		// Marca que esta en uso
+
+	// Busca los pixeles transparentes
+	NF_Update16bitsImageSpans(slot);
+
+}
 
-	// Libera el buffer temporal
-	free(buffer);
-	buffer = NULL;
+void NF_LoadBMPToVram(const char* file, u8 screen, s16 x, s16 y) {
+
+	if (screen > 1) screen = 1;
+
+	// Abre el archivo y lee la cabecera y la paleta
+	NF_TYPE_FILE file_id;
+	nf_bmp_header header;
+	u16 table[256];
+	u32 masks[3];
+	NF_BmpOpen(file, &file_id, &header, table, masks);
+
+	// Las lineas se escriben directamente en el bitmap de 16 bits que se esta
+	// mostrando (con page flipping, puede ser VRAM_B), recortando la imagen a
+	// sus 256x256 pixeles
+	u16* vram = NF_Get16bitsDisplayedPage(screen);
+
+	nf_bmp_dest dest;
+	dest.pitch = 256;
+	dest.skip_x = (x < 0) ? -x : 0;
+	dest.skip_y = (y < 0) ? -y : 0;
+	if (x < 0) x = 0;
+	if (y < 0) y = 0;
+	dest.buffer = vram + (y << 8) + x;
+	dest.width = dest.skip_x + (256 - x);
+	dest.height = dest.skip_y + (256 - y);
+
+	if ((x < 256) && (y < 256)) NF_BmpDecode(&file_id, &header, table, masks, &dest);
+
+	// Cierra el archivo
+	NF_FileClose(&file_id);
 
 }
@@ -5,6 +5,7 @@
 // NightFox LIB - Include de Fondos mixtos (Tiled / Bitmap 8 bits)
 // http://www.nightfoxandco.com/
 
+#include <stdlib.h>
 #include <string.h>
 
 #include <nds.h>
@@ -49,7 +50,14 @@ void NF_InitMixedBgSys(u8 screen)
         NF_TILEDBG_LAYERS[screen][n].bgslot = 0;        // Graphics slot
         NF_TILEDBG_LAYERS[screen][n].blockx = 0;        // Current horizontal map block
         NF_TILEDBG_LAYERS[screen][n].blocky = 0;        // Current vertical map block
+        NF_TILEDBG_LAYERS[screen][n].streamx = 0xFFFF;  // Streamed window (none)
+        NF_TILEDBG_LAYERS[screen][n].streamy = 0;
+        NF_TILEDBG_LAYERS[screen][n].streaming = false; // No streaming of rows and columns
         NF_TILEDBG_LAYERS[screen][n].created = false;   // Is the background created?
+        memset(NF_TILEDBG_LAYERS[screen][n].dirtyrows, 0,
+               sizeof(NF_TILEDBG_LAYERS[screen][n].dirtyrows)); // No pending changes
+        free(NF_TILEDBG_LAYERS[screen][n].staging);     // Metatile map blocks
+        NF_TILEDBG_LAYERS[screen][n].staging = NULL;
     }
 
     // Now reserve as many VRAM banks as needed for maps. Each tile map is as
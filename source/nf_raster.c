@@ -0,0 +1,258 @@
+// SPDX-License-Identifier: MIT
+//
+// Copyright (c) 2009-2014 Cesar Rincon "NightFox"
+//
+// NightFox LIB - Funciones de efectos por linea
+// http://www.nightfoxandco.com/
+
+#include <string.h>
+
+#include <nds.h>
+
+#include "nf_affinebg.h"
+#include "nf_basic.h"
+#include "nf_raster.h"
+
+// Tables filled by the user. One of them is being filled (back) and the other
+// one is the last table made visible with NF_RasterSwap() (front).
+static u16 NF_RASTER_TABLE[2][NF_RASTER_LINES][NF_RASTER_MAX_REGS];
+static u32 NF_RASTER_BACK = 0;
+static bool NF_RASTER_PENDING = false;
+
+// Values copied by the DMA, packed with as many values per line as registers
+// used by the effect. It has an extra line because the DMA also runs in the
+// HBlank of the last line.
+static u16 NF_RASTER_OUTPUT[(NF_RASTER_LINES + 1) * NF_RASTER_MAX_REGS] __attribute__((aligned(4)));
+
+// Active effect
+static bool NF_RASTER_ACTIVE = false;
+static u8 NF_RASTER_SCREEN = 0;
+static u8 NF_RASTER_TYPE = 0;
+static u8 NF_RASTER_LAYER = 0;
+static u32 NF_RASTER_REGS = 0;          // Number of 16-bit registers per line
+static vu16 *NF_RASTER_DEST = NULL;     // First register
+
+// Last scroll values set by NF_ScrollBg() for each screen and layer
+static u16 NF_RASTER_SCROLL_BASE[2][4][2];
+
+// Returns the address of the first register of an effect
+static vu16 *NF_RasterRegisters(u8 screen, u8 type, u8 layer)
+{
+    u32 base = (screen == 0) ? 0x04000000 : 0x04001000;
+
+    switch (type)
+    {
+        case NF_RASTER_SCROLL:
+            return (vu16 *)(base + 0x10 + (layer << 2)); // BGxHOFS
+        case NF_RASTER_AFFINE:
+            return (vu16 *)(base + 0x20 + ((layer - 2) << 4)); // BGxPA
+        default:
+            return (vu16 *)(base + 0x50); // BLDCNT
+    }
+}
+
+void NF_RasterStart(u8 screen, u8 type, u8 layer)
+{
+    if (screen > 1)
+        NF_Error(106, "Raster screen", 1);
+
+    switch (type)
+    {
+        case NF_RASTER_SCROLL:
+            if (layer > 3)
+                NF_Error(106, "Raster layer", 3);
+            NF_RASTER_REGS = 2;
+            break;
+        case NF_RASTER_AFFINE:
+            if ((layer < 2) || (layer > 3))
+                NF_Error(106, "Raster layer", 3);
+            NF_RASTER_REGS = 8;
+            break;
+        case NF_RASTER_BLEND:
+            layer = 0;
+            NF_RASTER_REGS = 3;
+            break;
+        default:
+            NF_Error(106, "Raster type", NF_RASTER_BLEND);
+    }
+
+    NF_RasterStop();
+
+    NF_RASTER_SCREEN = screen;
+    NF_RASTER_TYPE = type;
+    NF_RASTER_LAYER = layer;
+    NF_RASTER_DEST = NF_RasterRegisters(screen, type, layer);
+
+    // Initial values of all lines
+    u16 initial[NF_RASTER_MAX_REGS] = { 0 };
+
+    if (type == NF_RASTER_AFFINE)
+    {
+        // Same values as the ones set by NF_AffineBgMove()
+        NF_TYPE_AFFINE_BG *bg = &NF_AFFINE_BG[screen][layer];
+        s32 x = (bg->x << 8) - (((bg->x_scale * (bg->x_center << 8))
+                               + (bg->x_tilt * (bg->y_center << 8))) >> 8);
+        s32 y = (bg->y << 8) - (((bg->y_tilt * (bg->x_center << 8))
+                               + (bg->y_scale * (bg->y_center << 8))) >> 8);
+        initial[0] = bg->x_scale;
+        initial[1] = bg->x_tilt;
+        initial[2] = bg->y_tilt;
+        initial[3] = bg->y_scale;
+        initial[4] = x & 0xFFFF;
+        initial[5] = (u32)x >> 16;
+        initial[6] = y & 0xFFFF;
+        initial[7] = (u32)y >> 16;
+    }
+    else if (type == NF_RASTER_BLEND)
+    {
+        // BLDCNT and BLDALPHA can be read, BLDY can't
+        initial[0] = NF_RASTER_DEST[0];
+        initial[1] = NF_RASTER_DEST[1];
+    }
+
+    for (u32 line = 0; line < NF_RASTER_LINES; line++)
+    {
+        memcpy(NF_RASTER_TABLE[0][line], initial, sizeof(initial));
+        memcpy(NF_RASTER_TABLE[1][line], initial, sizeof(initial));
+    }
+
+    NF_RASTER_BACK = 0;
+    NF_RASTER_PENDING = true;
+    NF_RASTER_ACTIVE = true;
+}
+
+void NF_RasterStop(void)
+{
+    if (!NF_RASTER_ACTIVE)
+        return;
+
+    DMA_CR(NF_RASTER_DMA_CHANNEL) = 0;
+    NF_RASTER_ACTIVE = false;
+
+    // Give the scroll registers back to NF_ScrollBg()
+    if (NF_RASTER_TYPE == NF_RASTER_SCROLL)
+    {
+        u16 *base = NF_RASTER_SCROLL_BASE[NF_RASTER_SCREEN][NF_RASTER_LAYER];
+        NF_RASTER_DEST[0] = base[0];
+        NF_RASTER_DEST[1] = base[1];
+    }
+}
+
+bool NF_RasterUses(u8 screen, u8 type, u8 layer)
+{
+    if (type == NF_RASTER_BLEND)
+        layer = 0;
+
+    return NF_RASTER_ACTIVE && (NF_RASTER_TYPE == type)
+        && (NF_RASTER_SCREEN == screen) && (NF_RASTER_LAYER == layer);
+}
+
+bool NF_RasterScrollBg(u8 screen, u8 layer, u16 x, u16 y)
+{
+    NF_RASTER_SCROLL_BASE[screen][layer][0] = x;
+    NF_RASTER_SCROLL_BASE[screen][layer][1] = y;
+
+    return NF_RasterUses(screen, NF_RASTER_SCROLL, layer);
+}
+
+u16 *NF_RasterGetLine(u8 line)
+{
+    if (line >= NF_RASTER_LINES)
+        NF_Error(106, "Raster line", NF_RASTER_LINES - 1);
+
+    return NF_RASTER_TABLE[NF_RASTER_BACK][line];
+}
+
+void NF_RasterSetScroll(u8 line, s16 x, s16 y)
+{
+    u16 *values = NF_RasterGetLine(line);
+    values[0] = x;
+    values[1] = y;
+}
+
+void NF_RasterSetAffine(u8 line, s16 pa, s16 pb, s16 pc, s16 pd, s32 x, s32 y)
+{
+    u16 *values = NF_RasterGetLine(line);
+    values[0] = pa;
+    values[1] = pb;
+    values[2] = pc;
+    values[3] = pd;
+    values[4] = x & 0xFFFF;
+    values[5] = (u32)x >> 16;
+    values[6] = y & 0xFFFF;
+    values[7] = (u32)y >> 16;
+}
+
+void NF_RasterSetBlend(u8 line, u16 control, u16 alpha, u16 brightness)
+{
+    u16 *values = NF_RasterGetLine(line);
+    values[0] = control;
+    values[1] = alpha;
+    values[2] = brightness;
+}
+
+void NF_RasterSwap(void)
+{
+    NF_RASTER_PENDING = true;
+}
+
+void NF_RasterVBlank(void)
+{
+    if (!NF_RASTER_ACTIVE)
+        return;
+
+    DMA_CR(NF_RASTER_DMA_CHANNEL) = 0;
+
+    u32 regs = NF_RASTER_REGS;
+
+    // Make the back table visible. The new back table starts as a copy of it,
+    // so only the lines that change need to be set again.
+    if (NF_RASTER_PENDING)
+    {
+        u32 front = NF_RASTER_BACK;
+        NF_RASTER_BACK ^= 1;
+        memcpy(NF_RASTER_TABLE[NF_RASTER_BACK], NF_RASTER_TABLE[front],
+               sizeof(NF_RASTER_TABLE[0]));
+        NF_RASTER_PENDING = false;
+    }
+
+    // Build the values copied by the DMA. The front table can't be used
+    // directly because scroll offsets are relative to the scroll of the BG.
+    u16 (*table)[NF_RASTER_MAX_REGS] = NF_RASTER_TABLE[NF_RASTER_BACK ^ 1];
+
+    u16 *output = NF_RASTER_OUTPUT;
+
+    if (NF_RASTER_TYPE == NF_RASTER_SCROLL)
+    {
+        u16 *base = NF_RASTER_SCROLL_BASE[NF_RASTER_SCREEN][NF_RASTER_LAYER];
+        for (u32 line = 0; line < NF_RASTER_LINES; line++)
+        {
+            *output++ = base[0] + table[line][0];
+            *output++ = base[1] + table[line][1];
+        }
+    }
+    else
+    {
+        for (u32 line = 0; line < NF_RASTER_LINES; line++)
+        {
+            memcpy(output, table[line], regs << 1);
+            output += regs;
+        }
+    }
+
+    // The last HBlank DMA of the frame happens after the last line
+    memcpy(output, NF_RASTER_OUTPUT, regs << 1);
+
+    // The values of the first line are written now. The DMA copies the values
+    // of the next line during the HBlank period of each line.
+    for (u32 n = 0; n < regs; n++)
+        NF_RASTER_DEST[n] = NF_RASTER_OUTPUT[n];
+
+    DC_FlushRange(NF_RASTER_OUTPUT, (NF_RASTER_LINES + 1) * (regs << 1));
+
+    DMA_SRC(NF_RASTER_DMA_CHANNEL) = (u32)&NF_RASTER_OUTPUT[regs];
+    DMA_DEST(NF_RASTER_DMA_CHANNEL) = (u32)NF_RASTER_DEST;
+    DMA_CR(NF_RASTER_DMA_CHANNEL) = DMA_ENABLE | DMA_START_HBL | DMA_REPEAT
+                                  | DMA_SRC_INC | DMA_DST_RESET | DMA_16_BIT
+                                  | regs;
+}
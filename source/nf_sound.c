@@ -11,8 +11,12 @@
 #include <nds.h>
 
 #include "nf_basic.h"
+#include "nf_loader.h"
 #include "nf_sound.h"
 
+// Saves the data of a .RAW file loaded by the incremental loader
+static void NF_StoreRawSound(u32 id, char **buffers, u32 *sizes);
+
 // Buffers of all sound effects
 char *NF_BUFFER_RAWSOUND[NF_SLOTS_RAWSOUND];
 
@@ -29,11 +33,15 @@ void NF_InitRawSoundBuffers(void)
         NF_RAWSOUND[n].size = 0;            // File size
         NF_RAWSOUND[n].freq = 0;            // Frecuency of the sample
         NF_RAWSOUND[n].format = 0;          // Format of the sample
+        NF_RAWSOUND[n].loading = false;     // It isn't being loaded
     }
 }
 
 void NF_ResetRawSoundBuffers(void)
 {
+    // Cancel pending loads
+    NF_LoaderCancel(NF_StoreRawSound);
+
     // Free all buffers of RAW sound files
     for (int n = 0; n < NF_SLOTS_RAWSOUND; n ++)
         free(NF_BUFFER_RAWSOUND[n]);
@@ -42,7 +50,8 @@ void NF_ResetRawSoundBuffers(void)
     NF_InitRawSoundBuffers();
 }
 
-void NF_LoadRawSound(const char *file, u16 id,  u16 freq, u8 format)
+// Reserves a slot for a sound effect and saves its parameters
+static void NF_ReserveRawSound(u16 id, u16 freq, u8 format)
 {
     // Verify that the ID is inside the valid range
     if (id >= NF_SLOTS_RAWSOUND)
@@ -56,44 +65,49 @@ void NF_LoadRawSound(const char *file, u16 id,  u16 freq, u8 format)
     free(NF_BUFFER_RAWSOUND[id]);
     NF_BUFFER_RAWSOUND[id] = NULL;
 
+    // Save sound parameters
+    NF_RAWSOUND[id].freq = freq;
+    NF_RAWSOUND[id].format = format;
+
+    // Mark this slot as used
+    NF_RAWSOUND[id].available = false;
+}
+
+// Saves the data of a .RAW file loaded by the incremental loader
+static void NF_StoreRawSound(u32 id, char **buffers, u32 *sizes)
+{
+    // If the size is over the limit
+    if (sizes[0] > (1 << 18))
+        NF_Error(116, "Raw Sound", (1 << 18));
+
+    NF_BUFFER_RAWSOUND[id] = buffers[0];
+    NF_RAWSOUND[id].size = sizes[0];
+    NF_RAWSOUND[id].loading = false;
+}
+
+void NF_LoadRawSound(const char *file, u16 id,  u16 freq, u8 format)
+{
+    NF_ReserveRawSound(id, freq, format);
+
     // File path
     char filename[256];
 
-    // Try to load the .RAW file
+    // Try to load the .RAW file (it is decompressed if required)
     snprintf(filename, sizeof(filename), "%s/%s.raw", NF_ROOTFOLDER, file);
-    FILE *file_id = fopen(filename, "rb");
-    if (file_id == NULL)
-    {
-        // The file doesn't exist
-        NF_Error(101, filename, 0);
-    }
-
-    // Get file size
-    fseek(file_id, 0, SEEK_END);
-    NF_RAWSOUND[id].size = ftell(file_id);
-    rewind(file_id);
+    NF_FileLoad(filename, &NF_BUFFER_RAWSOUND[id], &NF_RAWSOUND[id].size, 0);
 
     // If the size is over the limit
     if (NF_RAWSOUND[id].size > (1 << 18))
         NF_Error(116, filename, (1 << 18));
+}
 
-    // Allocate space in RAM
-    NF_BUFFER_RAWSOUND[id] = calloc(NF_RAWSOUND[id].size, sizeof(char));
-    if (NF_BUFFER_RAWSOUND[id] == NULL) // Not enough RAM
-        NF_Error(102, NULL, NF_RAWSOUND[id].size);
-
-    // Read file and save it in RAM
-    fread(NF_BUFFER_RAWSOUND[id], 1, NF_RAWSOUND[id].size, file_id);
-
-    // Close file
-    fclose(file_id);
-
-    // Save sound parameters
-    NF_RAWSOUND[id].freq = freq;
-    NF_RAWSOUND[id].format = format;
+u32 NF_LoadRawSoundAsync(const char *file, u16 id, u16 freq, u8 format)
+{
+    NF_ReserveRawSound(id, freq, format);
+    NF_RAWSOUND[id].loading = true;
 
-    // Mark this slot as used
-    NF_RAWSOUND[id].available = false;
+    static const char *const extensions[] = { "raw" };
+    return NF_LoaderQueue(file, extensions, 1, NF_StoreRawSound, id);
 }
 
 void NF_UnloadRawSound(u8 id)
@@ -106,6 +120,10 @@ void NF_UnloadRawSound(u8 id)
     if (NF_RAWSOUND[id].available)
         NF_Error(110, "RAW Sound", id);
 
+    // If it's still being loaded, finish loading it
+    if (NF_RAWSOUND[id].loading)
+        NF_LoaderWaitAll();
+
     // Free the data of this slot
     free(NF_BUFFER_RAWSOUND[id]);
     NF_BUFFER_RAWSOUND[id] = NULL;
@@ -128,6 +146,10 @@ u8 NF_PlayRawSound(u8 id, u8 volume, u8 pan, bool loop, u16 loopfrom)
     if (NF_RAWSOUND[id].available)
         NF_Error(110, "RAW Sound", id);
 
+    // If it's still being loaded, finish loading it
+    if (NF_RAWSOUND[id].loading)
+        NF_LoaderWaitAll();
+
     return soundPlaySample(NF_BUFFER_RAWSOUND[id], NF_RAWSOUND[id].format,
                            NF_RAWSOUND[id].size, NF_RAWSOUND[id].freq,
                            volume, pan, loop, loopfrom);
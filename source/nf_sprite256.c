@@ -14,6 +14,7 @@
 
 #include "nf_2d.h"
 #include "nf_basic.h"
+#include "nf_loader.h"
 #include "nf_sprite256.h"
 
 // Define los Buffers para almacenar los Sprites
@@ -37,6 +38,9 @@ NF_TYPE_SPRITEOAM_INFO NF_SPRITEOAM[2][128];		// 2 pantallas, 128 sprites
 NF_TYPE_SPRVRAM_INFO NF_SPRVRAM[2];		// Informacion VRAM de Sprites en ambas pantallas
 
 
+// Guarda en un slot el archivo .IMG cargado de forma incremental
+static void NF_StoreSpriteGfx(u32 id, char** buffers, u32* sizes);
+
 void NF_InitSpriteBuffers(void) {
 
 	// Inicializa Buffers de GFX
@@ -46,6 +50,7 @@ void NF_InitSpriteBuffers(void) {
 		NF_SPR256GFX[n].width = 0;				// Ancho del Gfx
 		NF_SPR256GFX[n].height = 0;				// Altura del Gfx
 		NF_SPR256GFX[n].available = true;		// Disponibilidat del Slot
+		NF_SPR256GFX[n].loading = false;		// No se esta cargando
 	}
 
 	// Inicializa Buffers de PAL
@@ -59,6 +64,9 @@ void NF_InitSpriteBuffers(void) {
 
 void NF_ResetSpriteBuffers(void) {
 
+	// Cancela las cargas pendientes
+	NF_LoaderCancel(NF_StoreSpriteGfx);
+
 	// Borra los Buffers de GFX
 	for (int n = 0; n < NF_SLOTS_SPR256GFX; n ++) {
 		free(NF_BUFFER_SPR256GFX[n]);
@@ -178,7 +186,8 @@ void NF_InitSpriteSys(int screen, ...) {
 
 }
 
-void NF_LoadSpriteGfx(const char *file, u16 id,  u16 width, u16 height) {
+// Reserva un slot de graficos y guarda sus medidas
+static void NF_ReserveSpriteGfx(u16 id, u16 width, u16 height) {
 
 	// Verifica el rango de Id's
 	if (id >= NF_SLOTS_SPR256GFX) {
@@ -194,38 +203,47 @@ void NF_LoadSpriteGfx(const char *file, u16 id,  u16 width, u16 height) {
 	free(NF_BUFFER_SPR256GFX[id]);
 	NF_BUFFER_SPR256GFX[id] = NULL;
 
-	// Declara los punteros a los ficheros
-	FILE* file_id;
+	// Guarda las medidas del grafico
+	NF_SPR256GFX[id].width = width;		// Ancho del Gfx
+	NF_SPR256GFX[id].height = height;	// Altura del Gfx
+
+	// Y marca esta ID como usada
+	NF_SPR256GFX[id].available = false;
+
+}
+
+// Guarda en un slot el archivo .IMG cargado de forma incremental
+static void NF_StoreSpriteGfx(u32 id, char** buffers, u32* sizes) {
+
+	NF_BUFFER_SPR256GFX[id] = buffers[0];
+	NF_SPR256GFX[id].size = sizes[0];
+	NF_SPR256GFX[id].loading = false;
+
+}
+
+void NF_LoadSpriteGfx(const char *file, u16 id,  u16 width, u16 height) {
+
+	// Reserva el slot
+	NF_ReserveSpriteGfx(id, width, height);
 
 	// Variable para almacenar el path al archivo
 	char filename[256];
 
-	// Carga el archivo .IMG
+	// Carga el archivo .IMG (si esta comprimido, se descomprime)
 	snprintf(filename, sizeof(filename), "%s/%s.img", NF_ROOTFOLDER, file);
-	file_id = fopen(filename, "rb");
-	if (file_id) {	// Si el archivo existe...
-		// Obten el tamaño del archivo
-		fseek(file_id, 0, SEEK_END);
-		NF_SPR256GFX[id].size = ftell(file_id);
-		rewind(file_id);
-		// Reserva el espacio en RAM
-		NF_BUFFER_SPR256GFX[id] = (char*) calloc (NF_SPR256GFX[id].size, sizeof(char));
-		if (NF_BUFFER_SPR256GFX[id] == NULL) {		// Si no hay suficiente RAM libre
-			NF_Error(102, NULL, NF_SPR256GFX[id].size);
-		}
-		// Lee el archivo y ponlo en la RAM
-		fread(NF_BUFFER_SPR256GFX[id], 1, NF_SPR256GFX[id].size, file_id);
-	} else {	// Si el archivo no existe...
-		NF_Error(101, filename, 0);
-	}
-	fclose(file_id);		// Cierra el archivo
+	NF_FileLoad(filename, &NF_BUFFER_SPR256GFX[id], &NF_SPR256GFX[id].size, 0);
 
-	// Guarda las medidas del grafico
-	NF_SPR256GFX[id].width = width;		// Ancho del Gfx
-	NF_SPR256GFX[id].height = height;	// Altura del Gfx
+}
 
-	// Y marca esta ID como usada
-	NF_SPR256GFX[id].available = false;
+u32 NF_LoadSpriteGfxAsync(const char *file, u16 id, u16 width, u16 height) {
+
+	// Reserva el slot y marcalo como en carga
+	NF_ReserveSpriteGfx(id, width, height);
+	NF_SPR256GFX[id].loading = true;
+
+	// Y añade la carga a la cola
+	static const char* const extensions[] = { "img" };
+	return NF_LoaderQueue(file, extensions, 1, NF_StoreSpriteGfx, id);
 
 }
 
@@ -241,6 +259,9 @@ void NF_UnloadSpriteGfx(u16 id) {
 		NF_Error(110, "Sprite GFX", id);
 	}
 
+	// Si aun se esta cargando, termina la carga
+	if (NF_SPR256GFX[id].loading) NF_LoaderWaitAll();
+
 	// Vacia el buffer
 	free(NF_BUFFER_SPR256GFX[id]);
 
@@ -272,34 +293,15 @@ void NF_LoadSpritePal(const char* file, u8 id) {
 	free(NF_BUFFER_SPR256PAL[id]);
 	NF_BUFFER_SPR256PAL[id] = NULL;
 
-	// Declara los punteros a los ficheros
-	FILE* file_id;
-
 	// Variable para almacenar el path al archivo
 	char filename[256];
 
-	// Carga el archivo .PAL
+	// Carga el archivo .PAL (como minimo de 512 bytes)
 	snprintf(filename, sizeof(filename), "%s/%s.pal", NF_ROOTFOLDER, file);
-	file_id = fopen(filename, "rb");
-	if (file_id) {	// Si el archivo existe...
-		// Obten el tamaño del archivo
-		fseek(file_id, 0, SEEK_END);
-		pal_size = ftell(file_id);
-		NF_SPR256PAL[id].size = pal_size;
-		rewind(file_id);
-		// Si el tamaño es inferior a 512 bytes, ajustalo
-		if (NF_SPR256PAL[id].size < 512) NF_SPR256PAL[id].size = 512;
-		// Reserva el espacio en RAM
-		NF_BUFFER_SPR256PAL[id] = (char*) calloc (NF_SPR256PAL[id].size, sizeof(char));
-		if (NF_BUFFER_SPR256PAL[id] == NULL) {		// Si no hay suficiente RAM libre
-			NF_Error(102, NULL, NF_SPR256PAL[id].size);
-		}
-		// Lee el archivo y ponlo en la RAM
-		fread(NF_BUFFER_SPR256PAL[id], 1, pal_size, file_id);
-	} else {	// Si el archivo no existe...
-		NF_Error(101, filename, 0);
-	}
-	fclose(file_id);		// Cierra el archivo
+	NF_FileLoad(filename, &NF_BUFFER_SPR256PAL[id], &pal_size, 512);
+	NF_SPR256PAL[id].size = pal_size;
+	// Si el tamaño es inferior a 512 bytes, ajustalo
+	if (NF_SPR256PAL[id].size < 512) NF_SPR256PAL[id].size = 512;
 
 	// Y marca esta ID como usada
 	NF_SPR256PAL[id].available = false;
@@ -340,6 +342,9 @@ void NF_VramSpriteGfx(u8 screen, u16 ram, u16 vram, bool keepframes) {
 		NF_Error(110, "Sprite GFX", ram);
 	}
 
+	// Si aun se esta cargando, termina la carga
+	if (NF_SPR256GFX[ram].loading) NF_LoaderWaitAll();
+
 	// Verifica el rango de Id's de VRAM
 	if (vram > 127) {
 		NF_Error(106, "VRAM GFX", 127);
@@ -883,14 +888,12 @@ void NF_SpriteUpdatePalette(u8 screen, u8 pal) {
 	// Actualiza la paleta en VRAM
 	if (screen == 0) {
 		address = (0x06890000) + (pal << 9);			// Calcula donde guardaras la paleta
-		vramSetBankF(VRAM_F_LCD);					// Bloquea el banco F para escribir las paletas
-		NF_DmaMemCopy((void*)address, NF_BUFFER_SPR256PAL[slot], NF_SPR256PAL[slot].size);	// Copia la paleta al banco F
-		vramSetBankF(VRAM_F_SPRITE_EXT_PALETTE);	// Pon el banco F en modo paleta extendida
+		// Copia la paleta al banco F (se mapea como LCD durante la copia)
+		NF_QueueVramBankCopy(&VRAM_F_CR, (void*)address, NF_BUFFER_SPR256PAL[slot], NF_SPR256PAL[slot].size);
 	} else {
 		address = (0x068A0000) + (pal << 9);			// Calcula donde guardaras la paleta
-		vramSetBankI(VRAM_I_LCD);					// Bloquea el banco I para escribir las paletas
-		NF_DmaMemCopy((void*)address, NF_BUFFER_SPR256PAL[slot], NF_SPR256PAL[slot].size);	// Copia la paleta al banco I
-		vramSetBankI(VRAM_I_SUB_SPRITE_EXT_PALETTE);	// Pon el banco I en modo paleta extendida
+		// Copia la paleta al banco I (se mapea como LCD durante la copia)
+		NF_QueueVramBankCopy(&VRAM_I_CR, (void*)address, NF_BUFFER_SPR256PAL[slot], NF_SPR256PAL[slot].size);
 	}
 
 }
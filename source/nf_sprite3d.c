@@ -12,6 +12,7 @@
 
 #include "nf_3d.h"
 #include "nf_basic.h"
+#include "nf_loader.h"
 #include "nf_sprite256.h"
 #include "nf_sprite3d.h"
 
@@ -130,6 +131,9 @@ void NF_Vram3dSpriteGfx(u16 ram, u16 vram, bool keepframes) {
 		NF_Error(110, "Sprite GFX", ram);
 	}
 
+	// Si aun se esta cargando, termina la carga
+	if (NF_SPR256GFX[ram].loading) NF_LoaderWaitAll();
+
 	// Verifica el rango de Id's de VRAM
 	if (vram >= NF_3DSPRITES) {
 		NF_Error(106, "VRAM GFX", (NF_3DSPRITES - 1));
@@ -779,8 +783,7 @@ void NF_Update3dSpritesGfx(void) {
 	if (NF_CREATED_3DSPRITE.total > 0) {
 
 		// Si es necesario, actualiza las texturas de la RAM a la VRAM
-		// Bloquea el banco de VRAM (modo LCD) para permitir la escritura
-		vramSetBankB(VRAM_B_LCD);
+		// El banco B se mapea como LCD durante cada copia
 
 		// Busca los frames a actualizar
 		for (n = 0; n < NF_CREATED_3DSPRITE.total; n ++) {
@@ -797,15 +800,12 @@ void NF_Update3dSpritesGfx(void) {
 				source = NF_BUFFER_SPR256GFX[ramid] + (NF_3DSPRITE[id].framesize * NF_3DSPRITE[id].newframe);
 				destination = NF_TEX256VRAM[NF_3DSPRITE[id].gfxid].address;
 				// Copialo
-				NF_DmaMemCopy((void*)destination, source, NF_3DSPRITE[id].framesize);
+				NF_QueueVramBankCopy(&VRAM_B_CR, (void*)destination, source, NF_3DSPRITE[id].framesize);
 				// Y actualiza el frame actual
 				NF_3DSPRITE[id].frame = NF_3DSPRITE[id].newframe;
 			}
 		}
 
-		// Restaura el banco de VRAM en modo Textura
-		vramSetBankB(VRAM_B_TEXTURE_SLOT1);			// Banco B de la VRAM para Texturas (128kb)
-
 	}
 
 }
@@ -962,9 +962,8 @@ void NF_3dSpriteUpdatePalette(u8 pal) {
 
 	// Actualiza la paleta en VRAM
 	u32 address = (0x06890000) + (pal << 9);			// Calcula donde guardaras la paleta
-	vramSetBankF(VRAM_F_LCD);			// Bloquea el banco F para escribir las paletas
-	NF_DmaMemCopy((void*)address, NF_BUFFER_SPR256PAL[slot], NF_SPR256PAL[slot].size);	// Copia la paleta al banco F
-	vramSetBankF(VRAM_F_TEX_PALETTE);	// Banco F de la VRAM para paletas extendidas (Texturas)
+	// Copia la paleta al banco F (se mapea como LCD durante la copia)
+	NF_QueueVramBankCopy(&VRAM_F_CR, (void*)address, NF_BUFFER_SPR256PAL[slot], NF_SPR256PAL[slot].size);
 
 }
 
@@ -38,19 +38,7 @@ void NF_InitTextSys(u8 screen) {
 void NF_LoadTextFont(const char* file, const char* name, u16 width, u16 height, u8 rotation) {
 
 	// Busca un slot libre
-	u16 n = 0;
-	u8 slot = 255;
-	for (n = 0; n < NF_SLOTS_TBG; n ++) {		// Busca en todos los slots
-		if (NF_TILEDBG[n].available) {			// Si esta libre
-			NF_TILEDBG[n].available = false;	// Marcalo como en uso
-			slot = n;							// Guarda el slot a usar
-			n = NF_SLOTS_TBG;					// Deja de buscar
-		}
-	}
-	// Si no hay ningun slot libre, error
-	if (slot == 255) {
-		NF_Error(103, "Tiled Bg", NF_SLOTS_TBG);
-	}
+	u8 slot = NF_AllocTiledBgSlot();
 
 	// Verifica que el fondo sea multiplo de 256px (32 tiles)
 	if (((width % 256) != 0) || ((height % 256) != 0)) {
@@ -65,32 +53,18 @@ void NF_LoadTextFont(const char* file, const char* name, u16 width, u16 height,
 	free(NF_BUFFER_BGPAL[slot]);		// Buffer para los paletas
 	NF_BUFFER_BGPAL[slot] = NULL;
 
-	// Declara los punteros a los ficheros
-	FILE* file_id;
-
 	// Variable para almacenar el path al archivo
 	char filename[256];
 
-	// Carga el archivo .FNT
+	// Carga el archivo .FNT (si esta comprimido, se descomprime)
 	snprintf(filename, sizeof(filename), "%s/%s.fnt", NF_ROOTFOLDER, file);
-	file_id = fopen(filename, "rb");
-	if (file_id) {	// Si el archivo existe...
-		// Obten el tamaño del archivo
-		NF_TILEDBG[slot].tilesize = (NF_TEXT_FONT_CHARS << 6);		// 100 caracteres x 64 bytes
-		// Reserva el espacio en RAM
-		NF_BUFFER_BGTILES[slot] = (char*) calloc (NF_TILEDBG[slot].tilesize, sizeof(char));
-		if (NF_BUFFER_BGTILES[slot] == NULL) {		// Si no hay suficiente RAM libre
-			NF_Error(102, NULL, NF_TILEDBG[slot].tilesize);
-		}
-		fread(NF_BUFFER_BGTILES[slot], 1, NF_TILEDBG[slot].tilesize, file_id);	// Lee el resto de caracteres de la fuente
-	} else {	// Si el archivo no existe...
-		NF_Error(101, filename, 0);
-	}
-	fclose(file_id);		// Cierra el archivo
+	u32 font_size = 0;
+	NF_TILEDBG[slot].tilesize = (NF_TEXT_FONT_CHARS << 6);		// 100 caracteres x 64 bytes
+	NF_FileLoad(filename, &NF_BUFFER_BGTILES[slot], &font_size, NF_TILEDBG[slot].tilesize);
 
 	// Rota los Gfx de los tiles si es necesario
 	if (rotation > 0) {
-		for (n = 0; n < NF_TEXT_FONT_CHARS; n ++) {
+		for (int n = 0; n < NF_TEXT_FONT_CHARS; n ++) {
 			NF_RotateTileGfx(slot, n, rotation);
 		}
 	}
@@ -108,26 +82,10 @@ void NF_LoadTextFont(const char* file, const char* name, u16 width, u16 height,
 
 	// Carga el archivo .PAL
 	snprintf(filename, sizeof(filename), "%s/%s.pal", NF_ROOTFOLDER, file);
-	file_id = fopen(filename, "rb");
-	if (file_id) {	// Si el archivo existe...
-		// Obten el tamaño del archivo
-		fseek(file_id, 0, SEEK_END);
-		NF_TILEDBG[slot].palsize = ftell(file_id);
-		rewind(file_id);
-		// Reserva el espacio en RAM
-		NF_BUFFER_BGPAL[slot] = (char*) calloc (NF_TILEDBG[slot].palsize, sizeof(char));
-		if (NF_BUFFER_BGPAL[slot] == NULL) {		// Si no hay suficiente RAM libre
-			NF_Error(102, NULL, NF_TILEDBG[slot].palsize);
-		}
-		// Lee el archivo y ponlo en la RAM
-		fread(NF_BUFFER_BGPAL[slot], 1, NF_TILEDBG[slot].palsize, file_id);
-	} else {	// Si el archivo no existe...
-		NF_Error(101, filename, 0);
-	}
-	fclose(file_id);		// Cierra el archivo
+	NF_FileLoad(filename, &NF_BUFFER_BGPAL[slot], &NF_TILEDBG[slot].palsize, 0);
 
 	// Guarda el nombre del Fondo
-	snprintf(NF_TILEDBG[slot].name, sizeof(NF_TILEDBG[slot].name), "%s", name);
+	NF_SetTiledBgName(slot, name);
 
 	// Y las medidas
 	NF_TILEDBG[slot].width = width;
@@ -141,20 +99,11 @@ void NF_UnloadTextFont(const char* name) {
 
 void NF_CreateTextLayer(u8 screen, u8 layer, u8 rotation, const char* name) {
 
-	u8 slot = 255;		// Slot seleccionado
-	char bg[32];		// Nombre
+	// Busca el numero de slot donde esta cargada la fuente
+	u8 slot = NF_GetTiledBgSlot(name);
 
 	// Crea un  fondo para usarlo como capa de texto
-	NF_CreateTiledBg(screen, layer, name);
-
-	// Busca el numero de slot donde esta cargada la fuente
-	snprintf(bg, sizeof(bg), "%s", name);				// Obten el nombre del fondo a buscar
-	for (int n = 0; n < NF_SLOTS_TBG; n ++) {			// Busca en todos los slots
-		if (strcmp(bg, NF_TILEDBG[n].name) == 0) {		// Si lo encuentras
-			slot = n;									// Guarda el slot a usar
-			n = NF_SLOTS_TBG;							// Deja de buscar
-		}
-	}
+	NF_CreateTiledBgBySlot(screen, layer, slot);
 
 	// Guarda si el texto debe ser rotado
 	NF_TEXT[screen][layer].rotation = rotation;
@@ -412,6 +361,7 @@ void NF_ClearTextLayer(u8 screen, u8 layer) {
 
 	// Pon a 0 todos los bytes del mapa de la capa de texto
 	memset(NF_BUFFER_BGMAP[NF_TEXT[screen][layer].slot], 0, size);
+	NF_MarkVramMapDirty(screen, layer);
 
 	// Marca esta capa de texto para actualizar
 	NF_TEXT[screen][layer].update = true;
@@ -6,6 +6,7 @@
 // http://www.nightfoxandco.com/
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 
@@ -13,6 +14,7 @@
 
 #include "nf_2d.h"
 #include "nf_basic.h"
+#include "nf_loader.h"
 #include "nf_tiledbg.h"
 
 
@@ -24,18 +26,36 @@ u8 NF_BANKS_MAPS[2];	// (1 bank = 2kb)	Usar multiplos de 8. Cada set de 8 bancos
 char* NF_BUFFER_BGTILES[NF_SLOTS_TBG];
 char* NF_BUFFER_BGMAP[NF_SLOTS_TBG];
 char* NF_BUFFER_BGPAL[NF_SLOTS_TBG];
+char* NF_BUFFER_BGMETA[NF_SLOTS_TBG];		// Diccionario de metatiles
+u16* NF_BUFFER_BGMETAREFS[NF_SLOTS_TBG];	// Usos de cada metatile en el mapa
 
 // Define la estructura de propiedades de los fondos
 NF_TYPE_TBG_INFO NF_TILEDBG[NF_SLOTS_TBG];			// Info de los fondos cargados en RAM
 NF_TYPE_TBGLAYERS_INFO NF_TILEDBG_LAYERS[2][4];		// Info de los fondos en pantalla
 
+// Define el indice de nombres y el mapa de bits de slots libres
+u8 NF_TILEDBG_HASHTABLE[NF_TILEDBG_HASH_BUCKETS];		// Primer slot de cada bucket
+u32 NF_TILEDBG_FREESLOTS[(NF_SLOTS_TBG + 31) >> 5];	// 1 bit por slot (1 = libre)
+
 // Define la estructura para las paletas extendidas
 NF_TYPE_EXBGPAL_INFO NF_EXBGPAL[NF_SLOTS_EXBGPAL];	// Datos de las paletas extendidas
 
+// Define la estructura para las animaciones de tiles
+NF_TYPE_TBGANIM_INFO NF_TBGANIM[NF_SLOTS_TBGANIM];	// Grupos de tiles animados
+
 // Define el array de bloques libres
 u8 NF_TILEBLOCKS[2][NF_MAX_BANKS_TILES];
 u8 NF_MAPBLOCKS[2][NF_MAX_BANKS_MAPS];
 
+// Bytes de mapas copiados a VRAM
+u32 NF_TILEDBG_UPLOAD_BYTES;
+
+// Guarda en un slot los archivos de un fondo cargados de forma incremental
+static void NF_StoreTiledBg(u32 slot, char** buffers, u32* sizes);
+
+// Expande un bloque de 32x32 tiles de un mapa de metatiles
+static void NF_ExpandMetatileBlock(u8 slot, u16* destination, u32 block_x, u32 block_y);
+
 
 void NF_InitTiledBgBuffers(void) {
 	// Buffers de fondos tileados
@@ -43,13 +63,31 @@ void NF_InitTiledBgBuffers(void) {
 		NF_BUFFER_BGTILES[n] = NULL;		// Buffer para los tiles
 		NF_BUFFER_BGMAP[n] = NULL;			// Buffer para el map
 		NF_BUFFER_BGPAL[n] = NULL;			// Buffer para la paleta
+		NF_BUFFER_BGMETA[n] = NULL;			// Diccionario de metatiles
+		NF_BUFFER_BGMETAREFS[n] = NULL;		// Usos de cada metatile
 		snprintf(NF_TILEDBG[n].name, sizeof(NF_TILEDBG[n].name), "xxxNONAMExxx");
 		NF_TILEDBG[n].tilesize = 0;			// Tamaño del Tileset
 		NF_TILEDBG[n].mapsize = 0;			// Tamaño del Mapa
 		NF_TILEDBG[n].palsize = 0;			// Tamaño de la Paleta
 		NF_TILEDBG[n].width = 0;			// Ancho del Mapa
 		NF_TILEDBG[n].height = 0;			// Alto del Mapa
+		NF_TILEDBG[n].namehash = 0;			// Hash del nombre
+		NF_TILEDBG[n].hashnext = 255;		// Siguiente slot del bucket
 		NF_TILEDBG[n].available = true;		// Disponibilidad
+		NF_TILEDBG[n].loading = false;		// No se esta cargando
+		NF_TILEDBG[n].bpp = 8;				// Tiles de 256 colores
+		NF_TILEDBG[n].metashift = 0;		// Sin metatiles
+		NF_TILEDBG[n].metacount = 0;
+		NF_TILEDBG[n].deduped = false;		// Tiles sin deduplicar
+	}
+	// Indice de nombres vacio
+	for (int n = 0; n < NF_TILEDBG_HASH_BUCKETS; n ++) {
+		NF_TILEDBG_HASHTABLE[n] = 255;
+	}
+	// Todos los slots libres
+	memset(NF_TILEDBG_FREESLOTS, 0, sizeof(NF_TILEDBG_FREESLOTS));
+	for (int n = 0; n < NF_SLOTS_TBG; n ++) {
+		NF_TILEDBG_FREESLOTS[n >> 5] |= BIT(n & 31);
 	}
 	// Buffers de paletas extendidas
 	for (int n = 0; n < NF_SLOTS_EXBGPAL; n ++) {
@@ -57,15 +95,23 @@ void NF_InitTiledBgBuffers(void) {
 		NF_EXBGPAL[n].palsize = 0;
 		NF_EXBGPAL[n].inuse = false;
 	}
+	// Animaciones de tiles
+	for (int n = 0; n < NF_SLOTS_TBGANIM; n ++) {
+		NF_TBGANIM[n].inuse = false;
+	}
 
 }
 
 void NF_ResetTiledBgBuffers(void) {
+	// Cancela las cargas pendientes
+	NF_LoaderCancel(NF_StoreTiledBg);
 	// Inicializa todos los slots
 	for (int n = 0; n < NF_SLOTS_TBG; n ++) {
 		free(NF_BUFFER_BGTILES[n]);			// Vacia el Buffer para los tiles
 		free(NF_BUFFER_BGMAP[n]);			// Vacia Buffer para el map
 		free(NF_BUFFER_BGPAL[n]);			// Vacia Buffer para la paleta
+		free(NF_BUFFER_BGMETA[n]);			// Vacia el diccionario de metatiles
+		free(NF_BUFFER_BGMETAREFS[n]);
 	}
 	for (int n = 0; n < NF_SLOTS_EXBGPAL; n ++) {
 		NF_EXBGPAL[n].buffer = NULL;
@@ -109,7 +155,13 @@ void NF_InitTiledBgSys(u8 screen) {
 		NF_TILEDBG_LAYERS[screen][n].bgslot = 0;		// Buffer de graficos usado
 		NF_TILEDBG_LAYERS[screen][n].blockx = 0;		// Bloque de mapa actual (horizontal)
 		NF_TILEDBG_LAYERS[screen][n].blocky = 0;		// Bloque de mapa actual (vertical)
+		NF_TILEDBG_LAYERS[screen][n].streamx = 0xFFFF;	// Ventana del streaming (ninguna)
+		NF_TILEDBG_LAYERS[screen][n].streamy = 0;
+		NF_TILEDBG_LAYERS[screen][n].streaming = false;	// Sin streaming de filas y columnas
 		NF_TILEDBG_LAYERS[screen][n].created = false;	// Esta creado ?
+		memset(NF_TILEDBG_LAYERS[screen][n].dirtyrows, 0, sizeof(NF_TILEDBG_LAYERS[screen][n].dirtyrows));	// Sin cambios pendientes
+		free(NF_TILEDBG_LAYERS[screen][n].staging);		// Buffer de bloques de metatiles
+		NF_TILEDBG_LAYERS[screen][n].staging = NULL;
 	}
 
 	// Ahora reserva los bancos necesarios de VRAM para mapas
@@ -144,26 +196,89 @@ void NF_InitTiledBgSys(u8 screen) {
 
 }
 
-void NF_LoadTiledBg(const char* file, const char* name, u16 width, u16 height) {
+// Calcula el hash (FNV-1a) de un nombre, limitado a la longitud que se guarda
+static u32 NF_TiledBgNameHash(const char* name) {
+	u32 hash = 2166136261u;
+	for (u32 n = 0; (n < (sizeof(NF_TILEDBG[0].name) - 1)) && (name[n] != '\0'); n ++) {
+		hash ^= (u8)name[n];
+		hash *= 16777619u;
+	}
+	return hash;
+}
 
-	// Variable temporal del tamaño de la paleta
-	u32 pal_size = 0;
+// Quita un slot del indice de nombres
+static void NF_TiledBgUnlinkName(u8 slot) {
+	u8* link = &NF_TILEDBG_HASHTABLE[NF_TILEDBG[slot].namehash & (NF_TILEDBG_HASH_BUCKETS - 1)];
+	while (*link != 255) {
+		if (*link == slot) {
+			*link = NF_TILEDBG[slot].hashnext;
+			break;
+		}
+		link = &NF_TILEDBG[*link].hashnext;
+	}
+	NF_TILEDBG[slot].hashnext = 255;
+}
 
-	// Busca un slot libre
-	u8 n = 0;
-	u8 slot = 255;
-	for (n = 0; n < NF_SLOTS_TBG; n ++) {		// Busca en todos los slots
-		if (NF_TILEDBG[n].available) {			// Si esta libre
-			NF_TILEDBG[n].available = false;	// Marcalo como en uso
-			slot = n;							// Guarda el slot a usar
-			n = NF_SLOTS_TBG;					// Deja de buscar
+u8 NF_AllocTiledBgSlot(void) {
+
+	// Busca el primer slot libre en el mapa de bits
+	for (u32 n = 0; n < ((NF_SLOTS_TBG + 31) >> 5); n ++) {
+		if (NF_TILEDBG_FREESLOTS[n] != 0) {
+			u8 slot = (n << 5) + __builtin_ctz(NF_TILEDBG_FREESLOTS[n]);
+			NF_TILEDBG_FREESLOTS[n] &= ~BIT(slot & 31);	// Marcalo como en uso
+			NF_TILEDBG[slot].available = false;
+			return slot;
 		}
 	}
+
 	// Si no hay ningun slot libre, error
-	if (slot == 255) {
-		NF_Error(103, "Tiled Bg", NF_SLOTS_TBG);
+	NF_Error(103, "Tiled Bg", NF_SLOTS_TBG);
+
+}
+
+void NF_SetTiledBgName(u8 slot, const char* name) {
+
+	// Si el slot ya estaba en el indice, quitalo
+	NF_TiledBgUnlinkName(slot);
+
+	// Guarda el nombre del Fondo y su hash
+	snprintf(NF_TILEDBG[slot].name, sizeof(NF_TILEDBG[slot].name), "%s", name);
+	NF_TILEDBG[slot].namehash = NF_TiledBgNameHash(name);
+
+	// Insertalo en su bucket, ordenado por slot (el primero tiene prioridad)
+	u8* link = &NF_TILEDBG_HASHTABLE[NF_TILEDBG[slot].namehash & (NF_TILEDBG_HASH_BUCKETS - 1)];
+	while ((*link != 255) && (*link < slot)) {
+		link = &NF_TILEDBG[*link].hashnext;
+	}
+	NF_TILEDBG[slot].hashnext = *link;
+	*link = slot;
+
+}
+
+u8 NF_GetTiledBgSlot(const char* name) {
+
+	// Busca el fondo solicitado en su bucket del indice
+	u32 hash = NF_TiledBgNameHash(name);
+	u8 slot = NF_TILEDBG_HASHTABLE[hash & (NF_TILEDBG_HASH_BUCKETS - 1)];
+	while (slot != 255) {
+		if ((NF_TILEDBG[slot].namehash == hash)
+		&& (strncmp(name, NF_TILEDBG[slot].name, sizeof(NF_TILEDBG[slot].name) - 1) == 0)) {
+			return slot;
+		}
+		slot = NF_TILEDBG[slot].hashnext;
 	}
 
+	// Si no se encuentra, error
+	NF_Error(104, name, 0);
+
+}
+
+// Reserva un slot para un fondo y guarda su nombre, medidas y bits por pixel
+static u8 NF_ReserveTiledBg(const char* file, const char* name, u16 width, u16 height, u8 bpp) {
+
+	// Busca un slot libre
+	u8 slot = NF_AllocTiledBgSlot();
+
 	// Verifica que el fondo sea multiplo de 256px (32 tiles)
 	if (((width % 256) != 0) || ((height % 256) != 0)) {
 		NF_Error(115, file, 0);
@@ -177,151 +292,182 @@ void NF_LoadTiledBg(const char* file, const char* name, u16 width, u16 height) {
 	free(NF_BUFFER_BGPAL[slot]);		// Buffer para los paletas
 	NF_BUFFER_BGPAL[slot] = NULL;
 
-	// Declara los punteros a los ficheros
-	FILE* file_id;
+	// Guarda el nombre del Fondo
+	NF_SetTiledBgName(slot, name);
+
+	// Y las medidas
+	NF_TILEDBG[slot].width = width;
+	NF_TILEDBG[slot].height = height;
+	NF_TILEDBG[slot].bpp = bpp;
+	NF_TILEDBG[slot].deduped = false;
+
+	return slot;
+
+}
+
+// Guarda en un slot los archivos .IMG, .MAP y .PAL ya cargados de un fondo
+static void NF_StoreTiledBg(u32 slot, char** buffers, u32* sizes) {
+
+	// Tileset
+	NF_BUFFER_BGTILES[slot] = buffers[0];
+	NF_TILEDBG[slot].tilesize = sizes[0];
+
+	// Mapa (ajusta el tamaño a bloques de 2kb)
+	u32 map_size = ((((sizes[1] - 1) >> 11) + 1) << 11);
+	NF_FileUnpack(&buffers[1], &sizes[1], map_size, false);
+	NF_BUFFER_BGMAP[slot] = buffers[1];
+	NF_TILEDBG[slot].mapsize = map_size;
+
+	// Paleta (el buffer es como minimo de 512 bytes)
+	NF_FileUnpack(&buffers[2], &sizes[2], 512, false);
+	NF_BUFFER_BGPAL[slot] = buffers[2];
+	if (NF_TILEDBG[slot].bpp == 4) {
+		// En 16 colores solo se copian las paletas del archivo (hasta 16)
+		NF_TILEDBG[slot].palsize = (sizes[2] > 512) ? 512 : sizes[2];
+	} else {
+		NF_TILEDBG[slot].palsize = (sizes[2] < 512) ? 512 : sizes[2];
+	}
+
+	// Ya se puede usar
+	NF_TILEDBG[slot].loading = false;
+
+}
+
+// Extensiones de los archivos de un fondo, en el orden de NF_StoreTiledBg()
+static const char* const NF_TILEDBG_EXTENSIONS[] = { "img", "map", "pal" };
+
+// Carga los archivos de un fondo con la profundidad de color indicada
+static void NF_LoadTiledBgFiles(const char* file, const char* name, u16 width, u16 height, u8 bpp) {
+
+	// Reserva el slot
+	u8 slot = NF_ReserveTiledBg(file, name, width, height, bpp);
 
 	// Variable para almacenar el path al archivo
 	char filename[256];
 
-	// Carga el archivo .IMG
-	snprintf(filename, sizeof(filename), "%s/%s.img", NF_ROOTFOLDER, file);
-	file_id = fopen(filename, "rb");
-	if (file_id) {	// Si el archivo existe...
-		// Obten el tamaño del archivo
-		fseek(file_id, 0, SEEK_END);
-		NF_TILEDBG[slot].tilesize = ftell(file_id);
-		rewind(file_id);
-		// Reserva el espacio en RAM
-		NF_BUFFER_BGTILES[slot] = (char*) calloc (NF_TILEDBG[slot].tilesize, sizeof(char));
-		if (NF_BUFFER_BGTILES[slot] == NULL) {		// Si no hay suficiente RAM libre
-			NF_Error(102, NULL, NF_TILEDBG[slot].tilesize);
-		}
-		// Lee el archivo y ponlo en la RAM
-		fread(NF_BUFFER_BGTILES[slot], 1, NF_TILEDBG[slot].tilesize, file_id);
-	} else {	// Si el archivo no existe...
-		NF_Error(101, filename, 0);
-	}
-	fclose(file_id);		// Cierra el archivo
-
-	// Carga el archivo .MAP
-	snprintf(filename, sizeof(filename), "%s/%s.map", NF_ROOTFOLDER, file);
-	file_id = fopen(filename, "rb");
-	if (file_id) {	// Si el archivo existe...
-		// Obten el tamaño del archivo
-		fseek(file_id, 0, SEEK_END);
-		NF_TILEDBG[slot].mapsize = ((((ftell(file_id) - 1) >> 11) + 1) << 11);	// Ajusta el tamaño a bloques de 2kb
-		rewind(file_id);
-		// Reserva el espacio en RAM
-		NF_BUFFER_BGMAP[slot] = (char*) calloc (NF_TILEDBG[slot].mapsize, sizeof(char));
-		if (NF_BUFFER_BGMAP[slot] == NULL) {		// Si no hay suficiente RAM libre
-			NF_Error(102, NULL, NF_TILEDBG[slot].mapsize);
-		}
-		// Lee el archivo y ponlo en la RAM
-		fread(NF_BUFFER_BGMAP[slot], 1, NF_TILEDBG[slot].mapsize, file_id);
-	} else {	// Si el archivo no existe...
-		NF_Error(101, filename, 0);
+	// Carga los archivos .IMG, .MAP y .PAL (si estan comprimidos, se descomprimen)
+	char* buffers[3];
+	u32 sizes[3];
+	for (int n = 0; n < 3; n ++) {
+		snprintf(filename, sizeof(filename), "%s/%s.%s", NF_ROOTFOLDER, file, NF_TILEDBG_EXTENSIONS[n]);
+		NF_FileLoad(filename, &buffers[n], &sizes[n], 0);
 	}
-	fclose(file_id);		// Cierra el archivo
 
-	// Carga el archivo .PAL
-	snprintf(filename, sizeof(filename), "%s/%s.pal", NF_ROOTFOLDER, file);
-	file_id = fopen(filename, "rb");
-	if (file_id) {	// Si el archivo existe...
-		// Obten el tamaño del archivo
-		fseek(file_id, 0, SEEK_END);
-		pal_size = ftell(file_id);
-		NF_TILEDBG[slot].palsize = pal_size;
-		rewind(file_id);
-		// Si el tamaño es inferior a 512 bytes, ajustalo
-		if (NF_TILEDBG[slot].palsize < 512) NF_TILEDBG[slot].palsize = 512;
-		// Reserva el espacio en RAM
-		NF_BUFFER_BGPAL[slot] = (char*) calloc (NF_TILEDBG[slot].palsize, sizeof(char));
-		if (NF_BUFFER_BGPAL[slot] == NULL) {		// Si no hay suficiente RAM libre
-			NF_Error(102, NULL, NF_TILEDBG[slot].palsize);
-		}
-		// Lee el archivo y ponlo en la RAM
-		fread(NF_BUFFER_BGPAL[slot], 1, pal_size, file_id);
-	} else {	// Si el archivo no existe...
-		NF_Error(101, filename, 0);
-	}
-	fclose(file_id);		// Cierra el archivo
+	// Guardalos en el slot
+	NF_StoreTiledBg(slot, buffers, sizes);
 
-	// Guarda el nombre del Fondo
-	snprintf(NF_TILEDBG[slot].name, sizeof(NF_TILEDBG[slot].name), "%s", name);
+}
 
-	// Y las medidas
-	NF_TILEDBG[slot].width = width;
-	NF_TILEDBG[slot].height = height;
+void NF_LoadTiledBg(const char* file, const char* name, u16 width, u16 height) {
+
+	NF_LoadTiledBgFiles(file, name, width, height, 8);
 
 }
 
-void NF_LoadTilesForBg(const char* file, const char* name, u16 width, u16 height, u16 tile_start, u16 tile_end) {
+void NF_LoadTiledBg4bpp(const char* file, const char* name, u16 width, u16 height) {
 
-	// Variable temporal del tamaño de los datos
-	u32 tile_size = 0;
-	u32 pal_size = 0;
+	NF_LoadTiledBgFiles(file, name, width, height, 4);
 
-	// Busca un slot libre
-	u8 n = 0;
-	u8 slot = 255;
-	for (n = 0; n < NF_SLOTS_TBG; n ++) {		// Busca en todos los slots
-		if (NF_TILEDBG[n].available) {			// Si esta libre
-			NF_TILEDBG[n].available = false;	// Marcalo como en uso
-			slot = n;							// Guarda el slot a usar
-			n = NF_SLOTS_TBG;					// Deja de buscar
-		}
+}
+
+void NF_LoadMetatileBg(const char* file, const char* name, u16 width, u16 height, u8 metasize) {
+
+	// Verifica el tamaño de los metatiles
+	if ((metasize != 16) && (metasize != 32)) {
+		NF_Error(106, "Metatile size", 32);
 	}
-	// Si no hay ningun slot libre, error
-	if (slot == 255) {
-		NF_Error(103, "Tiled Bg", NF_SLOTS_TBG);
+	u8 shift = (metasize == 16) ? 1 : 2;
+
+	// Carga los archivos .IMG, .MAP (indices de los metatiles) y .PAL
+	NF_LoadTiledBgFiles(file, name, width, height, 8);
+	u8 slot = NF_GetTiledBgSlot(name);
+
+	// Verifica que el mapa tiene un indice por metatile
+	u32 metas = (((width >> 3) >> shift) * ((height >> 3) >> shift));
+	if (NF_TILEDBG[slot].mapsize < (metas << 1)) {
+		NF_Error(116, file, (metas << 1));
 	}
 
-	// Verifica que el fondo sea multiplo de 256px (32 tiles)
-	if (((width % 256) != 0) || ((height % 256) != 0)) {
-		NF_Error(115, file, 0);
+	// Carga el diccionario de metatiles (.MTL)
+	char filename[256];
+	u32 size = 0;
+	snprintf(filename, sizeof(filename), "%s/%s.mtl", NF_ROOTFOLDER, file);
+	NF_FileLoad(filename, &NF_BUFFER_BGMETA[slot], &size, 0);
+	NF_TILEDBG[slot].metacount = (size >> (1 + (shift << 1)));
+	if ((NF_TILEDBG[slot].metacount == 0) || (NF_TILEDBG[slot].metacount > 0x10000)) {
+		NF_Error(116, filename, (0x10000 << (1 + (shift << 1))));
+	}
+	NF_TILEDBG[slot].metashift = shift;
+
+	// Cuenta los usos de cada metatile, verificando los indices del mapa
+	NF_BUFFER_BGMETAREFS[slot] = (u16*) calloc (NF_TILEDBG[slot].metacount, sizeof(u16));
+	if (NF_BUFFER_BGMETAREFS[slot] == NULL) {		// Si no hay suficiente RAM libre
+		NF_Error(102, NULL, (NF_TILEDBG[slot].metacount << 1));
+	}
+	u16* map = (u16*)NF_BUFFER_BGMAP[slot];
+	for (u32 n = 0; n < metas; n ++) {
+		if (map[n] >= NF_TILEDBG[slot].metacount) {
+			NF_Error(106, "Metatile", (NF_TILEDBG[slot].metacount - 1));
+		}
+		if (NF_BUFFER_BGMETAREFS[slot][map[n]] < 0xFFFF) NF_BUFFER_BGMETAREFS[slot][map[n]] ++;
 	}
 
-	// Vacia los buffers que se usaran
-	free(NF_BUFFER_BGMAP[slot]);		// Buffer para los mapas
-	NF_BUFFER_BGMAP[slot] = NULL;
-	free(NF_BUFFER_BGTILES[slot]);		// Buffer para los tiles
-	NF_BUFFER_BGTILES[slot] = NULL;
-	free(NF_BUFFER_BGPAL[slot]);		// Buffer para los paletas
-	NF_BUFFER_BGPAL[slot] = NULL;
+}
+
+// Reserva un slot para una carga asincrona y añade sus archivos a la cola
+static u32 NF_LoadTiledBgAsyncFiles(const char* file, const char* name, u16 width, u16 height, u8 bpp) {
+
+	// Reserva el slot y marcalo como en carga
+	u8 slot = NF_ReserveTiledBg(file, name, width, height, bpp);
+	NF_TILEDBG[slot].loading = true;
+
+	// Y añade la carga a la cola
+	return NF_LoaderQueue(file, NF_TILEDBG_EXTENSIONS, 3, NF_StoreTiledBg, slot);
+
+}
+
+u32 NF_LoadTiledBgAsync(const char* file, const char* name, u16 width, u16 height) {
+
+	return NF_LoadTiledBgAsyncFiles(file, name, width, height, 8);
+
+}
+
+u32 NF_LoadTiledBg4bppAsync(const char* file, const char* name, u16 width, u16 height) {
+
+	return NF_LoadTiledBgAsyncFiles(file, name, width, height, 4);
+
+}
+
+// Carga un rango de tiles y la paleta de un fondo, y crea un mapa vacio
+static void NF_LoadTilesForBgFiles(const char* file, const char* name, u16 width, u16 height, u16 tile_start, u16 tile_end, u8 bpp) {
+
+	// Variable temporal del tamaño de los datos
+	u32 tile_size = 0;
+	u32 pal_size = 0;
+
+	// Tamaño de un tile (64 bytes a 256 colores, 32 bytes a 16 colores)
+	u32 shift = (bpp == 4) ? 5 : 6;
 
-	// Declara los punteros a los ficheros
-	FILE* file_id;
+	// Reserva el slot y guarda el nombre, las medidas y los bits por pixel
+	u8 slot = NF_ReserveTiledBg(file, name, width, height, bpp);
 
 	// Variable para almacenar el path al archivo
 	char filename[256];
 
-	// Carga el archivo .IMG
+	// Carga el archivo .IMG (si esta comprimido, se descomprime)
 	snprintf(filename, sizeof(filename), "%s/%s.img", NF_ROOTFOLDER, file);
-	file_id = fopen(filename, "rb");
-	if (file_id) {	// Si el archivo existe...
-		// Obten el tamaño del archivo
-		fseek(file_id, 0, SEEK_END);
-		tile_size = ftell(file_id);
-		rewind(file_id);
-		// Calcula el tamaño del tilesize a cargar
-		NF_TILEDBG[slot].tilesize = (((tile_end - tile_start) + 1) << 6);	// nº de tiles x 64 bytes
-		// Si el tamaño del Tilesed solicitado excede del tamaño de archivo, error
-		if ((u32)((tile_end + 1) << 6) > tile_size) {
-			NF_Error(106, "Tilenumber", (tile_size >> 6));
-		}
-		// Reserva el espacio en RAM
-		NF_BUFFER_BGTILES[slot] = (char*) calloc (NF_TILEDBG[slot].tilesize, sizeof(char));
-		if (NF_BUFFER_BGTILES[slot] == NULL) {		// Si no hay suficiente RAM libre
-			NF_Error(102, NULL, NF_TILEDBG[slot].tilesize);
-		}
-		// Posicionate en la posicion donde esta el primer tile a cargar
-		fseek(file_id, (tile_start << 6), SEEK_SET);
-		// ahora lee el archivo y ponlo en la RAM
-		fread(NF_BUFFER_BGTILES[slot], 1, NF_TILEDBG[slot].tilesize, file_id);
-	} else {	// Si el archivo no existe...
-		NF_Error(101, filename, 0);
+	char* tiles = NULL;
+	NF_FileLoad(filename, &tiles, &tile_size, 0);
+	// Calcula el tamaño del tilesize a cargar
+	NF_TILEDBG[slot].tilesize = (((tile_end - tile_start) + 1) << shift);	// nº de tiles x tamaño del tile
+	// Si el tamaño del Tilesed solicitado excede del tamaño de archivo, error
+	if ((u32)((tile_end + 1) << shift) > tile_size) {
+		NF_Error(106, "Tilenumber", (tile_size >> shift));
 	}
-	fclose(file_id);		// Cierra el archivo
+	// Deja en el buffer solo los tiles solicitados
+	memmove(tiles, tiles + (tile_start << shift), NF_TILEDBG[slot].tilesize);
+	NF_BUFFER_BGTILES[slot] = realloc(tiles, NF_TILEDBG[slot].tilesize);
+	if (NF_BUFFER_BGTILES[slot] == NULL) NF_BUFFER_BGTILES[slot] = tiles;
 
 
 	// Crea un archivo .MAP vacio en RAM
@@ -336,56 +482,207 @@ void NF_LoadTilesForBg(const char* file, const char* name, u16 width, u16 height
 	memset(NF_BUFFER_BGMAP[slot], 0, NF_TILEDBG[slot].mapsize);
 
 
-	// Carga el archivo .PAL
+	// Carga el archivo .PAL (como minimo de 512 bytes)
 	snprintf(filename, sizeof(filename), "%s/%s.pal", NF_ROOTFOLDER, file);
-	file_id = fopen(filename, "rb");
-	if (file_id) {	// Si el archivo existe...
-		// Obten el tamaño del archivo
-		fseek(file_id, 0, SEEK_END);
-		pal_size = ftell(file_id);
-		NF_TILEDBG[slot].palsize = pal_size;
-		rewind(file_id);
-		// Si el tamaño es inferior a 512 bytes, ajustalo
-		if (NF_TILEDBG[slot].palsize < 512) NF_TILEDBG[slot].palsize = 512;
-		// Reserva el espacio en RAM
-		NF_BUFFER_BGPAL[slot] = (char*) calloc (NF_TILEDBG[slot].palsize, sizeof(char));
-		if (NF_BUFFER_BGPAL[slot] == NULL) {		// Si no hay suficiente RAM libre
-			NF_Error(102, NULL, NF_TILEDBG[slot].palsize);
+	NF_FileLoad(filename, &NF_BUFFER_BGPAL[slot], &pal_size, 512);
+	NF_TILEDBG[slot].palsize = pal_size;
+	// Si el tamaño es inferior a 512 bytes, ajustalo
+	if (NF_TILEDBG[slot].palsize < 512) NF_TILEDBG[slot].palsize = 512;
+
+}
+
+void NF_LoadTilesForBg(const char* file, const char* name, u16 width, u16 height, u16 tile_start, u16 tile_end) {
+
+	NF_LoadTilesForBgFiles(file, name, width, height, tile_start, tile_end, 8);
+
+}
+
+void NF_LoadTilesForBg4bpp(const char* file, const char* name, u16 width, u16 height, u16 tile_start, u16 tile_end) {
+
+	NF_LoadTilesForBgFiles(file, name, width, height, tile_start, tile_end, 4);
+
+}
+
+// Hash de un tile de 8x8 pixeles (64 bytes a 256 colores, 32 bytes a 16 colores)
+static u32 NF_TileHash(const u8* tile, u32 size) {
+	u32 hash = 2166136261u;
+	for (u32 n = 0; n < size; n ++) {
+		hash ^= tile[n];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+// Copia un tile aplicando el volteo indicado (bit 0 horizontal, bit 1 vertical)
+static void NF_FlipTile(u8* destination, const u8* source, u32 flip, u8 bpp) {
+	if (bpp == 4) {
+		// 4 bytes por linea, el nibble bajo es el pixel de la izquierda
+		for (u32 y = 0; y < 8; y ++) {
+			u32 sy = (flip & 2) ? (7 - y) : y;
+			for (u32 x = 0; x < 4; x ++) {
+				if (flip & 1) {
+					u8 pixels = source[(sy << 2) + (3 - x)];
+					destination[(y << 2) + x] = (pixels >> 4) | (pixels << 4);
+				} else {
+					destination[(y << 2) + x] = source[(sy << 2) + x];
+				}
+			}
+		}
+		return;
+	}
+	for (u32 y = 0; y < 8; y ++) {
+		u32 sy = (flip & 2) ? (7 - y) : y;
+		for (u32 x = 0; x < 8; x ++) {
+			u32 sx = (flip & 1) ? (7 - x) : x;
+			destination[(y << 3) + x] = source[(sy << 3) + sx];
 		}
-		// Lee el archivo y ponlo en la RAM
-		fread(NF_BUFFER_BGPAL[slot], 1, pal_size, file_id);
-	} else {	// Si el archivo no existe...
-		NF_Error(101, filename, 0);
 	}
-	fclose(file_id);		// Cierra el archivo
+}
 
-	// Guarda el nombre del Fondo
-	snprintf(NF_TILEDBG[slot].name, sizeof(NF_TILEDBG[slot].name), "%s", name);
+// Devuelve las entradas de mapa de un fondo: el diccionario de metatiles si
+// los usa, o el mapa completo si no
+static u16* NF_TiledBgEntries(u8 slot, u32* count) {
 
-	// Y las medidas
-	NF_TILEDBG[slot].width = width;
-	NF_TILEDBG[slot].height = height;
+	if (NF_TILEDBG[slot].metashift > 0) {
+		*count = (NF_TILEDBG[slot].metacount << (NF_TILEDBG[slot].metashift << 1));
+		return (u16*)NF_BUFFER_BGMETA[slot];
+	}
+
+	*count = (NF_TILEDBG[slot].mapsize >> 1);
+	return (u16*)NF_BUFFER_BGMAP[slot];
 
 }
 
-void NF_UnloadTiledBg(const char* name) {
+u32 NF_DedupTiledBg(const char* name) {
+
+	u8 slot = NF_GetTiledBgSlot(name);
+
+	// Si aun se esta cargando, termina la carga
+	if (NF_TILEDBG[slot].loading) NF_LoaderWaitAll();
+
+	// La deduplicacion mueve los tiles y reduce el tileset, lo que romperia
+	// las animaciones que usan este fondo
+	for (int n = 0; n < NF_SLOTS_TBGANIM; n ++) {
+		if (NF_TBGANIM[n].inuse && (NF_TBGANIM[n].slot == slot)) NF_Error(121, name, n);
+	}
+
+	// Tamaño de un tile (64 bytes a 256 colores, 32 bytes a 16 colores)
+	u8 bpp = NF_TILEDBG[slot].bpp;
+	u32 shift = (bpp == 4) ? 5 : 6;
+	u32 size = (1 << shift);
+
+	u32 tiles = (NF_TILEDBG[slot].tilesize >> shift);
+	if (tiles < 2) return 0;
+
+	u8* tileset = (u8*)NF_BUFFER_BGTILES[slot];
+
+	// Tabla hash de los tiles unicos (cadenas de indices, 0xFFFF = fin)
+	// remap[] guarda el tile unico en los bits 0-15 y el volteo en los bits 16-17
+	u32 buckets = 1;
+	while (buckets < tiles) buckets <<= 1;
+	u16* head = malloc(buckets * sizeof(u16));
+	u16* next = malloc(tiles * sizeof(u16));
+	u32* hashes = malloc(tiles * sizeof(u32));
+	u32* remap = malloc(tiles * sizeof(u32));
+	if ((head == NULL) || (next == NULL) || (hashes == NULL) || (remap == NULL)) {
+		NF_Error(102, NULL, ((buckets + tiles) << 1) + (tiles << 3));
+	}
+	memset(head, 0xFF, buckets * sizeof(u16));
+
+	u32 unique = 0;			// Numero de tiles unicos
+	u8 flipped[64];			// Tile volteado temporal
+
+	for (u32 n = 0; n < tiles; n ++) {
+
+		const u8* tile = tileset + (n << shift);
+		bool found = false;
+
+		// Busca el tile o alguna de sus versiones volteadas entre los tiles unicos
+		for (u32 flip = 0; (flip < 4) && !found; flip ++) {
+			const u8* test = tile;
+			if (flip != 0) {
+				NF_FlipTile(flipped, tile, flip, bpp);
+				test = flipped;
+			}
+			u32 hash = NF_TileHash(test, size);
+			for (u16 id = head[hash & (buckets - 1)]; id != 0xFFFF; id = next[id]) {
+				if ((hashes[id] == hash) && (memcmp(tileset + (id << shift), test, size) == 0)) {
+					// flip(tile) == unico, luego tile == flip(unico)
+					remap[n] = id | (flip << 16);
+					found = true;
+					break;
+				}
+			}
+		}
 
-	// Busca el fondo solicitado
-	u16 n = 0;			// Bucle
-	u8 slot = 255;		// Slot seleccionado
-	char bg[32];		// Nombre
-
-	// Busca el fondo solicitado
-	snprintf(bg, sizeof(bg), "%s", name);				// Obten el nombre del fondo a buscar
-	for (n = 0; n < NF_SLOTS_TBG; n ++) {				// Busca en todos los slots
-		if (strcmp(bg, NF_TILEDBG[n].name) == 0) {		// Si lo encuentras
-			slot = n;									// Guarda el slot a usar
-			n = NF_SLOTS_TBG;							// Deja de buscar
+		if (!found) {
+			// Tile nuevo, muevelo a su posicion definitiva y añadelo a la tabla
+			if (unique != n) memcpy(tileset + (unique << shift), tile, size);
+			hashes[unique] = NF_TileHash(tile, size);
+			u32 bucket = (hashes[unique] & (buckets - 1));
+			next[unique] = head[bucket];
+			head[bucket] = unique;
+			remap[n] = unique;
+			unique ++;
 		}
+
 	}
-	// Si no se encuentra, error
-	if (slot == 255) {
-		NF_Error(104, name, 0);
+
+	// Actualiza el mapa: indice del tile nuevo y combina los bits de volteo
+	u32 entries = 0;
+	u16* map = NF_TiledBgEntries(slot, &entries);
+	for (u32 n = 0; n < entries; n ++) {
+		u32 tile = (map[n] & 0x03FF);
+		if (tile >= tiles) continue;
+		map[n] = (map[n] & 0xF000) | ((map[n] ^ (remap[tile] >> 6)) & 0x0C00) | (remap[tile] & 0x03FF);
+	}
+
+	free(head);
+	free(next);
+	free(hashes);
+	free(remap);
+
+	// Desde ahora no se pueden crear animaciones en este fondo
+	NF_TILEDBG[slot].deduped = true;
+
+	// Reduce el tileset al nuevo tamaño
+	u32 removed = (tiles - unique);
+	if (removed > 0) {
+		NF_TILEDBG[slot].tilesize = (unique << shift);
+		char* buffer = realloc(NF_BUFFER_BGTILES[slot], NF_TILEDBG[slot].tilesize);
+		if (buffer != NULL) NF_BUFFER_BGTILES[slot] = buffer;
+	}
+
+	return removed;
+
+}
+
+void NF_UnloadTiledBg(const char* name) {
+
+	// Busca el fondo solicitado y borralo
+	NF_UnloadTiledBgBySlot(NF_GetTiledBgSlot(name));
+
+}
+
+void NF_UnloadTiledBgBySlot(u8 slot) {
+
+	// Verifica que el slot este en uso
+	if (slot >= NF_SLOTS_TBG) {
+		NF_Error(106, "Tiled Bg", (NF_SLOTS_TBG - 1));
+	}
+	if (NF_TILEDBG[slot].available) {
+		NF_Error(110, "Tiled Bg", slot);
+	}
+
+	// Si aun se esta cargando, termina la carga
+	if (NF_TILEDBG[slot].loading) NF_LoaderWaitAll();
+
+	// Quitalo del indice de nombres
+	NF_TiledBgUnlinkName(slot);
+
+	// Borra las animaciones de su tileset
+	for (int n = 0; n < NF_SLOTS_TBGANIM; n ++) {
+		if (NF_TBGANIM[n].inuse && (NF_TBGANIM[n].slot == slot)) NF_TBGANIM[n].inuse = false;
 	}
 
 	// Vacia los buffers que se usaran
@@ -395,6 +692,10 @@ void NF_UnloadTiledBg(const char* name) {
 	NF_BUFFER_BGTILES[slot] = NULL;
 	free(NF_BUFFER_BGPAL[slot]);		// Buffer para los paletas
 	NF_BUFFER_BGPAL[slot] = NULL;
+	free(NF_BUFFER_BGMETA[slot]);		// Diccionario de metatiles
+	NF_BUFFER_BGMETA[slot] = NULL;
+	free(NF_BUFFER_BGMETAREFS[slot]);	// Usos de cada metatile
+	NF_BUFFER_BGMETAREFS[slot] = NULL;
 
 	// Resetea las variables para ese fondo
 	snprintf(NF_TILEDBG[slot].name, sizeof(NF_TILEDBG[slot].name), "xxxNONAMExxx");
@@ -403,38 +704,100 @@ void NF_UnloadTiledBg(const char* name) {
 	NF_TILEDBG[slot].palsize = 0;					// Tamaño de la Paleta
 	NF_TILEDBG[slot].width = 0;						// Ancho del Mapa
 	NF_TILEDBG[slot].height = 0;					// Alto del Mapa
+	NF_TILEDBG[slot].namehash = 0;					// Hash del nombre
+	NF_TILEDBG[slot].bpp = 8;						// Tiles de 256 colores
+	NF_TILEDBG[slot].metashift = 0;					// Sin metatiles
+	NF_TILEDBG[slot].metacount = 0;
+	NF_TILEDBG[slot].deduped = false;				// Tiles sin deduplicar
 	NF_TILEDBG[slot].available = true;				// Disponibilidad
+	NF_TILEDBG_FREESLOTS[slot >> 5] |= BIT(slot & 31);	// Marcalo como libre
+
+}
 
+// Direccion de la paleta estandar de fondos de una pantalla, que comparten
+// todos los fondos de 16 colores de esa pantalla
+static u32 NF_TiledBgPalAddress(u8 screen) {
+	return (screen == 0) ? 0x05000000 : 0x05000400;
 }
 
 void NF_CreateTiledBg(u8 screen, u8 layer, const char* name) {
 
+	// Busca el fondo solicitado y crealo
+	NF_CreateTiledBgBySlot(screen, layer, NF_GetTiledBgSlot(name));
+
+}
+
+// Busca otra capa de la pantalla que tenga en VRAM el Tileset del slot indicado
+// Devuelve la capa, o 255 si no hay ninguna. Los fondos affine no se comparten.
+static u8 NF_FindSharedTileset(u8 screen, u8 layer, u8 slot) {
+	for (u8 n = 0; n < 4; n ++) {
+		if ((n != layer) && NF_TILEDBG_LAYERS[screen][n].created
+			&& (NF_TILEDBG_LAYERS[screen][n].bgslot == slot)
+			&& (NF_TILEDBG_LAYERS[screen][n].bgtype < 10)) {
+			return n;
+		}
+	}
+	return 255;
+}
+
+// Cuenta las capas creadas de la pantalla que usan el Tileset de la base indicada
+static u8 NF_TilesetUsers(u8 screen, u8 tilebase) {
+	u8 users = 0;
+	for (u8 n = 0; n < 4; n ++) {
+		if (NF_TILEDBG_LAYERS[screen][n].created && (NF_TILEDBG_LAYERS[screen][n].tilebase == tilebase)) {
+			users ++;
+		}
+	}
+	return users;
+}
+
+// Busca el hueco de bloques libres mas pequeño donde quepan los bloques pedidos
+// Devuelve el primer bloque del hueco, o 255 si no hay ninguno
+static u8 NF_FindVramBlocks(const u8* blocks, u8 total, u8 needed) {
+	u8 best = 255;
+	u8 best_size = 255;
+	u8 n = 0;
+	while (n < total) {
+		if (blocks[n] != 0) {
+			n ++;
+			continue;
+		}
+		// Mide el hueco libre que empieza aqui
+		u8 start = n;
+		while ((n < total) && (blocks[n] == 0)) n ++;
+		u8 size = (n - start);
+		if ((size >= needed) && (size < best_size)) {
+			best = start;
+			best_size = size;
+			if (size == needed) break;		// No hay ajuste mejor
+		}
+	}
+	return best;
+}
+
+
+void NF_CreateTiledBgBySlot(u8 screen, u8 layer, u8 slot) {
+
 	// Variables
 	u8 n = 0;			// Bucle
-	u8 slot = 255;		// Slot seleccionado
-	char bg[32];		// Nombre
-
-	// Busca el fondo solicitado
-	snprintf(bg, sizeof(bg), "%s", name);				// Obten el nombre del fondo a buscar
-	for (n = 0; n < NF_SLOTS_TBG; n ++) {				// Busca en todos los slots
-		if (strcmp(bg, NF_TILEDBG[n].name) == 0) {		// Si lo encuentras
-			slot = n;									// Guarda el slot a usar
-			n = NF_SLOTS_TBG;							// Deja de buscar
-		}
+
+	// Verifica que el slot este en uso
+	if (slot >= NF_SLOTS_TBG) {
+		NF_Error(106, "Tiled Bg", (NF_SLOTS_TBG - 1));
 	}
-	// Si no se encuentra, error
-	if (slot == 255) {
-		NF_Error(104, name, 0);
+	if (NF_TILEDBG[slot].available) {
+		NF_Error(110, "Tiled Bg", slot);
 	}
 
+	// Si aun se esta cargando, termina la carga
+	if (NF_TILEDBG[slot].loading) NF_LoaderWaitAll();
+
 	// Si ya hay un fondo existente en esta pantalla y capa, borralo antes
 	if (NF_TILEDBG_LAYERS[screen][layer].created) {
 		NF_DeleteTiledBg(screen, layer);
 	}
 
 	// Variables de control de Tiles
-	u8 counter = 0;
-	u8 start = 255;
 	u8 tilesblocks = 0;
 	u8 basetiles = 0;
 
@@ -466,73 +829,63 @@ void NF_CreateTiledBg(u8 screen, u8 layer, const char* name) {
 		NF_TILEDBG_LAYERS[screen][layer].bgtype = 3;
 	}
 
-	// Busca un los bloques libres para almacenar los Tiles en VRAM
-	tilesblocks = ((NF_TILEDBG[slot].tilesize - 1) >> 14) + 1;	// Bloques necesarios para el Tileset
-
-	for (n = 0; n < NF_BANKS_TILES[screen]; n ++) {
-		if (NF_TILEBLOCKS[screen][n] == 0) {		// Si esta libre
-			if (counter == 0) {						// Y el contador esta a 0
-				start = n;							// Marca la posicion de inicio
-			}
-			counter ++;
-			if (counter == tilesblocks) {			// Si ya tienes suficientes bloques libres
-				n = NF_BANKS_TILES[screen];			// Termina de buscar
-			}
-		} else {									// Si el bloque no esta libre
-			start = 255;							// Borra el marcador
-			counter = 0;							// Y resetea el contador
-		}
-	}
-
-	// Si no se han encontrado bloques libres
-	if ((start == 255) || (counter < tilesblocks)) {
-		NF_Error(107, name, tilesblocks);
-	} else {
-		basetiles = start;		// Guarda donde empiezan los bloques libres
-	}
+	// Bloques necesarios para el Tileset
+	tilesblocks = ((NF_TILEDBG[slot].tilesize - 1) >> 14) + 1;
 
-	// Marca los bancos de Tiles usados por este fondo
-	for (n = basetiles; n < (basetiles + tilesblocks); n ++) {
-		NF_TILEBLOCKS[screen][n] = 255;	// Marca los bloques usados por tiles
-	}
-
-	// Variables de control de Maps
+	// Bloques necesarios para el Mapa
 	u8 mapblocks = 0;
 	u8 basemap = 0;
-	counter = 0;
-	start = 255;
 	u16 mapsize = 0;
-
-	// Busca un los bloques libres para almacenar los Mapas en VRAM
 	if (NF_TILEDBG_LAYERS[screen][layer].bgtype == 0) {
-		// Si el mapa es normal =<512
-		mapblocks = ((NF_TILEDBG[slot].mapsize - 1) >> 11) + 1;
+		// Si el mapa es normal =<512 (si es de metatiles, una vez expandido)
+		u32 map_bytes = NF_TILEDBG[slot].mapsize;
+		if (NF_TILEDBG[slot].metashift > 0) {
+			map_bytes = (((NF_TILEDBG[slot].width >> 3) * (NF_TILEDBG[slot].height >> 3)) << 1);
+		}
+		mapblocks = ((map_bytes - 1) >> 11) + 1;
 	} else {
 		// Si el mapa es infinito >512
 		mapsize = (((NF_TILEDBG_LAYERS[screen][layer].mapwidth >> 3) * (NF_TILEDBG_LAYERS[screen][layer].mapheight >> 3)) << 1);
 		mapblocks = ((mapsize - 1) >> 11) + 1;
 	}
 
-	for (n = 0; n < NF_BANKS_MAPS[screen]; n ++) {
-		if (NF_MAPBLOCKS[screen][n] == 0) {			// Si esta libre
-			if (counter == 0) {						// Y el contador esta a 0
-				start = n;							// Marca la posicion de inicio
-			}
-			counter ++;
-			if (counter == mapblocks) {				// Si ya tienes suficientes bloques libres
-				n = NF_BANKS_MAPS[screen];					// Termina de buscar
-			}
-		} else {									// Si el bloque no esta libre
-			start = 255;							// Borra el marcador
-			counter = 0;							// Y resetea el contador
+	// Si otra capa de esta pantalla ya tiene este Tileset en VRAM, compartelo
+	u8 shared = NF_FindSharedTileset(screen, layer, slot);
+
+	// Busca los huecos libres mas ajustados para el Tileset y el Mapa
+	if (shared == 255) {
+		basetiles = NF_FindVramBlocks(NF_TILEBLOCKS[screen], NF_BANKS_TILES[screen], tilesblocks);
+	}
+	basemap = NF_FindVramBlocks(NF_MAPBLOCKS[screen], NF_BANKS_MAPS[screen], mapblocks);
+
+	// Si no hay huecos suficientes, compacta la VRAM y vuelve a intentarlo
+	if ((basetiles == 255) || (basemap == 255)) {
+		NF_CompactTiledBgVram(screen);
+		if (shared == 255) {
+			basetiles = NF_FindVramBlocks(NF_TILEBLOCKS[screen], NF_BANKS_TILES[screen], tilesblocks);
 		}
+		basemap = NF_FindVramBlocks(NF_MAPBLOCKS[screen], NF_BANKS_MAPS[screen], mapblocks);
+	}
+
+	// El Tileset compartido puede haberse movido al compactar la VRAM
+	if (shared != 255) {
+		basetiles = NF_TILEDBG_LAYERS[screen][shared].tilebase;
+		tilesblocks = NF_TILEDBG_LAYERS[screen][shared].tileblocks;
 	}
 
 	// Si no se han encontrado bloques libres
-	if ((start == 255) || (counter < mapblocks)) {
-		NF_Error(108, name, mapblocks);
-	} else {
-		basemap = start;							// Guarda donde empiezan los bloques libres
+	if (basetiles == 255) {
+		NF_Error(107, NF_TILEDBG[slot].name, tilesblocks);
+	}
+	if (basemap == 255) {
+		NF_Error(108, NF_TILEDBG[slot].name, mapblocks);
+	}
+
+	// Marca los bancos de Tiles usados por este fondo
+	if (shared == 255) {
+		for (n = basetiles; n < (basetiles + tilesblocks); n ++) {
+			NF_TILEBLOCKS[screen][n] = 255;	// Marca los bloques usados por tiles
+		}
 	}
 
 	// Marca los bancos de Mapa usados por este fondo
@@ -561,6 +914,11 @@ void NF_CreateTiledBg(u8 screen, u8 layer, const char* name) {
 	}
 
 
+	// Obten el modo de color (256 colores o 16 colores)
+	u32 bg_color = BgType_Text8bpp | BG_COLOR_256;
+	if (NF_TILEDBG[slot].bpp == 4) bg_color = BgType_Text4bpp | BG_COLOR_16;
+
+
 	// Crea el fondo segun la pantalla, capa y demas caracteristicas dadas
 	// REG_BG0CNT	<- Carracteristicas del fondo
 	// REG_BG0HOFS	<- Posicion X
@@ -568,44 +926,48 @@ void NF_CreateTiledBg(u8 screen, u8 layer, const char* name) {
 	if (screen == 0) {
 		switch (layer) {
 			case 0:
-				REG_BG0CNT = BgType_Text8bpp | bg_size | BG_PRIORITY_0 | BG_PALETTE_SLOT0 | BG_COLOR_256 | BG_TILE_BASE(basetiles) | BG_MAP_BASE(basemap);
+				REG_BG0CNT = bg_color | bg_size | BG_PRIORITY_0 | BG_PALETTE_SLOT0 | BG_TILE_BASE(basetiles) | BG_MAP_BASE(basemap);
 				break;
 			case 1:
-				REG_BG1CNT = BgType_Text8bpp | bg_size | BG_PRIORITY_1 | BG_PALETTE_SLOT1 | BG_COLOR_256 | BG_TILE_BASE(basetiles) | BG_MAP_BASE(basemap);
+				REG_BG1CNT = bg_color | bg_size | BG_PRIORITY_1 | BG_PALETTE_SLOT1 | BG_TILE_BASE(basetiles) | BG_MAP_BASE(basemap);
 				break;
 			case 2:
-				REG_BG2CNT = BgType_Text8bpp | bg_size | BG_PRIORITY_2 | BG_COLOR_256 | BG_TILE_BASE(basetiles) | BG_MAP_BASE(basemap);
+				REG_BG2CNT = bg_color | bg_size | BG_PRIORITY_2 | BG_TILE_BASE(basetiles) | BG_MAP_BASE(basemap);
 				break;
 			case 3:
-				REG_BG3CNT = BgType_Text8bpp | bg_size | BG_PRIORITY_3 | BG_COLOR_256 | BG_TILE_BASE(basetiles) | BG_MAP_BASE(basemap);
+				REG_BG3CNT = bg_color | bg_size | BG_PRIORITY_3 | BG_TILE_BASE(basetiles) | BG_MAP_BASE(basemap);
 				break;
 		}
 	} else {
 		switch (layer) {
 			case 0:
-				REG_BG0CNT_SUB = BgType_Text8bpp | bg_size | BG_PRIORITY_0 | BG_PALETTE_SLOT0 | BG_COLOR_256 | BG_TILE_BASE(basetiles) | BG_MAP_BASE(basemap);
+				REG_BG0CNT_SUB = bg_color | bg_size | BG_PRIORITY_0 | BG_PALETTE_SLOT0 | BG_TILE_BASE(basetiles) | BG_MAP_BASE(basemap);
 				break;
 			case 1:
-				REG_BG1CNT_SUB = BgType_Text8bpp | bg_size | BG_PRIORITY_1 | BG_PALETTE_SLOT1 | BG_COLOR_256 | BG_TILE_BASE(basetiles) | BG_MAP_BASE(basemap);
+				REG_BG1CNT_SUB = bg_color | bg_size | BG_PRIORITY_1 | BG_PALETTE_SLOT1 | BG_TILE_BASE(basetiles) | BG_MAP_BASE(basemap);
 				break;
 			case 2:
-				REG_BG2CNT_SUB = BgType_Text8bpp | bg_size | BG_PRIORITY_2 | BG_COLOR_256 | BG_TILE_BASE(basetiles) | BG_MAP_BASE(basemap);
+				REG_BG2CNT_SUB = bg_color | bg_size | BG_PRIORITY_2 | BG_TILE_BASE(basetiles) | BG_MAP_BASE(basemap);
 				break;
 			case 3:
-				REG_BG3CNT_SUB = BgType_Text8bpp | bg_size | BG_PRIORITY_3 | BG_COLOR_256 | BG_TILE_BASE(basetiles) | BG_MAP_BASE(basemap);
+				REG_BG3CNT_SUB = bg_color | bg_size | BG_PRIORITY_3 | BG_TILE_BASE(basetiles) | BG_MAP_BASE(basemap);
 				break;
 		}
 	}
 
 	u32 address;		// Variable de direccion de VRAM;
-
-	// Transfiere el Tileset a VRAM
-	if (screen == 0) {	// (VRAM_A)
-		address = (0x6000000) + (basetiles << 14);
-	} else {			// (VRAM_C)
-		address = (0x6200000) + (basetiles << 14);
+	u32 fence[3] = { NF_DMA_FENCE_DONE, NF_DMA_FENCE_DONE, NF_DMA_FENCE_DONE };	// Copias en curso
+
+	// Transfiere el Tileset a VRAM (sin esperar a que termine la copia)
+	// Si es compartido, ya esta en VRAM
+	if (shared == 255) {
+		if (screen == 0) {	// (VRAM_A)
+			address = (0x6000000) + (basetiles << 14);
+		} else {			// (VRAM_C)
+			address = (0x6200000) + (basetiles << 14);
+		}
+		fence[0] = NF_DmaMemCopyAsync((void*)address, NF_BUFFER_BGTILES[slot], NF_TILEDBG[slot].tilesize);
 	}
-	NF_DmaMemCopy((void*)address, NF_BUFFER_BGTILES[slot], NF_TILEDBG[slot].tilesize);
 
 
 	// Transfiere el Mapa a VRAM
@@ -615,10 +977,24 @@ void NF_CreateTiledBg(u8 screen, u8 layer, const char* name) {
 		address = (0x6200000) + (basemap << 11);
 	}
 
-	if (NF_TILEDBG_LAYERS[screen][layer].bgtype == 0) {
+	if (NF_TILEDBG[slot].metashift > 0) {
+
+		// Si el mapa es de metatiles, expande los bloques que caben en VRAM en
+		// el buffer intermedio de la capa y copialos desde alli
+		NF_TILEDBG_LAYERS[screen][layer].staging = (u16*) calloc ((mapblocks << 10), sizeof(u16));
+		if (NF_TILEDBG_LAYERS[screen][layer].staging == NULL) {		// Si no hay suficiente RAM libre
+			NF_Error(102, NULL, (mapblocks << 11));
+		}
+		u32 rowblocks = (NF_TILEDBG_LAYERS[screen][layer].mapwidth >> 8);
+		for (u32 n = 0; n < mapblocks; n ++) {
+			NF_ExpandMetatileBlock(slot, (NF_TILEDBG_LAYERS[screen][layer].staging + (n << 10)), (n % rowblocks), (n / rowblocks));
+		}
+		fence[1] = NF_DmaMemCopyAsync((void*)address, NF_TILEDBG_LAYERS[screen][layer].staging, (mapblocks << 11));
+
+	} else if (NF_TILEDBG_LAYERS[screen][layer].bgtype == 0) {
 
 		// Si el mapa es normal
-		NF_DmaMemCopy((void*)address, NF_BUFFER_BGMAP[slot], NF_TILEDBG[slot].mapsize);
+		fence[1] = NF_DmaMemCopyAsync((void*)address, NF_BUFFER_BGMAP[slot], NF_TILEDBG[slot].mapsize);
 
 	} else {
 
@@ -627,21 +1003,21 @@ void NF_CreateTiledBg(u8 screen, u8 layer, const char* name) {
 
 			case 1:	// >512x256
 				// Bloque A y B (32x32) + (32x32) (2kb x 2 = 4kb)
-				NF_DmaMemCopy((void*)address, NF_BUFFER_BGMAP[slot], 4096);
+				fence[1] = NF_DmaMemCopyAsync((void*)address, NF_BUFFER_BGMAP[slot], 4096);
 				break;
 
 			case 2:	// 256x>512
 				// Bloque A (32x64) (2kb x 2 = 4kb)
-				NF_DmaMemCopy((void*)address, NF_BUFFER_BGMAP[slot], 4096);
+				fence[1] = NF_DmaMemCopyAsync((void*)address, NF_BUFFER_BGMAP[slot], 4096);
 				break;
 
 			case 3: // >512x>512
 				// Bloque A y B (32x32) + (32x32) (2kb x 2 = 4kb)
-				NF_DmaMemCopy((void*)address, NF_BUFFER_BGMAP[slot], 4096);
+				fence[1] = NF_DmaMemCopyAsync((void*)address, NF_BUFFER_BGMAP[slot], 4096);
 				// Bloque (+4096) C y D (32x32) + (32x32) (2kb x 2 = 4kb)
 				u16 nextrow = 0;	// Desplazamiento para cargar la fila inferior
 				nextrow = ((((NF_TILEDBG_LAYERS[screen][layer].bgwidth - 1) >> 8) + 1) << 11);
-				NF_DmaMemCopy((void*)(address + 4096), (NF_BUFFER_BGMAP[slot] + nextrow), 4096);
+				fence[2] = NF_DmaMemCopyAsync((void*)(address + 4096), (NF_BUFFER_BGMAP[slot] + nextrow), 4096);
 				break;
 
 		}
@@ -650,7 +1026,13 @@ void NF_CreateTiledBg(u8 screen, u8 layer, const char* name) {
 
 
 	// Tranfiere la Paleta a VRAM
-	if (screen == 0) {
+	if (NF_TILEDBG[slot].bpp == 4) {
+
+		// Los fondos de 16 colores usan las 16 paletas de la paleta estandar
+		address = NF_TiledBgPalAddress(screen);
+		NF_DmaMemCopy((void*)address, NF_BUFFER_BGPAL[slot], NF_TILEDBG[slot].palsize);
+
+	} else if (screen == 0) {
 
 		vramSetBankE(VRAM_E_LCD);
 		address = (0x06880000) + (layer << 13);
@@ -666,6 +1048,11 @@ void NF_CreateTiledBg(u8 screen, u8 layer, const char* name) {
 
 	}
 
+	// Espera a que terminen las copias del Tileset y el Mapa
+	for (u32 n = 0; n < 3; n ++) {
+		NF_DmaWait(fence[n]);
+	}
+
 	// Registra los datos del fondos en pantalla
 	NF_TILEDBG_LAYERS[screen][layer].tilebase = basetiles;				// Base del Tileset
 	NF_TILEDBG_LAYERS[screen][layer].tileblocks = tilesblocks;			// Bloques usados por el Tileset
@@ -701,15 +1088,20 @@ void NF_DeleteTiledBg(u8 screen, u8 layer) {
 	u16 tilesize = 0;		// Tamaño del Tileset
 	u16 mapsize = 0;		// Tamaño del Map
 
-	// Borra el Tileset de la VRAM
+	// Si otras capas usan el mismo Tileset, no lo borres
 	basetiles = NF_TILEDBG_LAYERS[screen][layer].tilebase;
-	tilesize = (NF_TILEDBG_LAYERS[screen][layer].tileblocks << 14);
-	if (screen == 0) {	// (VRAM_A)
-		address = (0x6000000) + (basetiles << 14);
-	} else {			// (VRAM_C)
-		address = (0x6200000) + (basetiles << 14);
+	bool shared = (NF_TilesetUsers(screen, basetiles) > 1);
+
+	// Borra el Tileset de la VRAM
+	if (!shared) {
+		tilesize = (NF_TILEDBG_LAYERS[screen][layer].tileblocks << 14);
+		if (screen == 0) {	// (VRAM_A)
+			address = (0x6000000) + (basetiles << 14);
+		} else {			// (VRAM_C)
+			address = (0x6200000) + (basetiles << 14);
+		}
+		memset((void*)address, 0, tilesize);		// Pon a 0 todos los bytes de la area de VRAM
 	}
-	memset((void*)address, 0, tilesize);		// Pon a 0 todos los bytes de la area de VRAM
 
 	// Borra el Mapa de la VRAM
 	basemap = NF_TILEDBG_LAYERS[screen][layer].mapbase;
@@ -725,47 +1117,335 @@ void NF_DeleteTiledBg(u8 screen, u8 layer) {
 	// Borra la Paleta a VRAM
 	if (screen == 0) {
 
-		vramSetBankE(VRAM_E_LCD);
-		address = (0x06880000) + (layer << 13);
-		memset((void*)address, 0, 8192);
-		vramSetBankE(VRAM_E_BG_EXT_PALETTE);
+		vramSetBankE(VRAM_E_LCD);
+		address = (0x06880000) + (layer << 13);
+		memset((void*)address, 0, 8192);
+		vramSetBankE(VRAM_E_BG_EXT_PALETTE);
+
+	} else {	// Paletas de la pantalla 1 (VRAM_H)
+
+		vramSetBankH(VRAM_H_LCD);
+		address = (0x06898000) + (layer << 13);
+		memset((void*)address, 0, 8192);
+		vramSetBankH(VRAM_H_SUB_BG_EXT_PALETTE);
+
+	}
+
+
+	// Marca como libres los bancos de Tiles usados por este fondo
+	if (!shared) {
+		tilesize = (basetiles + NF_TILEDBG_LAYERS[screen][layer].tileblocks);
+		for (n = basetiles; n < tilesize; n ++) {
+			NF_TILEBLOCKS[screen][n] = 0;
+		}
+	}
+
+	// Marca como libres los bancos de Mapa usados por este fondo
+	mapsize = (basemap + NF_TILEDBG_LAYERS[screen][layer].mapblocks);
+	for (n = basemap; n < mapsize; n ++) {
+		NF_MAPBLOCKS[screen][n] = 0;
+	}
+
+	// Borra los datos del fondos en pantalla
+	NF_TILEDBG_LAYERS[screen][layer].tilebase = 0;		// Base del Tileset
+	NF_TILEDBG_LAYERS[screen][layer].tileblocks = 0;	// Bloques usados por el Tileset
+	NF_TILEDBG_LAYERS[screen][layer].mapbase = 0;		// Base del Map
+	NF_TILEDBG_LAYERS[screen][layer].mapblocks = 0;		// Bloques usados por el Map
+	NF_TILEDBG_LAYERS[screen][layer].bgwidth = 0;		// Ancho del fondo
+	NF_TILEDBG_LAYERS[screen][layer].bgheight = 0;		// Altura del fondo
+	NF_TILEDBG_LAYERS[screen][layer].mapwidth = 0;		// Ancho del mapa
+	NF_TILEDBG_LAYERS[screen][layer].mapheight = 0;		// Altura del mapa
+	NF_TILEDBG_LAYERS[screen][layer].bgtype = 0;		// Tipo de mapa
+	NF_TILEDBG_LAYERS[screen][layer].bgslot = 0;		// Buffer de graficos usado
+	NF_TILEDBG_LAYERS[screen][layer].blockx = 0;		// Bloque de mapa actual (horizontal)
+	NF_TILEDBG_LAYERS[screen][layer].blocky = 0;		// Bloque de mapa actual (vertical)
+	NF_TILEDBG_LAYERS[screen][layer].streamx = 0xFFFF;	// Ventana del streaming (ninguna)
+	NF_TILEDBG_LAYERS[screen][layer].streamy = 0;
+	NF_TILEDBG_LAYERS[screen][layer].streaming = false;	// Sin streaming de filas y columnas
+	NF_TILEDBG_LAYERS[screen][layer].created = false;	// Esta creado ?
+	memset(NF_TILEDBG_LAYERS[screen][layer].dirtyrows, 0, sizeof(NF_TILEDBG_LAYERS[screen][layer].dirtyrows));	// Sin cambios pendientes
+	free(NF_TILEDBG_LAYERS[screen][layer].staging);		// Buffer de bloques de metatiles
+	NF_TILEDBG_LAYERS[screen][layer].staging = NULL;
+
+}
+
+// Cambia las bases de tiles y mapa de un fondo y actualiza su registro de control
+static void NF_SetTiledBgBases(u8 screen, u8 layer, u8 tilebase, u8 mapbase) {
+
+	NF_TILEDBG_LAYERS[screen][layer].tilebase = tilebase;
+	NF_TILEDBG_LAYERS[screen][layer].mapbase = mapbase;
+
+	// Actualiza las bases en el registro de control, sin tocar el resto de bits
+	vu16* control = (screen == 0) ? &BGCTRL[layer] : &BGCTRL_SUB[layer];
+	*control = (*control & ~(BG_TILE_BASE(15) | BG_MAP_BASE(31))) | BG_TILE_BASE(tilebase) | BG_MAP_BASE(mapbase);
+
+}
+
+// Compacta los bloques de tiles (type 0) o de mapas (type 1) de una pantalla
+static void NF_CompactVramBlocks(u8 screen, u8 type) {
+
+	// Variables
+	u8 n = 0;
+	u8 layer = 0;
+	u8 order[4];
+	u8 total = 0;
+
+	u8* blocks = (type == 0) ? NF_TILEBLOCKS[screen] : NF_MAPBLOCKS[screen];
+	u32 shift = (type == 0) ? 14 : 11;		// Tamaño de cada bloque
+	u32 vram = (screen == 0) ? 0x6000000 : 0x6200000;
+
+	// Lista de fondos creados en la pantalla, ordenada por base
+	for (layer = 0; layer < 4; layer ++) {
+		if (!NF_TILEDBG_LAYERS[screen][layer].created) continue;
+		u8 base = (type == 0) ? NF_TILEDBG_LAYERS[screen][layer].tilebase : NF_TILEDBG_LAYERS[screen][layer].mapbase;
+		n = total;
+		while ((n > 0) && (((type == 0) ? NF_TILEDBG_LAYERS[screen][order[n - 1]].tilebase : NF_TILEDBG_LAYERS[screen][order[n - 1]].mapbase) > base)) {
+			order[n] = order[n - 1];
+			n --;
+		}
+		order[n] = layer;
+		total ++;
+	}
+
+	// Primer bloque disponible (saltando los bloques de tiles reservados para mapas)
+	u8 next = 0;
+	if (type == 0) {
+		while ((next < NF_BANKS_TILES[screen]) && (blocks[next] == 128)) next ++;
+	}
+
+	u8 last_old = 255;		// Ultima base movida (los Tilesets compartidos se mueven una vez)
+	u8 last_new = 255;
+
+	for (n = 0; n < total; n ++) {
+
+		layer = order[n];
+		u8 base = (type == 0) ? NF_TILEDBG_LAYERS[screen][layer].tilebase : NF_TILEDBG_LAYERS[screen][layer].mapbase;
+		u8 size = (type == 0) ? NF_TILEDBG_LAYERS[screen][layer].tileblocks : NF_TILEDBG_LAYERS[screen][layer].mapblocks;
+		u8 target = base;
+
+		if (base == last_old) {
+			// Comparte los datos con el fondo anterior, que ya se han movido
+			target = last_new;
+		} else if (base > next) {
+			// Los datos solo se mueven a direcciones mas bajas, asi que la copia
+			// ascendente de la DMA es segura aunque el origen y el destino se solapen
+			NF_DmaMemCopy((void*)(vram + (next << shift)), (void*)(vram + (base << shift)), (size << shift));
+			memset(&blocks[base], 0, size);
+			memset(&blocks[next], 255, size);
+			target = next;
+		}
+
+		last_old = base;
+		last_new = target;
+		if ((target + size) > next) next = (target + size);
+
+		if (target != base) {
+			if (type == 0) {
+				NF_SetTiledBgBases(screen, layer, target, NF_TILEDBG_LAYERS[screen][layer].mapbase);
+			} else {
+				NF_SetTiledBgBases(screen, layer, NF_TILEDBG_LAYERS[screen][layer].tilebase, target);
+			}
+		}
+
+	}
+
+}
+
+void NF_CompactTiledBgVram(u8 screen) {
+
+	// Compacta los Tilesets y despues los Mapas
+	NF_CompactVramBlocks(screen, 0);
+	NF_CompactVramBlocks(screen, 1);
+
+}
+
+void NF_GetTiledBgVramInfo(u8 screen, NF_TYPE_TBGVRAM_INFO* info) {
+
+	const u8* blocks[2] = { NF_TILEBLOCKS[screen], NF_MAPBLOCKS[screen] };
+	u8 total[2] = { NF_BANKS_TILES[screen], NF_BANKS_MAPS[screen] };
+	u8 free_blocks[2] = { 0, 0 };
+	u8 largest[2] = { 0, 0 };
+
+	// Cuenta los bloques libres y el hueco mas grande de tiles y de mapas
+	for (u8 type = 0; type < 2; type ++) {
+		u8 size = 0;
+		for (u8 n = 0; n < total[type]; n ++) {
+			if (blocks[type][n] == 0) {
+				free_blocks[type] ++;
+				size ++;
+				if (size > largest[type]) largest[type] = size;
+			} else {
+				size = 0;
+			}
+		}
+	}
+
+	info->freetileblocks = free_blocks[0];
+	info->largesttileblocks = largest[0];
+	info->freemapblocks = free_blocks[1];
+	info->largestmapblocks = largest[1];
+
+}
+
+// Lee un tile de un mapa de metatiles
+static inline u16 NF_GetMetatileMapTile(u8 slot, u32 tile_x, u32 tile_y) {
+	u32 shift = NF_TILEDBG[slot].metashift;
+	u32 mask = ((1 << shift) - 1);
+	u32 row = ((NF_TILEDBG[slot].width >> 3) >> shift);	// Metatiles por fila
+	u16 meta = ((u16*)NF_BUFFER_BGMAP[slot])[((tile_y >> shift) * row) + (tile_x >> shift)];
+	return ((u16*)NF_BUFFER_BGMETA[slot])[(meta << (shift << 1)) + ((tile_y & mask) << shift) + (tile_x & mask)];
+}
+
+static void NF_ExpandMetatileBlock(u8 slot, u16* destination, u32 block_x, u32 block_y) {
+
+	u32 shift = NF_TILEDBG[slot].metashift;
+	u32 side = (1 << shift);		// Tiles por lado de un metatile
+	u32 mask = (side - 1);
+	u32 row = ((NF_TILEDBG[slot].width >> 3) >> shift);	// Metatiles por fila
+
+	// Si el bloque esta fuera del fondo, dejalo vacio
+	if ((block_x >= (u32)(NF_TILEDBG[slot].width >> 8)) || (block_y >= (u32)(NF_TILEDBG[slot].height >> 8))) {
+		memset(destination, 0, 2048);
+		return;
+	}
+
+	u16* index = (u16*)NF_BUFFER_BGMAP[slot] + (((block_y << 5) >> shift) * row) + ((block_x << 5) >> shift);
+	u16* metatiles = (u16*)NF_BUFFER_BGMETA[slot];
+
+	for (u32 y = 0; y < 32; y ++) {
+		u16* metas = index + ((y >> shift) * row);
+		u32 line = ((y & mask) << shift);		// Linea dentro del metatile
+		for (u32 x = 0; x < 32; x += side) {
+			u16* source = metatiles + (metas[x >> shift] << (shift << 1)) + line;
+			for (u32 n = 0; n < side; n ++) {
+				*destination++ = source[n];
+			}
+		}
+	}
+
+}
+
+void NF_CopyTiledBgMapBlocks(u8 screen, u8 layer, void* destination, u32 offset, u32 size) {
+
+	u8 slot = NF_TILEDBG_LAYERS[screen][layer].bgslot;
+
+	if (NF_TILEDBG[slot].metashift == 0) {
+
+		// Mapa normal, copia los bloques tal cual
+		NF_QueueVramCopy(destination, (NF_BUFFER_BGMAP[slot] + offset), size);
+
+	} else {
+
+		// Mapa de metatiles, expande los bloques en el buffer intermedio de la
+		// capa, en la misma posicion que tendran en VRAM, y copialos desde alli
+		u32 address;
+		if (screen == 0) {	// (VRAM_A)
+			address = (0x6000000) + (NF_TILEDBG_LAYERS[screen][layer].mapbase << 11);
+		} else {			// (VRAM_C)
+			address = (0x6200000) + (NF_TILEDBG_LAYERS[screen][layer].mapbase << 11);
+		}
+		u32 first = (((u32)destination - address) >> 11);		// Primer bloque de VRAM
+		u32 rowblocks = (((NF_TILEDBG_LAYERS[screen][layer].bgwidth - 1) >> 8) + 1);	// Bloques por fila en RAM
+		u16* staging = NF_TILEDBG_LAYERS[screen][layer].staging + (first << 10);
+		for (u32 n = 0; n < (size >> 11); n ++) {
+			u32 block = ((offset >> 11) + n);
+			NF_ExpandMetatileBlock(slot, (staging + (n << 10)), (block % rowblocks), (block / rowblocks));
+		}
+		NF_QueueVramCopy(destination, staging, size);
+
+	}
+
+	// Bytes de mapas copiados a VRAM
+	NF_TILEDBG_UPLOAD_BYTES += size;
+
+}
+
+// Devuelve un puntero a la entrada de un tile en el mapa en RAM. En los mapas de
+// metatiles, si se va a modificar y su metatile se usa en otros sitios del
+// mapa, se duplica el metatile para que el cambio solo afecte a esta posicion.
+static char* NF_GetTileMapEntry(u8 screen, u8 layer, u16 tile_x, u16 tile_y, bool write) {
 
-	} else {	// Paletas de la pantalla 1 (VRAM_H)
+	u8 slot = NF_TILEDBG_LAYERS[screen][layer].bgslot;
 
-		vramSetBankH(VRAM_H_LCD);
-		address = (0x06898000) + (layer << 13);
-		memset((void*)address, 0, 8192);
-		vramSetBankH(VRAM_H_SUB_BG_EXT_PALETTE);
+	// Mapa normal
+	if (!NF_TILEDBG_LAYERS[screen][layer].created || (NF_TILEDBG[slot].metashift == 0)) {
+		return (NF_BUFFER_BGMAP[slot] + NF_GetTileMapAddress(screen, layer, tile_x, tile_y));
+	}
 
+	// Protegete de los fuera de rango
+	u16 size_x = (NF_TILEDBG_LAYERS[screen][layer].bgwidth >> 3);
+	u16 size_y = (NF_TILEDBG_LAYERS[screen][layer].bgheight >> 3);
+	if (tile_x >= size_x) NF_Error(106, "Tile X", size_x);
+	if (tile_y >= size_y) NF_Error(106, "Tile Y", size_y);
+
+	u32 shift = NF_TILEDBG[slot].metashift;
+	u32 mask = ((1 << shift) - 1);
+	u32 tiles = (1 << (shift << 1));		// Tiles de un metatile
+	u16* cell = (u16*)NF_BUFFER_BGMAP[slot] + ((tile_y >> shift) * (size_x >> shift)) + (tile_x >> shift);
+
+	// Si el metatile se usa en mas sitios, duplicalo
+	if (write && (NF_BUFFER_BGMETAREFS[slot][*cell] > 1)) {
+		u32 id = NF_TILEDBG[slot].metacount;
+		if (id > 0xFFFF) NF_Error(106, "Metatiles", 0xFFFF);
+		char* metatiles = realloc(NF_BUFFER_BGMETA[slot], ((id + 1) * tiles) << 1);
+		u16* refs = realloc(NF_BUFFER_BGMETAREFS[slot], (id + 1) << 1);
+		if (metatiles != NULL) NF_BUFFER_BGMETA[slot] = metatiles;
+		if (refs != NULL) NF_BUFFER_BGMETAREFS[slot] = refs;
+		if ((metatiles == NULL) || (refs == NULL)) {		// Si no hay suficiente RAM libre
+			NF_Error(102, NULL, (tiles << 1));
+		}
+		memcpy((metatiles + ((id * tiles) << 1)), (metatiles + ((*cell * tiles) << 1)), (tiles << 1));
+		refs[*cell] --;
+		refs[id] = 1;
+		*cell = id;
+		NF_TILEDBG[slot].metacount ++;
 	}
 
+	// Direccion del tile dentro del metatile
+	u32 tile = ((*cell * tiles) + ((tile_y & mask) << shift) + (tile_x & mask));
+	return (NF_BUFFER_BGMETA[slot] + (tile << 1));
 
-	// Marca como libres los bancos de Tiles usados por este fondo
-	tilesize = (basetiles + NF_TILEDBG_LAYERS[screen][layer].tileblocks);
-	for (n = basetiles; n < tilesize; n ++) {
-		NF_TILEBLOCKS[screen][n] = 0;
-	}
+}
 
-	// Marca como libres los bancos de Mapa usados por este fondo
-	mapsize = (basemap + NF_TILEDBG_LAYERS[screen][layer].mapblocks);
-	for (n = basemap; n < mapsize; n ++) {
-		NF_MAPBLOCKS[screen][n] = 0;
+// Marca como modificado un tile del mapa, si esta en VRAM
+static void NF_MarkTileDirty(u8 screen, u8 layer, u32 tile_x, u32 tile_y) {
+
+	// Medidas en tiles del mapa en VRAM
+	u32 map_w = (NF_TILEDBG_LAYERS[screen][layer].mapwidth >> 3);
+	u32 map_h = (NF_TILEDBG_LAYERS[screen][layer].mapheight >> 3);
+	u32 hx = tile_x;
+	u32 hy = tile_y;
+
+	// Calcula la posicion del tile en el mapa de VRAM
+	if (NF_TILEDBG_LAYERS[screen][layer].streaming && (NF_TILEDBG_LAYERS[screen][layer].bgtype > 0)) {
+		// Con streaming solo esta en VRAM la ventana visible (buffer circular)
+		if (NF_TILEDBG_LAYERS[screen][layer].streamx == 0xFFFF) return;
+		if ((tile_x - NF_TILEDBG_LAYERS[screen][layer].streamx) >= NF_STREAM_WINDOW_WIDTH) return;
+		if ((tile_y - NF_TILEDBG_LAYERS[screen][layer].streamy) >= NF_STREAM_WINDOW_HEIGHT) return;
+		hx = (tile_x & (map_w - 1));
+		hy = (tile_y & (map_h - 1));
+	} else {
+		// Sin streaming, en VRAM estan los bloques a partir del bloque actual
+		if ((NF_TILEDBG_LAYERS[screen][layer].bgtype == 1) || (NF_TILEDBG_LAYERS[screen][layer].bgtype == 3)) {
+			hx -= (NF_TILEDBG_LAYERS[screen][layer].blockx << 5);
+		}
+		if ((NF_TILEDBG_LAYERS[screen][layer].bgtype == 2) || (NF_TILEDBG_LAYERS[screen][layer].bgtype == 3)) {
+			hy -= (NF_TILEDBG_LAYERS[screen][layer].blocky << 5);
+		}
+		if ((hx >= map_w) || (hy >= map_h)) return;
 	}
 
-	// Borra los datos del fondos en pantalla
-	NF_TILEDBG_LAYERS[screen][layer].tilebase = 0;		// Base del Tileset
-	NF_TILEDBG_LAYERS[screen][layer].tileblocks = 0;	// Bloques usados por el Tileset
-	NF_TILEDBG_LAYERS[screen][layer].mapbase = 0;		// Base del Map
-	NF_TILEDBG_LAYERS[screen][layer].mapblocks = 0;		// Bloques usados por el Map
-	NF_TILEDBG_LAYERS[screen][layer].bgwidth = 0;		// Ancho del fondo
-	NF_TILEDBG_LAYERS[screen][layer].bgheight = 0;		// Altura del fondo
-	NF_TILEDBG_LAYERS[screen][layer].mapwidth = 0;		// Ancho del mapa
-	NF_TILEDBG_LAYERS[screen][layer].mapheight = 0;		// Altura del mapa
-	NF_TILEDBG_LAYERS[screen][layer].bgtype = 0;		// Tipo de mapa
-	NF_TILEDBG_LAYERS[screen][layer].bgslot = 0;		// Buffer de graficos usado
-	NF_TILEDBG_LAYERS[screen][layer].blockx = 0;		// Bloque de mapa actual (horizontal)
-	NF_TILEDBG_LAYERS[screen][layer].blocky = 0;		// Bloque de mapa actual (vertical)
-	NF_TILEDBG_LAYERS[screen][layer].created = false;	// Esta creado ?
+	// Marca la fila del bloque y amplia el rango de columnas
+	u32 block = (((hy >> 5) * (map_w >> 5)) + (hx >> 5));
+	u8 column = (hx & 31);
+	if (NF_TILEDBG_LAYERS[screen][layer].dirtyrows[block] == 0) {
+		NF_TILEDBG_LAYERS[screen][layer].dirtyleft[block] = column;
+		NF_TILEDBG_LAYERS[screen][layer].dirtyright[block] = column;
+	} else {
+		if (column < NF_TILEDBG_LAYERS[screen][layer].dirtyleft[block]) NF_TILEDBG_LAYERS[screen][layer].dirtyleft[block] = column;
+		if (column > NF_TILEDBG_LAYERS[screen][layer].dirtyright[block]) NF_TILEDBG_LAYERS[screen][layer].dirtyright[block] = column;
+	}
+	NF_TILEDBG_LAYERS[screen][layer].dirtyrows[block] |= BIT(hy & 31);
 
 }
 
@@ -805,11 +1485,11 @@ u32 NF_GetTileMapAddress(u8 screen, u8 layer, u16 tile_x, u16 tile_y) {
 u16 NF_GetTileOfMap(u8 screen, u8 layer, u16 tile_x, u16 tile_y) {
 
 	// Obten la direccion en el buffer del Tile
-	u32 address = NF_GetTileMapAddress(screen, layer, tile_x, tile_y);
+	char* entry = NF_GetTileMapEntry(screen, layer, tile_x, tile_y, false);
 
 	// Obten los bytes
-	u8 lobyte = *(NF_BUFFER_BGMAP[NF_TILEDBG_LAYERS[screen][layer].bgslot] + address);
-	u8 hibyte = *(NF_BUFFER_BGMAP[NF_TILEDBG_LAYERS[screen][layer].bgslot] + (address + 1));
+	u8 lobyte = *(entry);
+	u8 hibyte = *(entry + 1);
 
 	// Devuelve el valor del tile
 	return ((hibyte << 8) | lobyte);
@@ -819,15 +1499,215 @@ u16 NF_GetTileOfMap(u8 screen, u8 layer, u16 tile_x, u16 tile_y) {
 void NF_SetTileOfMap(u8 screen, u8 layer, u16 tile_x, u16 tile_y, u16 tile) {
 
 	// Obten la direccion en el buffer del Tile
-	u32 address = NF_GetTileMapAddress(screen, layer, tile_x, tile_y);
+	char* entry = NF_GetTileMapEntry(screen, layer, tile_x, tile_y, true);
 
 	// Calcula los valores para el HI-Byte y el LO-Byte
 	u8 hibyte = ((tile >> 8) & 0xff);
 	u8 lobyte = (tile & 0xff);
 
 	// Graba los bytes
-	*(NF_BUFFER_BGMAP[NF_TILEDBG_LAYERS[screen][layer].bgslot] + address) = lobyte;
-	*(NF_BUFFER_BGMAP[NF_TILEDBG_LAYERS[screen][layer].bgslot] + (address + 1)) = hibyte;
+	*(entry) = lobyte;
+	*(entry + 1) = hibyte;
+
+
+	// Marca el tile como modificado
+	NF_MarkTileDirty(screen, layer, tile_x, tile_y);
+
+}
+
+void NF_MarkTileMapDirty(u8 screen, u8 layer, u16 tile_x, u16 tile_y, u16 width, u16 height) {
+
+	// Verifica que el fondo esta creado
+	if (!NF_TILEDBG_LAYERS[screen][layer].created) {
+		char text[32];
+		snprintf(text, sizeof(text), "%d", screen);
+		NF_Error(105, text, layer);		// Si no existe, error
+	}
+
+	u32 left = tile_x;
+	u32 right = (tile_x + width);
+	u32 top = tile_y;
+	u32 bottom = (tile_y + height);
+
+	// Con streaming, recorta el rectangulo a la ventana que esta en VRAM
+	if (NF_TILEDBG_LAYERS[screen][layer].streaming && (NF_TILEDBG_LAYERS[screen][layer].bgtype > 0)) {
+		u32 stream_x = NF_TILEDBG_LAYERS[screen][layer].streamx;
+		u32 stream_y = NF_TILEDBG_LAYERS[screen][layer].streamy;
+		if (stream_x == 0xFFFF) return;
+		if (left < stream_x) left = stream_x;
+		if (right > (stream_x + NF_STREAM_WINDOW_WIDTH)) right = (stream_x + NF_STREAM_WINDOW_WIDTH);
+		if (top < stream_y) top = stream_y;
+		if (bottom > (stream_y + NF_STREAM_WINDOW_HEIGHT)) bottom = (stream_y + NF_STREAM_WINDOW_HEIGHT);
+	}
+
+	// Marca cada fila por tramos dentro de un bloque de 32 tiles. Cada tramo
+	// esta en un solo bloque de VRAM, asi que basta con marcar sus extremos.
+	for (u32 y = top; y < bottom; y ++) {
+		u32 x = left;
+		while (x < right) {
+			u32 last = ((x | 31) < (right - 1)) ? (x | 31) : (right - 1);
+			NF_MarkTileDirty(screen, layer, x, y);
+			NF_MarkTileDirty(screen, layer, last, y);
+			x = (last + 1);
+		}
+	}
+
+}
+
+// Verifica que un rectangulo de tiles esta dentro del mapa de un fondo creado
+static void NF_CheckTileMapRect(u8 screen, u8 layer, u16 tile_x, u16 tile_y, u16 width, u16 height) {
+
+	// Verifica que el fondo esta creado
+	if (!NF_TILEDBG_LAYERS[screen][layer].created) {
+		char text[32];
+		snprintf(text, sizeof(text), "%d", screen);
+		NF_Error(105, text, layer);		// Si no existe, error
+	}
+
+	// Protegete de los fuera de rango
+	u32 size_x = (NF_TILEDBG_LAYERS[screen][layer].bgwidth >> 3);
+	u32 size_y = (NF_TILEDBG_LAYERS[screen][layer].bgheight >> 3);
+	if ((u32)(tile_x + width) > size_x) NF_Error(106, "Tile X", size_x);
+	if ((u32)(tile_y + height) > size_y) NF_Error(106, "Tile Y", size_y);
+
+}
+
+// Operaciones sobre una fila de tiles del mapa en RAM
+#define NF_TILEMAP_READ 0		// Copia la fila al buffer
+#define NF_TILEMAP_WRITE 1		// Copia el buffer a la fila
+#define NF_TILEMAP_FILL 2		// Rellena la fila con el primer valor del buffer
+
+// Recorre una fila de tiles del mapa en RAM. La direccion de la fila se calcula
+// una sola vez, y despues se avanza por tramos dentro de cada bloque de 32x32.
+static void NF_TileMapRow(u8 screen, u8 layer, u32 tile_x, u32 tile_y, u32 width, u16* buffer, u32 mode) {
+
+	u8 slot = NF_TILEDBG_LAYERS[screen][layer].bgslot;
+
+	// Los mapas de metatiles se recorren tile a tile
+	if (NF_TILEDBG[slot].metashift > 0) {
+		for (u32 n = 0; n < width; n ++) {
+			u16* entry = (u16*)NF_GetTileMapEntry(screen, layer, (tile_x + n), tile_y, (mode != NF_TILEMAP_READ));
+			if (mode == NF_TILEMAP_READ) {
+				buffer[n] = *entry;
+			} else {
+				*entry = (mode == NF_TILEMAP_FILL) ? buffer[0] : buffer[n];
+			}
+		}
+		return;
+	}
+
+	u32 rowblocks = (NF_TILEDBG_LAYERS[screen][layer].bgwidth >> 8);		// Bloques por fila
+	u16* row = (u16*)NF_BUFFER_BGMAP[slot] + ((((tile_y >> 5) * rowblocks) << 10) + ((tile_y & 31) << 5));
+
+	u32 x = tile_x;
+	u32 end = (tile_x + width);
+	u16* data = buffer;
+	while (x < end) {
+		u32 count = (32 - (x & 31));		// Tiles hasta el final del bloque
+		if (count > (end - x)) count = (end - x);
+		u16* entry = row + (((x >> 5) << 10) + (x & 31));
+		switch (mode) {
+			case NF_TILEMAP_READ:
+				memcpy(data, entry, (count << 1));
+				data += count;
+				break;
+			case NF_TILEMAP_WRITE:
+				memcpy(entry, data, (count << 1));
+				data += count;
+				break;
+			default:
+				for (u32 n = 0; n < count; n ++) entry[n] = buffer[0];
+				break;
+		}
+		x += count;
+	}
+
+}
+
+void NF_FillTileMapRect(u8 screen, u8 layer, u16 tile_x, u16 tile_y, u16 width, u16 height, u16 tile) {
+
+	NF_CheckTileMapRect(screen, layer, tile_x, tile_y, width, height);
+
+	for (u32 y = 0; y < height; y ++) {
+		NF_TileMapRow(screen, layer, tile_x, (tile_y + y), width, &tile, NF_TILEMAP_FILL);
+	}
+
+	// Marca el rectangulo como modificado
+	NF_MarkTileMapDirty(screen, layer, tile_x, tile_y, width, height);
+
+}
+
+void NF_SetTileMapRect(u8 screen, u8 layer, u16 tile_x, u16 tile_y, u16 width, u16 height, const u16* source) {
+
+	NF_CheckTileMapRect(screen, layer, tile_x, tile_y, width, height);
+
+	for (u32 y = 0; y < height; y ++) {
+		NF_TileMapRow(screen, layer, tile_x, (tile_y + y), width, (u16*)(source + (y * width)), NF_TILEMAP_WRITE);
+	}
+
+	// Marca el rectangulo como modificado
+	NF_MarkTileMapDirty(screen, layer, tile_x, tile_y, width, height);
+
+}
+
+void NF_GetTileMapRect(u8 screen, u8 layer, u16 tile_x, u16 tile_y, u16 width, u16 height, u16* destination) {
+
+	NF_CheckTileMapRect(screen, layer, tile_x, tile_y, width, height);
+
+	for (u32 y = 0; y < height; y ++) {
+		NF_TileMapRow(screen, layer, tile_x, (tile_y + y), width, (destination + (y * width)), NF_TILEMAP_READ);
+	}
+
+}
+
+void NF_CopyTileMapRect(u8 src_screen, u8 src_layer, u16 src_x, u16 src_y,
+						u8 dst_screen, u8 dst_layer, u16 dst_x, u16 dst_y,
+						u16 width, u16 height) {
+
+	NF_CheckTileMapRect(src_screen, src_layer, src_x, src_y, width, height);
+	NF_CheckTileMapRect(dst_screen, dst_layer, dst_x, dst_y, width, height);
+	if ((width == 0) || (height == 0)) return;
+
+	// Buffer para una fila
+	u16* buffer = (u16*) calloc (width, sizeof(u16));
+	if (buffer == NULL) {		// Si no hay suficiente RAM libre
+		NF_Error(102, NULL, (width << 1));
+	}
+
+	// Si el origen y el destino son el mismo mapa y el destino esta mas abajo,
+	// copia las filas de abajo a arriba para no pisar las que faltan por leer
+	bool same = (NF_TILEDBG_LAYERS[src_screen][src_layer].bgslot == NF_TILEDBG_LAYERS[dst_screen][dst_layer].bgslot);
+	bool upwards = (same && (dst_y > src_y));
+
+	for (u32 n = 0; n < height; n ++) {
+		u32 y = upwards ? ((height - 1) - n) : n;
+		NF_TileMapRow(src_screen, src_layer, src_x, (src_y + y), width, buffer, NF_TILEMAP_READ);
+		NF_TileMapRow(dst_screen, dst_layer, dst_x, (dst_y + y), width, buffer, NF_TILEMAP_WRITE);
+	}
+
+	free(buffer);
+
+	// Marca el rectangulo de destino como modificado
+	NF_MarkTileMapDirty(dst_screen, dst_layer, dst_x, dst_y, width, height);
+
+}
+
+void NF_MarkVramMapDirty(u8 screen, u8 layer) {
+
+	// Verifica que el fondo esta creado
+	if (!NF_TILEDBG_LAYERS[screen][layer].created) {
+		char text[32];
+		snprintf(text, sizeof(text), "%d", screen);
+		NF_Error(105, text, layer);		// Si no existe, error
+	}
+
+	// Marca todas las filas de todos los bloques del mapa en VRAM
+	u32 blocks = ((NF_TILEDBG_LAYERS[screen][layer].mapwidth >> 8) * (NF_TILEDBG_LAYERS[screen][layer].mapheight >> 8));
+	for (u32 n = 0; n < blocks; n ++) {
+		NF_TILEDBG_LAYERS[screen][layer].dirtyrows[n] = 0xFFFFFFFF;
+		NF_TILEDBG_LAYERS[screen][layer].dirtyleft[n] = 0;
+		NF_TILEDBG_LAYERS[screen][layer].dirtyright[n] = 31;
+	}
 
 }
 
@@ -842,9 +1722,15 @@ void NF_UpdateVramMap(u8 screen, u8 layer) {
 
 	// Variables
 	u32 address = 0;		// Direccion de destino
-	u32 mov_x = 0;		// Desplazamiento X
-	u32 mov_y = 0;		// Desplazamiento Y
-	u32 rowsize = 0;	// Tamaño de la fila de pantallas
+	u8 slot = NF_TILEDBG_LAYERS[screen][layer].bgslot;
+	u16* buffer = (u16*)NF_BUFFER_BGMAP[slot];
+	bool metatiles = (NF_TILEDBG[slot].metashift > 0);		// Mapa de metatiles
+	u32 map_w = (NF_TILEDBG_LAYERS[screen][layer].mapwidth >> 3);		// Tiles de ancho en VRAM
+	u32 map_h = (NF_TILEDBG_LAYERS[screen][layer].mapheight >> 3);		// Tiles de alto en VRAM
+	u32 rowblocks = (NF_TILEDBG_LAYERS[screen][layer].bgwidth >> 8);	// Bloques por fila en RAM
+	bool streaming = (NF_TILEDBG_LAYERS[screen][layer].streaming && (NF_TILEDBG_LAYERS[screen][layer].bgtype > 0));
+	u32 offset_x = 0;		// Primer tile del fondo que esta en VRAM
+	u32 offset_y = 0;
 
 	// Calcula la direccion base del mapa
 	if (screen == 0) {	// (VRAM_A)
@@ -853,41 +1739,228 @@ void NF_UpdateVramMap(u8 screen, u8 layer) {
 		address = (0x6200000) + (NF_TILEDBG_LAYERS[screen][layer].mapbase << 11);
 	}
 
-	// Segun el tipo de mapa
-	switch (NF_TILEDBG_LAYERS[screen][layer].bgtype) {
+	// Segun el tipo de mapa, calcula que bloques del fondo estan en VRAM
+	if (streaming) {
+		offset_x = NF_TILEDBG_LAYERS[screen][layer].streamx;
+		offset_y = NF_TILEDBG_LAYERS[screen][layer].streamy;
+	} else {
+		if ((NF_TILEDBG_LAYERS[screen][layer].bgtype == 1) || (NF_TILEDBG_LAYERS[screen][layer].bgtype == 3)) {
+			offset_x = (NF_TILEDBG_LAYERS[screen][layer].blockx << 5);
+		}
+		if ((NF_TILEDBG_LAYERS[screen][layer].bgtype == 2) || (NF_TILEDBG_LAYERS[screen][layer].bgtype == 3)) {
+			offset_y = (NF_TILEDBG_LAYERS[screen][layer].blocky << 5);
+		}
+	}
+
+	// Copia las filas modificadas de cada bloque de 32x32 tiles
+	u32 blocks = ((map_w >> 5) * (map_h >> 5));
+	for (u32 n = 0; n < blocks; n ++) {
+
+		u32 rows = NF_TILEDBG_LAYERS[screen][layer].dirtyrows[n];
+		if (rows == 0) continue;
+		NF_TILEDBG_LAYERS[screen][layer].dirtyrows[n] = 0;
+
+		// Si la ventana del streaming aun no se ha copiado, lo hara NF_ScrollBg()
+		if (streaming && (offset_x == 0xFFFF)) continue;
+
+		u32 left = NF_TILEDBG_LAYERS[screen][layer].dirtyleft[n];
+		u32 right = NF_TILEDBG_LAYERS[screen][layer].dirtyright[n];
+		u32 block_x = ((n % (map_w >> 5)) << 5);		// Primer tile del bloque en VRAM
+		u32 block_y = ((n / (map_w >> 5)) << 5);
+		u16* vram = (u16*)(address + (n << 11));
+
+		if (streaming) {
+
+			// Buffer circular: busca a que tile de la ventana corresponde cada posicion
+			while (rows != 0) {
+				u32 row = __builtin_ctz(rows);
+				rows &= (rows - 1);
+				u32 dy = (((block_y + row) - offset_y) & (map_h - 1));
+				if (dy >= NF_STREAM_WINDOW_HEIGHT) continue;
+				u32 y = (offset_y + dy);
+				u16* src_row = buffer + ((((y >> 5) * rowblocks) << 10) + ((y & 31) << 5));
+				for (u32 column = left; column <= right; column ++) {
+					u32 dx = (((block_x + column) - offset_x) & (map_w - 1));
+					if (dx >= NF_STREAM_WINDOW_WIDTH) continue;
+					u32 x = (offset_x + dx);
+					if (metatiles) {
+						vram[(row << 5) + column] = NF_GetMetatileMapTile(slot, x, y);
+					} else {
+						vram[(row << 5) + column] = src_row[((x >> 5) << 10) + (x & 31)];
+					}
+					NF_TILEDBG_UPLOAD_BYTES += 2;
+				}
+			}
 
-		case 0:	// 256x256  -  Bloque A (32x32) (2kb)
-			// Copias el Bloque A (32x32) (2kb)
-			NF_DmaMemCopy((void*)address, NF_BUFFER_BGMAP[NF_TILEDBG_LAYERS[screen][layer].bgslot], 2048);
-			break;
+		} else if (metatiles) {
+
+			// Mapa de metatiles: expande los tiles modificados en el buffer
+			// intermedio de la capa, en la misma posicion que tienen en VRAM, y
+			// añade la copia de cada fila a la cola
+			u16* staging = NF_TILEDBG_LAYERS[screen][layer].staging + (n << 10);
+			u32 size = (((right - left) + 1) << 1);
+			while (rows != 0) {
+				u32 row = __builtin_ctz(rows);
+				rows &= (rows - 1);
+				for (u32 column = left; column <= right; column ++) {
+					staging[(row << 5) + column] = NF_GetMetatileMapTile(slot, (block_x + offset_x + column), (block_y + offset_y + row));
+				}
+				NF_QueueVramCopy((vram + (row << 5) + left), (staging + (row << 5) + left), size);
+				NF_TILEDBG_UPLOAD_BYTES += size;
+			}
 
-		case 1:	// 512x256  -  Bloque A y B (32x32) + (32x32) (2kb x 2 = 4kb)
-			// Calcula el desplazamiento de datos
-			mov_x = (NF_TILEDBG_LAYERS[screen][layer].blockx << 11);
-			// Copias los Bloques A y B (32x32) + (32x32) (2kb x 2 = 4kb)
-			NF_DmaMemCopy((void*)address, (NF_BUFFER_BGMAP[NF_TILEDBG_LAYERS[screen][layer].bgslot] + mov_x), 4096);
-			break;
+		} else {
+
+			// El bloque de VRAM corresponde a un bloque entero del fondo en RAM
+			u16* ram = buffer + ((((((block_y + offset_y) >> 5) * rowblocks) + ((block_x + offset_x) >> 5))) << 10);
+
+			if ((rows == 0xFFFFFFFF) && (left == 0) && (right == 31)) {
+				// Bloque entero (2kb)
+				NF_QueueVramCopy(vram, ram, 2048);
+				NF_TILEDBG_UPLOAD_BYTES += 2048;
+			} else {
+				// Solo el rango de columnas de las filas modificadas
+				u32 size = (((right - left) + 1) << 1);
+				while (rows != 0) {
+					u32 row = __builtin_ctz(rows);
+					rows &= (rows - 1);
+					NF_QueueVramCopy((vram + (row << 5) + left), (ram + (row << 5) + left), size);
+					NF_TILEDBG_UPLOAD_BYTES += size;
+				}
+			}
 
+		}
 
-		case 2:	// 256x512  -  Bloque A (32x64) (2kb x 2 = 4kb)
-			// Calcula el desplazamiento de datos
-			mov_y = (NF_TILEDBG_LAYERS[screen][layer].blocky << 11);
-			// Copias los Bloques A y B (32x32) + (32x32) (2kb x 2 = 4kb)
-			NF_DmaMemCopy((void*)address, (NF_BUFFER_BGMAP[NF_TILEDBG_LAYERS[screen][layer].bgslot] + mov_y), 4096);
-			break;
+	}
 
-		case 3: // >512x>512
-			// Calcula el Rowsize
-			rowsize = (((((NF_TILEDBG_LAYERS[screen][layer].bgwidth - 1) >> 8)) + 1) << 11);
-			// Y el desplazamiento de datos
-			mov_x = (NF_TILEDBG_LAYERS[screen][layer].blocky * rowsize) + (NF_TILEDBG_LAYERS[screen][layer].blockx << 11);
-			mov_y = mov_x + rowsize;
-			// Bloque A y B (32x32) + (32x32) (2kb x 2 = 4kb)
-			NF_DmaMemCopy((void*)address, (NF_BUFFER_BGMAP[NF_TILEDBG_LAYERS[screen][layer].bgslot] + mov_x), 4096);
-			// Bloque (+4096) C y D (32x32) + (32x32) (2kb x 2 = 4kb)
-			NF_DmaMemCopy((void*)(address + 4096), (NF_BUFFER_BGMAP[NF_TILEDBG_LAYERS[screen][layer].bgslot] + mov_y), 4096);
-			break;
+}
+
+void NF_EnableTiledBgStreaming(u8 screen, u8 layer) {
+
+	// Verifica que el fondo esta creado
+	if (!NF_TILEDBG_LAYERS[screen][layer].created) {
+		char text[32];
+		snprintf(text, sizeof(text), "%d", screen);
+		NF_Error(105, text, layer);		// Si no existe, error
+	}
+
+	// Activa el streaming y fuerza la copia completa de la ventana visible
+	NF_TILEDBG_LAYERS[screen][layer].streaming = true;
+	NF_TILEDBG_LAYERS[screen][layer].streamx = 0xFFFF;
+	NF_TILEDBG_LAYERS[screen][layer].streamy = 0;
+	memset(NF_TILEDBG_LAYERS[screen][layer].dirtyrows, 0, sizeof(NF_TILEDBG_LAYERS[screen][layer].dirtyrows));
+
+}
+
+void NF_DisableTiledBgStreaming(u8 screen, u8 layer) {
+
+	// Verifica que el fondo esta creado
+	if (!NF_TILEDBG_LAYERS[screen][layer].created) {
+		char text[32];
+		snprintf(text, sizeof(text), "%d", screen);
+		NF_Error(105, text, layer);		// Si no existe, error
+	}
+
+	// Desactiva el streaming
+	NF_TILEDBG_LAYERS[screen][layer].streaming = false;
+	NF_TILEDBG_LAYERS[screen][layer].streamx = 0xFFFF;
+	NF_TILEDBG_LAYERS[screen][layer].streamy = 0;
+	memset(NF_TILEDBG_LAYERS[screen][layer].dirtyrows, 0, sizeof(NF_TILEDBG_LAYERS[screen][layer].dirtyrows));
+
+	// Invalida el bloque actual para que NF_ScrollBg() vuelva a copiar el mapa
+	NF_TILEDBG_LAYERS[screen][layer].blockx = 255;
+	NF_TILEDBG_LAYERS[screen][layer].blocky = 255;
+
+}
+
+void NF_StreamTiledBgArea(u8 screen, u8 layer, u16 tile_x, u16 tile_y, u16 width, u16 height) {
+
+	// Medidas en tiles del fondo en RAM y del mapa en VRAM
+	u32 bg_w = (NF_TILEDBG_LAYERS[screen][layer].bgwidth >> 3);
+	u32 bg_h = (NF_TILEDBG_LAYERS[screen][layer].bgheight >> 3);
+	u32 map_w = (NF_TILEDBG_LAYERS[screen][layer].mapwidth >> 3);
+	u32 map_h = (NF_TILEDBG_LAYERS[screen][layer].mapheight >> 3);
+
+	// Recorta el area a las medidas del fondo
+	if ((tile_x >= bg_w) || (tile_y >= bg_h)) return;
+	if ((u32)(tile_x + width) > bg_w) width = (bg_w - tile_x);
+	if ((u32)(tile_y + height) > bg_h) height = (bg_h - tile_y);
+
+	// Punteros al mapa en RAM y en VRAM
+	u16* src = (u16*)NF_BUFFER_BGMAP[NF_TILEDBG_LAYERS[screen][layer].bgslot];
+	u16* dst;
+	if (screen == 0) {	// (VRAM_A)
+		dst = (u16*)((0x6000000) + (NF_TILEDBG_LAYERS[screen][layer].mapbase << 11));
+	} else {			// (VRAM_C)
+		dst = (u16*)((0x6200000) + (NF_TILEDBG_LAYERS[screen][layer].mapbase << 11));
+	}
+
+	// Los mapas estan ordenados en bloques de 32x32 tiles (1024 entradas), en filas.
+	// El mapa de VRAM se usa como buffer circular: el tile (x, y) del fondo va
+	// en la posicion (x % ancho, y % alto) del mapa de VRAM.
+	u32 src_rowblocks = (bg_w >> 5);		// Bloques por fila de pantallas en RAM
+	u32 dst_rowblocks = (map_w >> 5);		// Bloques por fila de pantallas en VRAM
+
+	u8 slot = NF_TILEDBG_LAYERS[screen][layer].bgslot;
+	bool metatiles = (NF_TILEDBG[slot].metashift > 0);
+
+	for (u32 y = tile_y; y < (u32)(tile_y + height); y ++) {
+		u16* src_row = src + ((((y >> 5) * src_rowblocks) << 10) + ((y & 31) << 5));
+		u32 hy = (y & (map_h - 1));
+		u16* dst_row = dst + ((((hy >> 5) * dst_rowblocks) << 10) + ((hy & 31) << 5));
+		for (u32 x = tile_x; x < (u32)(tile_x + width); x ++) {
+			u32 hx = (x & (map_w - 1));
+			if (metatiles) {
+				// Los mapas de metatiles se expanden al copiarlos
+				dst_row[((hx >> 5) << 10) + (hx & 31)] = NF_GetMetatileMapTile(slot, x, y);
+			} else {
+				dst_row[((hx >> 5) << 10) + (hx & 31)] = src_row[((x >> 5) << 10) + (x & 31)];
+			}
+		}
+	}
+
+	// Bytes copiados a VRAM
+	NF_TILEDBG_UPLOAD_BYTES += ((width * height) << 1);
+
+}
+
+void NF_StreamTiledBg(u8 screen, u8 layer, s16 x, s16 y) {
 
+	// Primera columna y fila visibles
+	u16 new_x = (x >> 3);
+	u16 new_y = (y >> 3);
+	u16 old_x = NF_TILEDBG_LAYERS[screen][layer].streamx;
+	u16 old_y = NF_TILEDBG_LAYERS[screen][layer].streamy;
+
+	// Si la ventana no ha cambiado, no hay nada que copiar
+	if ((new_x == old_x) && (new_y == old_y)) return;
+
+	// Guarda la nueva ventana
+	NF_TILEDBG_LAYERS[screen][layer].streamx = new_x;
+	NF_TILEDBG_LAYERS[screen][layer].streamy = new_y;
+
+	// Si no habia ventana, o el salto es mayor que la ventana, copiala entera
+	if ((old_x == 0xFFFF)
+	|| (abs(new_x - old_x) >= NF_STREAM_WINDOW_WIDTH)
+	|| (abs(new_y - old_y) >= NF_STREAM_WINDOW_HEIGHT)) {
+		NF_StreamTiledBgArea(screen, layer, new_x, new_y, NF_STREAM_WINDOW_WIDTH, NF_STREAM_WINDOW_HEIGHT);
+		return;
+	}
+
+	// Columnas que han entrado en la ventana (con todas las filas visibles)
+	if (new_x > old_x) {
+		NF_StreamTiledBgArea(screen, layer, (old_x + NF_STREAM_WINDOW_WIDTH), new_y,
+			(new_x - old_x), NF_STREAM_WINDOW_HEIGHT);
+	} else if (new_x < old_x) {
+		NF_StreamTiledBgArea(screen, layer, new_x, new_y, (old_x - new_x), NF_STREAM_WINDOW_HEIGHT);
+	}
+
+	// Filas que han entrado en la ventana (con todas las columnas visibles)
+	if (new_y > old_y) {
+		NF_StreamTiledBgArea(screen, layer, new_x, (old_y + NF_STREAM_WINDOW_HEIGHT),
+			NF_STREAM_WINDOW_WIDTH, (new_y - old_y));
+	} else if (new_y < old_y) {
+		NF_StreamTiledBgArea(screen, layer, new_x, new_y, NF_STREAM_WINDOW_WIDTH, (old_y - new_y));
 	}
 
 }
@@ -907,7 +1980,13 @@ void NF_BgSetPalColor(u8 screen, u8 layer, u8 number, u8 r, u8 g, u8 b) {
 	u32 address = 0;
 
 	// Modifica la paleta
-	if (screen == 0) {
+	if (NF_TILEDBG[NF_TILEDBG_LAYERS[screen][layer].bgslot].bpp == 4) {
+
+		// Fondo de 16 colores (paleta estandar)
+		address = NF_TiledBgPalAddress(screen) + (number << 1);
+		*((u16*)address) = rgb;
+
+	} else if (screen == 0) {
 
 		vramSetBankE(VRAM_E_LCD);
 		address = (0x06880000) + (layer << 13) + (number << 1);
@@ -963,19 +2042,22 @@ void NF_BgUpdatePalette(u8 screen, u8 layer) {
 	u8 slot = NF_TILEDBG_LAYERS[screen][layer].bgslot;
 
 	// Tranfiere la Paleta a VRAM
-	if (screen == 0) {
+	if (NF_TILEDBG[slot].bpp == 4) {
 
-		vramSetBankE(VRAM_E_LCD);
+		// Fondo de 16 colores (paleta estandar, no hace falta mapear bancos)
+		address = NF_TiledBgPalAddress(screen);
+		NF_QueueVramCopy((void*)address, NF_BUFFER_BGPAL[slot], NF_TILEDBG[slot].palsize);
+
+	} else if (screen == 0) {
+
+		// El banco E se mapea como LCD durante la copia
 		address = (0x06880000) + (layer << 13);
-		NF_DmaMemCopy((void*)address, NF_BUFFER_BGPAL[slot], NF_TILEDBG[slot].palsize);
-		vramSetBankE(VRAM_E_BG_EXT_PALETTE);
+		NF_QueueVramBankCopy(&VRAM_E_CR, (void*)address, NF_BUFFER_BGPAL[slot], NF_TILEDBG[slot].palsize);
 
 	} else {	// Paletas de la pantalla 1 (VRAM_H)
 
-		vramSetBankH(VRAM_H_LCD);
 		address = (0x06898000) + (layer << 13);
-		NF_DmaMemCopy((void*)address, NF_BUFFER_BGPAL[slot], NF_TILEDBG[slot].palsize);
-		vramSetBankH(VRAM_H_SUB_BG_EXT_PALETTE);
+		NF_QueueVramBankCopy(&VRAM_H_CR, (void*)address, NF_BUFFER_BGPAL[slot], NF_TILEDBG[slot].palsize);
 
 	}
 
@@ -1007,10 +2089,10 @@ void NF_BgGetPalColor(u8 screen, u8 layer, u8 number, u8* r, u8* g, u8* b) {
 u8 NF_GetTilePal(u8 screen, u8 layer, u16 tile_x, u16 tile_y) {
 
 	// Obten la direccion en el buffer del Tile
-	u32 address = NF_GetTileMapAddress(screen, layer, tile_x, tile_y);
+	char* entry = NF_GetTileMapEntry(screen, layer, tile_x, tile_y, false);
 
 	// Obten los bytes
-	u8 hibyte = *(NF_BUFFER_BGMAP[NF_TILEDBG_LAYERS[screen][layer].bgslot] + (address + 1));
+	u8 hibyte = *(entry + 1);
 
 	// Devuelve el nº de la paleta (4 ultimos bits del HI-Byte)
 	return ((hibyte >> 4) & 0x0F);
@@ -1020,16 +2102,20 @@ u8 NF_GetTilePal(u8 screen, u8 layer, u16 tile_x, u16 tile_y) {
 void NF_SetTilePal(u8 screen, u8 layer, u16 tile_x, u16 tile_y, u8 pal) {
 
 	// Obten la direccion en el buffer del Tile
-	u32 address = NF_GetTileMapAddress(screen, layer, tile_x, tile_y);
+	char* entry = NF_GetTileMapEntry(screen, layer, tile_x, tile_y, true);
 
 	// Obten el valor actual del HI-Byte
-	u8 hibyte = *(NF_BUFFER_BGMAP[NF_TILEDBG_LAYERS[screen][layer].bgslot] + (address + 1));
+	u8 hibyte = *(entry + 1);
 
 	// Y determina el valor del resto de datos del byte, excluyendo la paleta
 	u8 data = (hibyte & 0x0F);
 
 	// Graba los bytes
-	*(NF_BUFFER_BGMAP[NF_TILEDBG_LAYERS[screen][layer].bgslot] + (address + 1)) = ((pal << 4) | data);
+	*(entry + 1) = ((pal << 4) | data);
+
+
+	// Marca el tile como modificado
+	NF_MarkTileDirty(screen, layer, tile_x, tile_y);
 
 }
 
@@ -1047,34 +2133,15 @@ void NF_LoadExBgPal(const char* file, u8 slot) {
 	free(NF_EXBGPAL[slot].buffer);
 	NF_EXBGPAL[slot].buffer = NULL;
 
-	// Declara los punteros a los ficheros
-	FILE* file_id;
-
 	// Variable para almacenar el path al archivo
 	char filename[256];
 
-	// Carga el archivo .PAL
+	// Carga el archivo .PAL (como minimo de 512 bytes)
 	snprintf(filename, sizeof(filename), "%s/%s.pal", NF_ROOTFOLDER, file);
-	file_id = fopen(filename, "rb");
-	if (file_id) {	// Si el archivo existe...
-		// Obten el tamaño del archivo
-		fseek(file_id, 0, SEEK_END);
-		pal_size = ftell(file_id);
-		NF_EXBGPAL[slot].palsize = pal_size;
-		rewind(file_id);
-		// Si el tamaño es inferior a 512 bytes, ajustalo
-		if (NF_EXBGPAL[slot].palsize < 512) NF_EXBGPAL[slot].palsize = 512;
-		// Reserva el espacio en RAM
-		NF_EXBGPAL[slot].buffer = (char*) calloc (NF_EXBGPAL[slot].palsize, sizeof(char));
-		if (NF_EXBGPAL[slot].buffer == NULL) {		// Si no hay suficiente RAM libre
-			NF_Error(102, NULL, NF_EXBGPAL[slot].palsize);
-		}
-		// Lee el archivo y ponlo en la RAM
-		fread(NF_EXBGPAL[slot].buffer, 1, pal_size, file_id);
-	} else {	// Si el archivo no existe...
-		NF_Error(101, filename, 0);
-	}
-	fclose(file_id);		// Cierra el archivo
+	NF_FileLoad(filename, &NF_EXBGPAL[slot].buffer, &pal_size, 512);
+	NF_EXBGPAL[slot].palsize = pal_size;
+	// Si el tamaño es inferior a 512 bytes, ajustalo
+	if (NF_EXBGPAL[slot].palsize < 512) NF_EXBGPAL[slot].palsize = 512;
 
 	// Guarda el estado del slot
 	NF_EXBGPAL[slot].inuse = true;
@@ -1147,8 +2214,10 @@ void NF_SetExBgPal(u8 screen, u8 layer, u8 pal) {
 		NF_Error(105, text, layer);		// Si no existe, error
 	}
 
-	// Tamaño del buffer
-	u32 mapsize = NF_TILEDBG[NF_TILEDBG_LAYERS[screen][layer].bgslot].mapsize;
+	// Entradas del mapa (o del diccionario de metatiles)
+	u32 entries = 0;
+	char* buffer = (char*)NF_TiledBgEntries(NF_TILEDBG_LAYERS[screen][layer].bgslot, &entries);
+	u32 mapsize = (entries << 1);
 	// Variables comunes
 	u32 pos = 0;
 	u16 hibyte = 0;
@@ -1156,14 +2225,15 @@ void NF_SetExBgPal(u8 screen, u8 layer, u8 pal) {
 
 	for (pos = 0; pos < mapsize; pos += 2) {
 		// Obten el valor actual del HI-Byte
-		hibyte = *(NF_BUFFER_BGMAP[NF_TILEDBG_LAYERS[screen][layer].bgslot] + (pos + 1));
+		hibyte = *(buffer + (pos + 1));
 		// Y determina el valor del resto de datos del byte, excluyendo la paleta
 		data = (hibyte & 0x0F);
 		// Graba los bytes
-		*(NF_BUFFER_BGMAP[NF_TILEDBG_LAYERS[screen][layer].bgslot] + (pos + 1)) = ((pal << 4) | data);
+		*(buffer + (pos + 1)) = ((pal << 4) | data);
 	}
 
 	// Actualiza el mapa en la VRAM
+	NF_MarkVramMapDirty(screen, layer);
 	NF_UpdateVramMap(screen, layer);
 
 }
@@ -1171,32 +2241,40 @@ void NF_SetExBgPal(u8 screen, u8 layer, u8 pal) {
 void NF_SetTileHflip(u8 screen, u8 layer, u16 tile_x, u16 tile_y) {
 
 	// Obten la direccion en el buffer del Tile
-	u32 address = NF_GetTileMapAddress(screen, layer, tile_x, tile_y);
+	char* entry = NF_GetTileMapEntry(screen, layer, tile_x, tile_y, true);
 
 	// Obten el valor actual del HI-Byte
-	u8 hibyte = *(NF_BUFFER_BGMAP[NF_TILEDBG_LAYERS[screen][layer].bgslot] + (address + 1));
+	u8 hibyte = *(entry + 1);
 
 	// Invierte el BIT correspondiente a FLIP horizontal del tile (BIT 3)
 	hibyte ^= 0x04;
 
 	// Graba el valor actualizado
-	*(NF_BUFFER_BGMAP[NF_TILEDBG_LAYERS[screen][layer].bgslot] + (address + 1)) = hibyte;
+	*(entry + 1) = hibyte;
+
+
+	// Marca el tile como modificado
+	NF_MarkTileDirty(screen, layer, tile_x, tile_y);
 
 }
 
 void NF_SetTileVflip(u8 screen, u8 layer, u16 tile_x, u16 tile_y) {
 
 	// Obten la direccion en el buffer del Tile
-	u32 address = NF_GetTileMapAddress(screen, layer, tile_x, tile_y);
+	char* entry = NF_GetTileMapEntry(screen, layer, tile_x, tile_y, true);
 
 	// Obten el valor actual del HI-Byte
-	u8 hibyte = *(NF_BUFFER_BGMAP[NF_TILEDBG_LAYERS[screen][layer].bgslot] + (address + 1));
+	u8 hibyte = *(entry + 1);
 
 	// Invierte el BIT correspondiente a FLIP vertical del tile (BIT 4)
 	hibyte ^= 0x08;
 
 	// Graba el valor actualizado
-	*(NF_BUFFER_BGMAP[NF_TILEDBG_LAYERS[screen][layer].bgslot] + (address + 1)) = hibyte;
+	*(entry + 1) = hibyte;
+
+
+	// Marca el tile como modificado
+	NF_MarkTileDirty(screen, layer, tile_x, tile_y);
 
 }
 
@@ -1225,7 +2303,16 @@ void NF_RotateTileGfx(u8 slot, u16 tile, u8 rotation) {
 	s16 pos_b = 0;
 
 	// Copia el tile al buffer temporal A
-	memcpy(character_a, (NF_BUFFER_BGTILES[slot] + (tile << 6)), 64);
+	if (NF_TILEDBG[slot].bpp == 4) {
+		// A 16 colores, separa los 2 pixeles de cada byte
+		u8* source = (u8*)(NF_BUFFER_BGTILES[slot] + (tile << 5));
+		for (pos_a = 0; pos_a < 32; pos_a ++) {
+			character_a[(pos_a << 1)] = (source[pos_a] & 0x0F);
+			character_a[((pos_a << 1) + 1)] = (source[pos_a] >> 4);
+		}
+	} else {
+		memcpy(character_a, (NF_BUFFER_BGTILES[slot] + (tile << 6)), 64);
+	}
 
 	switch (rotation) {
 
@@ -1286,10 +2373,125 @@ void NF_RotateTileGfx(u8 slot, u16 tile, u8 rotation) {
 	}
 
 	// Copia el tile desde buffer temporal B
-	memcpy((NF_BUFFER_BGTILES[slot] + (tile << 6)), character_b, 64);
+	if (NF_TILEDBG[slot].bpp == 4) {
+		// A 16 colores, junta los pixeles de 2 en 2
+		u8* destination = (u8*)(NF_BUFFER_BGTILES[slot] + (tile << 5));
+		for (pos_b = 0; pos_b < 32; pos_b ++) {
+			destination[pos_b] = (character_b[(pos_b << 1)] | (character_b[((pos_b << 1) + 1)] << 4));
+		}
+	} else {
+		memcpy((NF_BUFFER_BGTILES[slot] + (tile << 6)), character_b, 64);
+	}
 
 	// Libera los buffers temporales
 	free (character_a);
 	free (character_b);
 
 }
+
+u8 NF_CreateTiledBgAnim(const char* name, u16 tile, u16 count, u16 source, u8 frames, const u8* delays) {
+
+	u8 slot = NF_GetTiledBgSlot(name);
+
+	// Si aun se esta cargando, termina la carga
+	if (NF_TILEDBG[slot].loading) NF_LoaderWaitAll();
+
+	// Los tiles de un fondo deduplicado ya no estan en su posicion original
+	if (NF_TILEDBG[slot].deduped) NF_Error(121, name, 255);
+
+	// Verifica los parametros
+	if ((frames == 0) || (frames > NF_TBGANIM_FRAMES)) {
+		NF_Error(106, "Anim frames", NF_TBGANIM_FRAMES);
+	}
+	u32 tiles = (NF_TILEDBG[slot].tilesize >> ((NF_TILEDBG[slot].bpp == 4) ? 5 : 6));
+	if ((count == 0) || ((u32)(tile + count) > tiles)) {
+		NF_Error(106, "Anim tiles", tiles);
+	}
+	if ((u32)(source + (frames * count)) > tiles) {
+		NF_Error(106, "Anim frames", tiles);
+	}
+
+	// Busca un slot libre
+	u8 id = 255;
+	for (int n = 0; n < NF_SLOTS_TBGANIM; n ++) {
+		if (!NF_TBGANIM[n].inuse) {
+			id = n;
+			break;
+		}
+	}
+	if (id == 255) {		// Si no hay ninguno, error
+		NF_Error(103, "Tiled Bg Anim", NF_SLOTS_TBGANIM);
+	}
+
+	// Guarda los datos de la animacion
+	NF_TBGANIM[id].tile = tile;
+	NF_TBGANIM[id].count = count;
+	NF_TBGANIM[id].source = source;
+	NF_TBGANIM[id].slot = slot;
+	NF_TBGANIM[id].frames = frames;
+	NF_TBGANIM[id].frame = 0;
+	NF_TBGANIM[id].timer = 0;		// Copia el primer frame en la siguiente actualizacion
+	for (int n = 0; n < frames; n ++) {
+		NF_TBGANIM[id].delays[n] = (delays[n] > 0) ? delays[n] : 1;
+	}
+	NF_TBGANIM[id].inuse = true;
+
+	return id;
+
+}
+
+void NF_DeleteTiledBgAnim(u8 id) {
+
+	if (id >= NF_SLOTS_TBGANIM) {
+		NF_Error(106, "Tiled Bg Anim", (NF_SLOTS_TBGANIM - 1));
+	}
+
+	NF_TBGANIM[id].inuse = false;
+
+}
+
+void NF_UpdateTiledBgAnims(void) {
+
+	for (int n = 0; n < NF_SLOTS_TBGANIM; n ++) {
+
+		NF_TYPE_TBGANIM_INFO* anim = &NF_TBGANIM[n];
+		if (!anim->inuse) continue;
+
+		// Espera a que termine el frame actual
+		if (anim->timer > 0) {
+			anim->timer --;
+			if (anim->timer > 0) continue;
+			anim->frame ++;
+			if (anim->frame >= anim->frames) anim->frame = 0;
+		}
+		anim->timer = anim->delays[anim->frame];
+
+		// Graficos del frame en RAM
+		u32 shift = (NF_TILEDBG[anim->slot].bpp == 4) ? 5 : 6;
+		u32 size = (anim->count << shift);
+		char* source = NF_BUFFER_BGTILES[anim->slot] + ((anim->source + (anim->frame * anim->count)) << shift);
+
+		// Copialos a los tilesets en VRAM de las capas que muestran el fondo. Las
+		// capas que comparten el tileset solo se actualizan una vez (los fondos
+		// affine no comparten tileset con otras capas).
+		for (u8 screen = 0; screen < 2; screen ++) {
+			u8 done[4];
+			u8 done_count = 0;
+			for (u8 layer = 0; layer < 4; layer ++) {
+				if (!NF_TILEDBG_LAYERS[screen][layer].created) continue;
+				if (NF_TILEDBG_LAYERS[screen][layer].bgslot != anim->slot) continue;
+				u8 tilebase = NF_TILEDBG_LAYERS[screen][layer].tilebase;
+				bool shared = false;
+				for (u8 i = 0; i < done_count; i ++) {
+					if (done[i] == tilebase) shared = true;
+				}
+				if (shared) continue;
+				done[done_count ++] = tilebase;
+				u32 address = ((screen == 0) ? 0x6000000 : 0x6200000) + (tilebase << 14);
+				NF_QueueVramCopy((void*)(address + (anim->tile << shift)), source, size);
+			}
+		}
+
+	}
+
+}
@@ -0,0 +1,289 @@
+// SPDX-License-Identifier: CC0-1.0
+//
+// SPDX-FileContributor: NightFox & Co., 2009-2011
+//
+// Host-side benchmark of the drawing primitives of nf_bitmapdraw.c
+// http://www.nightfoxandco.com
+//
+// Each primitive is called many times over the 16-bit and 8-bit backbuffers
+// and the pixels per second drawn by it are printed. The DMA fills of big
+// blocks are done with memory writes by the CPU of the host. The results are
+// useful to compare versions of the primitives, not to predict the speed on
+// the DS.
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+
+#include <nds.h>
+
+#include "nf_bitmapbg.h"
+#include "nf_bitmapdraw.h"
+
+#ifndef MAP_32BIT
+#error "MAP_32BIT is required to emulate the 32-bit DMA registers"
+#endif
+
+// Number of calls of each test
+#define CALLS 65536
+
+// Emulation of the hardware used by nf_bitmapdraw.c
+
+nds_host_dma_t nds_host_dma[4];
+
+static vu32 nds_host_ime;
+
+// Does the transfer started in a DMA channel, if any
+static void DmaRun(u8 channel)
+{
+    nds_host_dma_t *dma = &nds_host_dma[channel];
+
+    if ((dma->cr & DMA_ENABLE) == 0)
+        return;
+
+    u32 *dst = (u32 *)(uintptr_t)dma->dest;
+    u32 words = dma->cr & 0x1FFFFF;
+
+    if (dma->cr & DMA_SRC_FIX)
+    {
+        u32 value = dma->fill;
+        for (u32 n = 0; n < words; n++)
+            dst[n] = value;
+    }
+    else
+    {
+        memcpy(dst, (const void *)(uintptr_t)dma->src, words << 2);
+    }
+
+    dma->cr &= ~DMA_ENABLE;
+}
+
+vu32 *nds_host_reg_ime(void)
+{
+    for (int n = 0; n < 4; n++)
+        DmaRun(n);
+
+    return &nds_host_ime;
+}
+
+bool dmaBusy(u8 channel)
+{
+    DmaRun(channel);
+    return false;
+}
+
+// Definitions required by nf_bitmapdraw.c
+
+u16 *NF_16BITS_BACKBUFFER[2];
+NF_TYPE_BB8B_INFO NF_8BITS_BACKBUFFER[2];
+
+void NF_Mark16bitsBackBufferDirty(u8 screen, s16 x, s16 y, u16 w, u16 h)
+{
+    (void)screen;
+    (void)x;
+    (void)y;
+    (void)w;
+    (void)h;
+}
+
+void NF_Mark8bitsBackBufferDirty(u8 screen, s16 x, s16 y, u16 w, u16 h)
+{
+    (void)screen;
+    (void)x;
+    (void)y;
+    (void)w;
+    (void)h;
+}
+
+// Benchmark
+
+// Paletted test image
+#define SPR_SIZE 32
+static u8 sprite[SPR_SIZE * SPR_SIZE];
+static u16 palette[256];
+
+static u32 failures;
+
+// Allocates a buffer with a 32-bit address, like all addresses of the DS
+static void *Alloc32(size_t size)
+{
+    void *buffer = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT, -1, 0);
+    if (buffer == MAP_FAILED)
+    {
+        printf("Can't allocate %zu bytes below 4 GB\n", size);
+        exit(1);
+    }
+
+    return buffer;
+}
+
+static double Now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + (ts.tv_nsec / 1e9);
+}
+
+// Prints the pixels per second drawn by a test
+static void Report(const char *name, double start, u64 pixels)
+{
+    double seconds = Now() - start;
+    if (seconds <= 0)
+        seconds = 1e-9;
+
+    printf("%-16s %14.0f px/s\n", name, pixels / seconds);
+}
+
+static void Bench16(void)
+{
+    double start;
+
+    printf("16-bit backbuffer\n");
+
+    // Horizontal spans of 200 pixels
+    start = Now();
+    for (int n = 0; n < CALLS; n++)
+        NF_Draw16bitsHLine(0, n & 31, n & 255, 200, n | BIT(15));
+    Report("HLine", start, (u64)CALLS * 200);
+
+    // Vertical spans of 150 pixels
+    start = Now();
+    for (int n = 0; n < CALLS; n++)
+        NF_Draw16bitsVLine(0, n & 255, n & 31, 150, n | BIT(15));
+    Report("VLine", start, (u64)CALLS * 150);
+
+    // Rectangles of 64x64 pixels
+    start = Now();
+    for (int n = 0; n < CALLS; n++)
+        NF_Fill16bitsRect(0, n & 127, n & 127, 64, 64, n | BIT(15));
+    Report("Rect 64x64", start, (u64)CALLS * 64 * 64);
+
+    // Full screen clears, filled with DMA
+    start = Now();
+    for (int n = 0; n < (CALLS / 16); n++)
+        NF_Fill16bitsRect(0, 0, 0, 256, 256, n | BIT(15));
+    Report("Clear", start, (u64)(CALLS / 16) * 65536);
+
+    // Check that the DMA fill has reached every pixel
+    u16 color = ((CALLS / 16) - 1) | BIT(15);
+    for (int n = 0; n < 65536; n++)
+    {
+        if (NF_16BITS_BACKBUFFER[0][n] != color)
+        {
+            printf("  16-bit clear failed at pixel %d\n", n);
+            failures++;
+            break;
+        }
+    }
+
+    // Diagonal lines of 192 pixels
+    start = Now();
+    for (int n = 0; n < CALLS; n++)
+        NF_Draw16bitsLine(0, n & 63, 0, (n & 63) + 191, 191, n | BIT(15));
+    Report("Line", start, (u64)CALLS * 192);
+
+    // Filled circles with a radius of 32 pixels (about 3217 pixels)
+    start = Now();
+    for (int n = 0; n < CALLS; n++)
+        NF_Draw16bitsCircle(0, 64 + (n & 127), 96, 32, n | BIT(15), true);
+    Report("Circle", start, (u64)CALLS * 3217);
+
+    // Paletted sprites of 32x32 pixels
+    start = Now();
+    for (int n = 0; n < CALLS; n++)
+        NF_Draw16bitsSprite(0, sprite, palette, n & 127, (n * 3) & 127, SPR_SIZE, SPR_SIZE);
+    Report("Sprite 32", start, (u64)CALLS * SPR_SIZE * SPR_SIZE);
+}
+
+static void Bench8(void)
+{
+    double start;
+
+    printf("8-bit backbuffer\n");
+
+    // Horizontal spans of 200 pixels
+    start = Now();
+    for (int n = 0; n < CALLS; n++)
+        NF_Draw8bitsHLine(0, n & 31, n & 255, 200, n);
+    Report("HLine", start, (u64)CALLS * 200);
+
+    // Vertical spans of 150 pixels
+    start = Now();
+    for (int n = 0; n < CALLS; n++)
+        NF_Draw8bitsVLine(0, n & 255, n & 31, 150, n);
+    Report("VLine", start, (u64)CALLS * 150);
+
+    // Rectangles of 64x64 pixels
+    start = Now();
+    for (int n = 0; n < CALLS; n++)
+        NF_Fill8bitsRect(0, n & 127, n & 127, 64, 64, n);
+    Report("Rect 64x64", start, (u64)CALLS * 64 * 64);
+
+    // Full screen clears, filled with DMA
+    start = Now();
+    for (int n = 0; n < (CALLS / 16); n++)
+        NF_Fill8bitsRect(0, 0, 0, 256, 256, n | 1);
+    Report("Clear", start, (u64)(CALLS / 16) * 65536);
+
+    // Check that the DMA fill has reached every pixel
+    u8 color = (u8)(((CALLS / 16) - 1) | 1);
+    for (int n = 0; n < 65536; n++)
+    {
+        if (NF_8BITS_BACKBUFFER[0].data[n] != color)
+        {
+            printf("  8-bit clear failed at pixel %d\n", n);
+            failures++;
+            break;
+        }
+    }
+
+    // Diagonal lines of 192 pixels
+    start = Now();
+    for (int n = 0; n < CALLS; n++)
+        NF_Draw8bitsLine(0, n & 63, 0, (n & 63) + 191, 191, n);
+    Report("Line", start, (u64)CALLS * 192);
+
+    // Filled circles with a radius of 32 pixels (about 3217 pixels)
+    start = Now();
+    for (int n = 0; n < CALLS; n++)
+        NF_Draw8bitsCircle(0, 64 + (n & 127), 96, 32, n, true);
+    Report("Circle", start, (u64)CALLS * 3217);
+
+    // Sprites of 32x32 pixels, color 0 is transparent
+    start = Now();
+    for (int n = 0; n < CALLS; n++)
+        NF_Draw8bitsSprite(0, sprite, n & 127, (n * 3) & 127, SPR_SIZE, SPR_SIZE);
+    Report("Sprite 32", start, (u64)CALLS * SPR_SIZE * SPR_SIZE);
+}
+
+int main(void)
+{
+    NF_16BITS_BACKBUFFER[0] = Alloc32(65536 * 2);
+    NF_8BITS_BACKBUFFER[0].data = Alloc32(65536);
+    NF_8BITS_BACKBUFFER[0].pal = Alloc32(256 * 2);
+
+    for (int n = 0; n < 256; n++)
+        palette[n] = RGB15(n >> 3, 31 - (n >> 3), 16);
+    for (int n = 0; n < (SPR_SIZE * SPR_SIZE); n++)
+        sprite[n] = ((n & 7) == 0) ? 0 : n;
+
+    printf("Bitmap primitives benchmark\n");
+    printf("%d calls per test\n\n", CALLS);
+
+    Bench16();
+    printf("\n");
+    Bench8();
+
+    if (failures > 0)
+    {
+        printf("%u failures\n", failures);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,72 @@
+// SPDX-License-Identifier: CC0-1.0
+//
+// SPDX-FileContributor: NightFox & Co., 2009-2011
+//
+// Minimal replacement of the libnds header used to build the drawing
+// primitives of NFLib on the host.
+
+#ifndef NDS_HOST_H__
+#define NDS_HOST_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int8_t s8;
+typedef int16_t s16;
+typedef int32_t s32;
+typedef volatile u8 vu8;
+typedef volatile u16 vu16;
+typedef volatile u32 vu32;
+
+#define BIT(n) (1 << (n))
+
+#define RGB15(r, g, b) ((r) | ((g) << 5) | ((b) << 10))
+
+// DMA registers. Writing DMA_CR() with DMA_ENABLE starts a transfer, which is
+// done by the next access to REG_IME or call to dmaBusy(). Only 32-bit copies
+// and fills are emulated.
+typedef struct {
+    vu32 src;
+    vu32 dest;
+    vu32 cr;
+    vu32 fill;
+} nds_host_dma_t;
+
+extern nds_host_dma_t nds_host_dma[4];
+
+#define DMA_SRC(n)      (nds_host_dma[n].src)
+#define DMA_DEST(n)     (nds_host_dma[n].dest)
+#define DMA_CR(n)       (nds_host_dma[n].cr)
+#define DMA_FILL(n)     (nds_host_dma[n].fill)
+
+#define DMA_ENABLE      BIT(31)
+#define DMA_BUSY        BIT(31)
+#define DMA_32_BIT      BIT(26)
+#define DMA_SRC_FIX     BIT(24)
+#define DMA_START_NOW   0
+#define DMA_COPY_WORDS  (DMA_ENABLE | DMA_32_BIT | DMA_START_NOW)
+
+vu32 *nds_host_reg_ime(void);
+
+#define REG_IME (*nds_host_reg_ime())
+
+bool dmaBusy(u8 channel);
+
+// The host has no cache to maintain
+static inline void DC_FlushRange(const void *base, u32 size)
+{
+    (void)base;
+    (void)size;
+}
+
+static inline void DC_InvalidateRange(const void *base, u32 size)
+{
+    (void)base;
+    (void)size;
+}
+
+#endif // NDS_HOST_H__
@@ -0,0 +1,611 @@
+// SPDX-License-Identifier: CC0-1.0
+//
+// SPDX-FileContributor: NightFox & Co., 2009-2011
+//
+// Host-side round-trip test of the decompressors of nf_compress.c
+// http://www.nightfoxandco.com
+//
+// Data is compressed with the simple encoders of this file and decompressed
+// with NF_Decompress() and NF_DecompressToVram(). It also checks that raw
+// files that start with a compression type aren't detected as compressed.
+//
+// It can also be used to compress files for the examples:
+//
+//     compress_test <lz77|lz11|rle|huff4|huff8> <input> <output>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <nds.h>
+
+#include "nf_basic.h"
+#include "nf_compress.h"
+
+// Definitions required by nf_compress.c
+
+char NF_ROOTFOLDER[64];
+
+void NF_Error(u16 code, const char *text, unsigned int value)
+{
+    printf("NF_Error(%u, %s, %u)\n", code, text ? text : "", value);
+    exit(1);
+}
+
+void NF_FileLoadRaw(const char *path, char **buffer, u32 *size)
+{
+    (void)path;
+    *buffer = NULL;
+    *size = 0;
+}
+
+void NF_DmaMemCopy(void *destination, const void *source, u32 size)
+{
+    memcpy(destination, source, size);
+}
+
+// Encoders
+
+typedef struct {
+    u8 *data;
+    u32 size;
+    u32 capacity;
+} buffer_t;
+
+static void Put(buffer_t *buf, u8 value)
+{
+    if (buf->size == buf->capacity)
+    {
+        buf->capacity = (buf->capacity * 2) + 64;
+        buf->data = realloc(buf->data, buf->capacity);
+        if (buf->data == NULL)
+            NF_Error(102, NULL, buf->capacity);
+    }
+    buf->data[buf->size++] = value;
+}
+
+static void PutHeader(buffer_t *buf, u8 type, u32 size)
+{
+    Put(buf, type);
+    Put(buf, size & 0xFF);
+    Put(buf, (size >> 8) & 0xFF);
+    Put(buf, (size >> 16) & 0xFF);
+}
+
+static void PutPadding(buffer_t *buf)
+{
+    while (buf->size & 3)
+        Put(buf, 0);
+}
+
+static buffer_t EncodeLZ(const u8 *src, u32 size, bool lz11)
+{
+    buffer_t buf = { 0 };
+    PutHeader(&buf, lz11 ? NF_COMPRESS_LZ11 : NF_COMPRESS_LZ77, size);
+
+    u32 max_length = lz11 ? 0x10110 : 18;
+    u32 pos = 0;
+
+    while (pos < size)
+    {
+        u32 flags_pos = buf.size;
+        u8 flags = 0;
+        Put(&buf, 0);
+
+        for (int i = 0; (i < 8) && (pos < size); i++)
+        {
+            // Longest match in the last 4 KB
+            u32 best_length = 0, best_disp = 0;
+            u32 start = (pos > 4096) ? pos - 4096 : 0;
+
+            for (u32 from = start; from < pos; from++)
+            {
+                u32 length = 0;
+                while ((length < max_length) && ((pos + length) < size)
+                       && (src[from + length] == src[pos + length]))
+                    length++;
+
+                if (length > best_length)
+                {
+                    best_length = length;
+                    best_disp = pos - from;
+                }
+            }
+
+            if (best_length < 3)
+            {
+                Put(&buf, src[pos++]);
+                continue;
+            }
+
+            flags |= 0x80 >> i;
+            u32 disp = best_disp - 1;
+
+            if (!lz11)
+            {
+                Put(&buf, ((best_length - 3) << 4) | (disp >> 8));
+                Put(&buf, disp & 0xFF);
+            }
+            else if (best_length <= 0x10)
+            {
+                Put(&buf, ((best_length - 1) << 4) | (disp >> 8));
+                Put(&buf, disp & 0xFF);
+            }
+            else if (best_length <= 0x110)
+            {
+                u32 length = best_length - 0x11;
+                Put(&buf, length >> 4);
+                Put(&buf, ((length & 0xF) << 4) | (disp >> 8));
+                Put(&buf, disp & 0xFF);
+            }
+            else
+            {
+                u32 length = best_length - 0x111;
+                Put(&buf, 0x10 | (length >> 12));
+                Put(&buf, (length >> 4) & 0xFF);
+                Put(&buf, ((length & 0xF) << 4) | (disp >> 8));
+                Put(&buf, disp & 0xFF);
+            }
+
+            pos += best_length;
+        }
+
+        buf.data[flags_pos] = flags;
+    }
+
+    PutPadding(&buf);
+    return buf;
+}
+
+static buffer_t EncodeRLE(const u8 *src, u32 size)
+{
+    buffer_t buf = { 0 };
+    PutHeader(&buf, NF_COMPRESS_RLE, size);
+
+    u32 pos = 0;
+    while (pos < size)
+    {
+        u32 run = 1;
+        while ((run < 130) && ((pos + run) < size) && (src[pos + run] == src[pos]))
+            run++;
+
+        if (run >= 3)
+        {
+            Put(&buf, 0x80 | (run - 3));
+            Put(&buf, src[pos]);
+            pos += run;
+            continue;
+        }
+
+        // Uncompressed bytes until the next run of 3 bytes
+        u32 length = 0;
+        while ((length < 128) && ((pos + length) < size))
+        {
+            u32 next = pos + length;
+            if (((next + 2) < size) && (src[next] == src[next + 1])
+                && (src[next] == src[next + 2]))
+                break;
+            length++;
+        }
+
+        Put(&buf, length - 1);
+        for (u32 n = 0; n < length; n++)
+            Put(&buf, src[pos++]);
+    }
+
+    PutPadding(&buf);
+    return buf;
+}
+
+typedef struct {
+    u32 count;
+    int child[2];   // Children of internal nodes, -1 for leaves
+    u32 code;       // Code of leaves
+    u32 code_bits;
+} huff_node;
+
+static void HuffCodes(huff_node *nodes, int node, u32 code, u32 bits)
+{
+    if (nodes[node].child[0] < 0)
+    {
+        nodes[node].code = code;
+        nodes[node].code_bits = bits;
+        return;
+    }
+
+    HuffCodes(nodes, nodes[node].child[0], code << 1, bits + 1);
+    HuffCodes(nodes, nodes[node].child[1], (code << 1) | 1, bits + 1);
+}
+
+// The tree is stored in breadth-first order, so offsets only fit in 6 bits if
+// the tree isn't very wide. The tests use up to 64 different symbols.
+static buffer_t EncodeHuffman(const u8 *src, u32 size, u32 bits)
+{
+    u32 symbols = 1 << bits;
+    u32 count = size * (8 / bits);
+
+    huff_node nodes[512];
+    int active[256];
+    u32 num_active = 0;
+
+    for (u32 n = 0; n < symbols; n++)
+    {
+        nodes[n] = (huff_node){ .child = { -1, -1 } };
+    }
+    for (u32 n = 0; n < count; n++)
+    {
+        u32 symbol = (bits == 8) ? src[n] : (src[n >> 1] >> ((n & 1) * 4)) & 0xF;
+        nodes[symbol].count++;
+    }
+    for (u32 n = 0; n < symbols; n++)
+    {
+        if (nodes[n].count > 0)
+            active[num_active++] = n;
+    }
+
+    // The root must have two children
+    if (num_active == 1)
+        active[num_active++] = (active[0] == 0) ? 1 : 0;
+
+    u32 num_nodes = symbols;
+    while (num_active > 1)
+    {
+        // Join the two nodes with the lowest counts
+        for (u32 pass = 0; pass < 2; pass++)
+        {
+            u32 min = pass;
+            for (u32 n = pass + 1; n < num_active; n++)
+            {
+                if (nodes[active[n]].count < nodes[active[min]].count)
+                    min = n;
+            }
+            int tmp = active[pass];
+            active[pass] = active[min];
+            active[min] = tmp;
+        }
+
+        nodes[num_nodes] = (huff_node){
+            .count = nodes[active[0]].count + nodes[active[1]].count,
+            .child = { active[0], active[1] },
+        };
+        active[0] = num_nodes++;
+        active[1] = active[--num_active];
+    }
+
+    int root = active[0];
+    HuffCodes(nodes, root, 0, 0);
+
+    // Tree table. The root is at address 5 and the pairs of children start at
+    // address 6.
+    u8 table[1024] = { 0 };
+    int queue[512];
+    u32 queue_addr[512];
+    u32 head = 0, tail = 0;
+    u32 next_pair = 6;
+
+    queue[tail] = root;
+    queue_addr[tail++] = 5;
+
+    while (head < tail)
+    {
+        int node = queue[head];
+        u32 addr = queue_addr[head++];
+
+        if (nodes[node].child[0] < 0)
+        {
+            table[addr] = node;
+            continue;
+        }
+
+        u32 offset = (next_pair - (addr & ~1) - 2) >> 1;
+        if (offset > 0x3F)
+        {
+            printf("Huffman tree too wide\n");
+            exit(1);
+        }
+
+        u8 value = offset;
+        for (int side = 0; side < 2; side++)
+        {
+            int child = nodes[node].child[side];
+            if (nodes[child].child[0] < 0)
+                value |= 0x80 >> side;
+            queue[tail] = child;
+            queue_addr[tail++] = next_pair + side;
+        }
+        table[addr] = value;
+        next_pair += 2;
+    }
+
+    buffer_t buf = { 0 };
+    PutHeader(&buf, bits == 8 ? NF_COMPRESS_HUFF8 : NF_COMPRESS_HUFF4, size);
+
+    u32 tree_end = (next_pair + 3) & ~3;
+    table[4] = ((tree_end - 4) >> 1) - 1;
+    for (u32 n = 4; n < tree_end; n++)
+        Put(&buf, table[n]);
+
+    // Bitstream in 32-bit words, most significant bit first
+    u32 word = 0, word_bits = 0;
+    for (u32 n = 0; n < count; n++)
+    {
+        u32 symbol = (bits == 8) ? src[n] : (src[n >> 1] >> ((n & 1) * 4)) & 0xF;
+
+        for (int b = nodes[symbol].code_bits - 1; b >= 0; b--)
+        {
+            word = (word << 1) | ((nodes[symbol].code >> b) & 1);
+            if (++word_bits == 32)
+            {
+                for (int i = 0; i < 4; i++)
+                    Put(&buf, word >> (i * 8));
+                word = 0;
+                word_bits = 0;
+            }
+        }
+    }
+    if (word_bits > 0)
+    {
+        word <<= 32 - word_bits;
+        for (int i = 0; i < 4; i++)
+            Put(&buf, word >> (i * 8));
+    }
+
+    return buf;
+}
+
+static buffer_t Encode(u8 type, const u8 *src, u32 size)
+{
+    switch (type)
+    {
+        case NF_COMPRESS_LZ77:
+            return EncodeLZ(src, size, false);
+        case NF_COMPRESS_LZ11:
+            return EncodeLZ(src, size, true);
+        case NF_COMPRESS_RLE:
+            return EncodeRLE(src, size);
+        case NF_COMPRESS_HUFF4:
+            return EncodeHuffman(src, size, 4);
+        default:
+            return EncodeHuffman(src, size, 8);
+    }
+}
+
+// Tests
+
+static const u8 TYPES[] = {
+    NF_COMPRESS_LZ77, NF_COMPRESS_LZ11, NF_COMPRESS_RLE,
+    NF_COMPRESS_HUFF4, NF_COMPRESS_HUFF8
+};
+static const char *TYPE_NAMES[] = { "lz77", "lz11", "rle", "huff4", "huff8" };
+
+static u32 failures = 0;
+
+static void Check(bool ok, const char *name, const char *what, u32 size)
+{
+    if (ok)
+        return;
+
+    printf("FAIL: %s, %s (%u bytes)\n", name, what, size);
+    failures++;
+}
+
+// Test data with runs, repeated blocks and noise, using "symbols" values
+static void MakeData(u8 *data, u32 size, u32 symbols, u32 seed)
+{
+    u32 rand_state = seed * 2654435761u + 1;
+
+    for (u32 n = 0; n < size; n++)
+    {
+        rand_state = (rand_state * 1103515245) + 12345;
+        u32 r = rand_state >> 16;
+
+        if ((n > 64) && ((r & 7) == 0))
+            data[n] = data[n - 1 - ((r >> 3) & 63)];    // Repeated data
+        else if ((r & 7) == 1)
+            data[n] = (n > 0) ? data[n - 1] : 0;        // Runs
+        else
+            data[n] = (r >> 4) % symbols;               // Noise
+    }
+}
+
+static void RoundTrip(u8 type, const char *name, const u8 *data, u32 size)
+{
+    buffer_t enc = Encode(type, data, size);
+
+    Check(NF_GetDecompressedSize(enc.data, enc.size) == size, name, "size", size);
+    Check(NF_CheckCompressed(enc.data, enc.size), name, "check", size);
+
+    // RAM
+    u8 *out = malloc(size);
+    Check(NF_Decompress(enc.data, enc.size, out), name, "decompress", size);
+    Check(memcmp(out, data, size) == 0, name, "data", size);
+
+    // VRAM. The byte after the data must be preserved, so it uses a buffer
+    // aligned to 16 bits with guard bytes.
+    u16 *vram = malloc(size + 4);
+    memset(vram, 0xA5, size + 4);
+    Check(NF_DecompressToVram(enc.data, enc.size, vram), name, "vram", size);
+    Check(memcmp(vram, data, size) == 0, name, "vram data", size);
+    Check(((u8 *)vram)[size] == 0xA5, name, "vram guard", size);
+
+    // Truncated data must be rejected
+    Check(!NF_CheckCompressed(enc.data, enc.size - 5), name, "truncated", size);
+
+    // Data with more than 3 bytes after the end must be rejected
+    u8 *longer = malloc(enc.size + 8);
+    memcpy(longer, enc.data, enc.size);
+    memset(longer + enc.size, 0, 8);
+    Check(!NF_CheckCompressed(longer, enc.size + 8), name, "trailing data", size);
+
+    free(longer);
+    free(vram);
+    free(out);
+    free(enc.data);
+}
+
+static void TestRoundTrips(void)
+{
+    static const u32 sizes[] = { 1, 2, 3, 7, 64, 255, 1023, 4097, 20001, 65536 };
+
+    for (u32 t = 0; t < sizeof(TYPES); t++)
+    {
+        for (u32 s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+        {
+            u32 size = sizes[s];
+            u8 *data = malloc(size);
+
+            // Few symbols, many symbols and a single value
+            MakeData(data, size, 16, size);
+            RoundTrip(TYPES[t], TYPE_NAMES[t], data, size);
+
+            MakeData(data, size, 64, size + 1);
+            RoundTrip(TYPES[t], TYPE_NAMES[t], data, size);
+
+            memset(data, 0x42, size);
+            RoundTrip(TYPES[t], TYPE_NAMES[t], data, size);
+
+            free(data);
+        }
+    }
+
+    // Long matches of LZ11 use all the length formats
+    u32 size = 200000;
+    u8 *data = calloc(size, 1);
+    MakeData(data, 300, 256, 7);
+    RoundTrip(NF_COMPRESS_LZ11, "lz11 long", data, size);
+    RoundTrip(NF_COMPRESS_LZ77, "lz77 long", data, size);
+    RoundTrip(NF_COMPRESS_RLE, "rle long", data, size);
+    free(data);
+}
+
+static void CheckRaw(const char *name, const u8 *data, u32 size)
+{
+    Check(!NF_CheckCompressed(data, size), name, "detected as compressed", size);
+
+    // Nothing must be written to VRAM
+    u8 *vram = malloc(size);
+    memset(vram, 0xA5, size);
+    Check(!NF_DecompressToVram(data, size, vram), name, "decompressed to VRAM", size);
+    bool untouched = true;
+    for (u32 n = 0; n < size; n++)
+        untouched &= vram[n] == 0xA5;
+    Check(untouched, name, "VRAM modified", size);
+    free(vram);
+}
+
+static void TestRawFiles(void)
+{
+    // Map of 256x256 pixels (32x32 tiles) whose first entry is tile 16
+    u16 map[32 * 32];
+    for (u32 n = 0; n < 32 * 32; n++)
+        map[n] = 16 + (n % 40);
+    CheckRaw("map", (u8 *)map, sizeof(map));
+
+    // The same map with a flipped tile in the first entry
+    map[0] = 0x0410;
+    map[1] = 0x0000;
+    CheckRaw("map flipped", (u8 *)map, sizeof(map));
+
+    // 8 bpp tileset whose first bytes announce about 3 MB of RLE data
+    u32 tiles_size = 64 * 1024;
+    u8 *tiles = malloc(tiles_size);
+    MakeData(tiles, tiles_size, 256, 3);
+    tiles[0] = 0x30;
+    tiles[1] = 0x00;
+    tiles[2] = 0x00;
+    tiles[3] = 0x30;
+    CheckRaw("tileset", tiles, tiles_size);
+
+    // The same tileset with every other compression type
+    for (u32 t = 0; t < sizeof(TYPES); t++)
+    {
+        tiles[0] = TYPES[t];
+        CheckRaw(TYPE_NAMES[t], tiles, tiles_size);
+    }
+    free(tiles);
+
+    // Masks of 16-bit images use opacity values from 0 to 32
+    u32 mask_size = 64 * 64;
+    u8 *mask = malloc(mask_size);
+    for (u32 n = 0; n < mask_size; n++)
+        mask[n] = ((n % 64) < 32) ? 32 : 16;
+    mask[0] = 0x10;
+    CheckRaw("mask lz77", mask, mask_size);
+    mask[0] = 0x30;
+    mask[1] = 0x20;
+    mask[2] = 0x20;
+    mask[3] = 0x00;
+    CheckRaw("mask rle", mask, mask_size);
+    free(mask);
+}
+
+static int CompressFile(const char *type_name, const char *input, const char *output)
+{
+    u32 t = 0;
+    while ((t < sizeof(TYPES)) && (strcmp(TYPE_NAMES[t], type_name) != 0))
+        t++;
+
+    if (t == sizeof(TYPES))
+    {
+        printf("Unknown type: %s\n", type_name);
+        return 1;
+    }
+
+    FILE *f = fopen(input, "rb");
+    if (f == NULL)
+    {
+        printf("Can't open %s\n", input);
+        return 1;
+    }
+    fseek(f, 0, SEEK_END);
+    u32 size = ftell(f);
+    rewind(f);
+    u8 *data = malloc(size);
+    if (fread(data, 1, size, f) != size)
+        size = 0;
+    fclose(f);
+
+    buffer_t enc = Encode(TYPES[t], data, size);
+
+    // Never write a file that can't be decompressed
+    u8 *check = malloc(size);
+    if (!NF_Decompress(enc.data, enc.size, check) || (memcmp(check, data, size) != 0))
+    {
+        printf("Can't compress %s as %s\n", input, type_name);
+        return 1;
+    }
+
+    f = fopen(output, "wb");
+    if (f == NULL)
+    {
+        printf("Can't create %s\n", output);
+        return 1;
+    }
+    fwrite(enc.data, 1, enc.size, f);
+    fclose(f);
+
+    printf("%s: %u -> %u bytes\n", output, size, enc.size);
+
+    free(check);
+    free(enc.data);
+    free(data);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc == 4)
+        return CompressFile(argv[1], argv[2], argv[3]);
+
+    TestRoundTrips();
+    TestRawFiles();
+
+    if (failures > 0)
+    {
+        printf("%u failures\n", failures);
+        return 1;
+    }
+
+    printf("All tests passed\n");
+    return 0;
+}
@@ -0,0 +1,34 @@
+// SPDX-License-Identifier: CC0-1.0
+//
+// SPDX-FileContributor: NightFox & Co., 2009-2011
+//
+// Minimal replacement of the libnds header used to build the decompressors
+// of NFLib on the host.
+
+#ifndef NDS_HOST_H__
+#define NDS_HOST_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int8_t s8;
+typedef int16_t s16;
+typedef int32_t s32;
+typedef volatile u8 vu8;
+typedef volatile u16 vu16;
+typedef volatile u32 vu32;
+
+#define BIT(n) (1 << (n))
+
+// Used by inline functions of nf_basic.h
+typedef struct {
+    u8 language;
+} PERSONAL_DATA;
+
+extern PERSONAL_DATA *PersonalData;
+
+#endif // NDS_HOST_H__
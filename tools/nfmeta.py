@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: MIT
+#
+# Copyright (c) 2009-2014 Cesar Rincon "NightFox"
+#
+# NightFox LIB - Metatile map converter
+# http://www.nightfoxandco.com/
+#
+# Converts the MAP file of a tiled background created by grit (with the map
+# split in blocks of 32x32 tiles, as NFLib expects) into the
+# MAP and MTL files used by NF_LoadMetatileBg(). Repeated metatiles are stored
+# only once in the MTL file.
+#
+# Usage: nfmeta.py <grit map> <width> <height> <metatile size (16 or 32)> <output path without extension>
+
+import struct
+import sys
+
+
+def read_map(path, width, height):
+    with open(path, 'rb') as f:
+        data = f.read()
+
+    tiles_w = width // 8
+    tiles_h = height // 8
+    if len(data) < tiles_w * tiles_h * 2:
+        raise ValueError(f'{path}: map is too small for {width}x{height}')
+
+    entries = struct.unpack(f'<{tiles_w * tiles_h}H', data[:tiles_w * tiles_h * 2])
+
+    # Convert the blocks of 32x32 tiles to a plain row-major map
+    blocks_w = tiles_w // 32
+    tiles = [[0] * tiles_w for _ in range(tiles_h)]
+    for y in range(tiles_h):
+        for x in range(tiles_w):
+            block = (y // 32) * blocks_w + (x // 32)
+            tiles[y][x] = entries[(block << 10) + ((y & 31) << 5) + (x & 31)]
+    return tiles
+
+
+def main(args):
+    if len(args) != 6:
+        print(f'Usage: {args[0]} <grit map> <width> <height> <metatile size (16 or 32)> <output>')
+        return 1
+
+    path, width, height, metasize, output = args[1], int(args[2]), int(args[3]), int(args[4]), args[5]
+
+    if width % 256 or height % 256:
+        print('The size of the background must be a multiple of 256')
+        return 1
+    if metasize not in (16, 32):
+        print('The size of the metatiles must be 16 or 32')
+        return 1
+
+    tiles = read_map(path, width, height)
+    side = metasize // 8
+
+    metatiles = {}
+    indices = []
+    for my in range(0, height // 8, side):
+        for mx in range(0, width // 8, side):
+            key = tuple(tiles[my + y][mx + x] for y in range(side) for x in range(side))
+            if key not in metatiles:
+                metatiles[key] = len(metatiles)
+            indices.append(metatiles[key])
+
+    if len(metatiles) > 0x10000:
+        print(f'Too many different metatiles: {len(metatiles)}')
+        return 1
+
+    with open(output + '.map', 'wb') as f:
+        f.write(struct.pack(f'<{len(indices)}H', *indices))
+
+    with open(output + '.mtl', 'wb') as f:
+        for key in sorted(metatiles, key=metatiles.get):
+            f.write(struct.pack(f'<{len(key)}H', *key))
+
+    print(f'{len(indices)} metatiles in the map, {len(metatiles)} different')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
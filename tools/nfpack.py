@@ -0,0 +1,198 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: MIT
+#
+# Copyright (c) 2009-2014 Cesar Rincon "NightFox"
+#
+# NightFox LIB - Asset pack creator
+# http://www.nightfoxandco.com/
+#
+# Packs all files of a folder (usually "nitrofiles") into a single file that
+# can be opened with NF_OpenAssetPack(). Names are stored relative to the
+# folder, so they match the paths used by the NFLib loaders.
+#
+# Usage: nfpack.py <folder> <output file>
+
+import os
+import struct
+import sys
+
+MAGIC = b'NFPK'
+VERSION = 1
+NAME_LENGTH = 52
+ENTRY_SIZE = NAME_LENGTH + 12
+HEADER_SIZE = 16
+
+FLAG_COMPRESSED = 1 << 0
+
+# Maximum ratio between the decompressed and compressed sizes of each format
+# supported by nf_compress.h, indexed by type.
+MAX_RATIO = {0x10: 9, 0x11: 16384, 0x24: 4, 0x28: 8, 0x30: 65}
+MAX_DECOMPRESSED_SIZE = 4 * 1024 * 1024
+MAX_PADDING = 3
+
+
+def check_lz(data, out_size, lz11):
+    # Only the lengths and displacements matter, not the data
+    pos, inp = 0, 4
+    while pos < out_size:
+        if inp >= len(data):
+            return False
+        flags = data[inp]
+        inp += 1
+        for i in range(8):
+            if pos >= out_size:
+                break
+            if not (flags & (0x80 >> i)):
+                if inp >= len(data):
+                    return False
+                inp += 1
+                pos += 1
+                continue
+            if inp + 1 >= len(data):
+                return False
+            indicator = data[inp] >> 4
+            if not lz11:
+                length = indicator + 3
+                disp = (((data[inp] & 0xF) << 8) | data[inp + 1]) + 1
+                inp += 2
+            elif indicator == 0:
+                if inp + 2 >= len(data):
+                    return False
+                length = (((data[inp] & 0xF) << 4) | (data[inp + 1] >> 4)) + 0x11
+                disp = (((data[inp + 1] & 0xF) << 8) | data[inp + 2]) + 1
+                inp += 3
+            elif indicator == 1:
+                if inp + 3 >= len(data):
+                    return False
+                length = (((data[inp] & 0xF) << 12) | (data[inp + 1] << 4)
+                          | (data[inp + 2] >> 4)) + 0x111
+                disp = (((data[inp + 2] & 0xF) << 8) | data[inp + 3]) + 1
+                inp += 4
+            else:
+                length = indicator + 1
+                disp = (((data[inp] & 0xF) << 8) | data[inp + 1]) + 1
+                inp += 2
+            if disp > pos:
+                return False
+            pos += min(length, out_size - pos)
+    return len(data) - inp <= MAX_PADDING
+
+
+def check_rle(data, out_size):
+    pos, inp = 0, 4
+    while pos < out_size:
+        if inp >= len(data):
+            return False
+        flag = data[inp]
+        inp += 1
+        if flag & 0x80:
+            if inp >= len(data):
+                return False
+            inp += 1
+            pos += (flag & 0x7F) + 3
+        else:
+            length = (flag & 0x7F) + 1
+            if inp + length > len(data):
+                return False
+            inp += length
+            pos += length
+    return len(data) - inp <= MAX_PADDING
+
+
+def check_huffman(data, out_size):
+    bits = data[0] & 0xF
+    tree_end = 4 + ((data[4] + 1) << 1)
+    if tree_end > len(data):
+        return False
+    inp, node, symbol_bits, pos = tree_end, 5, 0, 0
+    word, word_bits = 0, 0
+    while pos < out_size:
+        if word_bits == 0:
+            if inp + 4 > len(data):
+                return False
+            word = int.from_bytes(data[inp:inp + 4], 'little')
+            inp += 4
+            word_bits = 32
+        bit = (word >> (word_bits - 1)) & 1
+        word_bits -= 1
+        value = data[node]
+        child = (node & ~1) + ((value & 0x3F) << 1) + 2 + bit
+        if child >= tree_end:
+            return False
+        if not (value & (0x80 >> bit)):
+            node = child
+            continue
+        node = 5
+        symbol_bits += bits
+        if symbol_bits >= 8:
+            pos += 1
+            symbol_bits = 0
+    return len(data) - inp <= MAX_PADDING
+
+
+def is_compressed(data):
+    # Same checks as NF_CheckCompressed(), so that uncompressed files that
+    # start with a compression type aren't marked as compressed.
+    if len(data) < 4 or data[0] not in MAX_RATIO:
+        return False
+    size = data[1] | (data[2] << 8) | (data[3] << 16)
+    if not 0 < size <= MAX_DECOMPRESSED_SIZE:
+        return False
+    if len(data) - 4 < -(-size // MAX_RATIO[data[0]]):
+        return False
+    if data[0] in (0x10, 0x11):
+        return check_lz(data, size, data[0] == 0x11)
+    if data[0] == 0x30:
+        return check_rle(data, size)
+    return check_huffman(data, size)
+
+
+def main(args):
+    if len(args) != 3:
+        print(f'Usage: {args[0]} <folder> <output file>')
+        return 1
+
+    folder, output = args[1], args[2]
+    output_path = os.path.abspath(output)
+
+    files = []
+    for root, _, names in os.walk(folder):
+        for name in names:
+            path = os.path.join(root, name)
+            if os.path.abspath(path) == output_path:
+                continue
+            rel = os.path.relpath(path, folder).replace(os.sep, '/')
+            encoded = rel.encode('utf-8')
+            if len(encoded) > NAME_LENGTH:
+                print(f'Name too long: {rel}')
+                return 1
+            files.append((encoded, path))
+
+    # The index is sorted so that it can be searched with a binary search
+    files.sort()
+
+    offset = HEADER_SIZE + len(files) * ENTRY_SIZE
+    index = []
+    blobs = []
+    for encoded, path in files:
+        with open(path, 'rb') as f:
+            data = f.read()
+        flags = FLAG_COMPRESSED if is_compressed(data) else 0
+        index.append(struct.pack(f'<{NAME_LENGTH}sIII', encoded, offset,
+                                 len(data), flags))
+        # Keep data aligned to 4 bytes
+        padding = (-len(data)) % 4
+        blobs.append(data + bytes(padding))
+        offset += len(data) + padding
+
+    with open(output, 'wb') as f:
+        f.write(struct.pack('<4sIII', MAGIC, VERSION, len(files), 0))
+        f.write(b''.join(index))
+        f.write(b''.join(blobs))
+
+    print(f'{len(files)} files packed into {output}')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))